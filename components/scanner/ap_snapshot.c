@@ -0,0 +1,155 @@
+#include <string.h>
+
+#include "ap_snapshot.h"
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static void put_le64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void ap_snapshot_init(ap_snapshot_t *snap)
+{
+    memset(snap, 0, sizeof(*snap));
+    atomic_init(&snap->seq, 0);
+
+    // An empty generation-0 snapshot so early readers get a valid header
+    snap->len[0] = AP_SNAPSHOT_HDR_LEN;
+    snap->buf[0][14] = SCAN_RECORD_WIRE_MASK;
+}
+
+bool ap_snapshot_publish(ap_snapshot_t *snap, const ap_table_t *table, int64_t now_us)
+{
+    uint8_t front = snap->front;
+    uint8_t back = front ^ 1;
+    uint8_t *out = snap->buf[back];
+    size_t off = AP_SNAPSHOT_HDR_LEN;
+
+    // The back buffer belongs to the writer; a reader still copying it from
+    // before the last flip will see seq moved and retry
+    for (int i = 0; i < table->count; i++) {
+        off += scan_record_encode(&table->entries[i].rec, out + off, AP_SNAPSHOT_MAX_LEN - off);
+    }
+
+    size_t old_len = snap->len[front];
+    if (off == old_len && memcmp(out + AP_SNAPSHOT_HDR_LEN, snap->buf[front] + AP_SNAPSHOT_HDR_LEN,
+                                 off - AP_SNAPSHOT_HDR_LEN) == 0) {
+        return false;
+    }
+
+    put_le32(out, ++snap->generation);
+    put_le16(out + 4, table->count);
+    put_le64(out + 6, (uint64_t)now_us);
+    out[14] = SCAN_RECORD_WIRE_MASK;
+    snap->len[back] = (uint16_t)off;
+
+    // No odd "in progress" state: a higher-priority reader spinning on it
+    // would starve the preempted writer on a single core
+    atomic_thread_fence(memory_order_release);
+    snap->front = back;
+    uint32_t seq = atomic_load_explicit(&snap->seq, memory_order_relaxed);
+    atomic_store_explicit(&snap->seq, seq + 1, memory_order_release);
+
+    return true;
+}
+
+size_t ap_snapshot_read(ap_snapshot_t *snap, uint8_t *out, size_t cap)
+{
+    for (;;) {
+        uint32_t seq = atomic_load_explicit(&snap->seq, memory_order_acquire);
+        uint8_t front = snap->front;
+        size_t len = snap->len[front];
+        if (len > cap) {
+            return 0;
+        }
+        memcpy(out, snap->buf[front], len);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&snap->seq, memory_order_relaxed) == seq) {
+            return len;
+        }
+        snap->read_retries++;
+    }
+}
+
+bool ap_snapshot_parse_header(const uint8_t *blob, size_t len, uint32_t *generation,
+                              uint16_t *count, uint64_t *timestamp_us, uint8_t *fields)
+{
+    if (len < AP_SNAPSHOT_HDR_LEN) {
+        return false;
+    }
+
+    *generation = get_le32(blob);
+    *count = blob[4] | (blob[5] << 8);
+    *timestamp_us = get_le32(blob + 6) | ((uint64_t)get_le32(blob + 10) << 32);
+    *fields = blob[14];
+
+    return true;
+}
+
+size_t ap_snapshot_page(const uint8_t *blob, size_t len, unsigned page,
+                        uint8_t *out, size_t max_len, unsigned *pages_out)
+{
+    if (len < AP_SNAPSHOT_HDR_LEN || max_len < AP_SNAPSHOT_PAGE_HDR_LEN + SCAN_RECORD_MAX_LEN_ANY) {
+        return 0;
+    }
+
+    // One pass to find the page's record range and the total page count;
+    // records never straddle a page so each page parses on its own
+    unsigned cur = 0;
+    size_t fill = AP_SNAPSHOT_PAGE_HDR_LEN;
+    size_t start = AP_SNAPSHOT_HDR_LEN;
+    size_t end = start;
+    size_t pos = AP_SNAPSHOT_HDR_LEN;
+    uint8_t fields = blob[14];
+
+    while (pos < len) {
+        size_t rec_len = scan_record_wire_len(blob + pos, len - pos, fields);
+        if (rec_len == 0) {
+            break;
+        }
+        if (fill + rec_len > max_len) {
+            cur++;
+            fill = AP_SNAPSHOT_PAGE_HDR_LEN;
+            if (cur == page) {
+                start = pos;
+            }
+        }
+        fill += rec_len;
+        pos += rec_len;
+        if (cur == page) {
+            end = pos;
+        }
+    }
+
+    *pages_out = cur + 1;
+    if (page > cur) {
+        return 0;
+    }
+
+    memcpy(out, blob, AP_SNAPSHOT_HDR_LEN);
+    out[AP_SNAPSHOT_HDR_LEN] = (uint8_t)page;
+    out[AP_SNAPSHOT_HDR_LEN + 1] = (uint8_t)(cur + 1);
+    memcpy(out + AP_SNAPSHOT_PAGE_HDR_LEN, blob + start, end - start);
+
+    return AP_SNAPSHOT_PAGE_HDR_LEN + end - start;
+}
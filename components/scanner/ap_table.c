@@ -0,0 +1,99 @@
+#include <string.h>
+
+#include "ap_table.h"
+
+// EWMA weight 1/4: settles within a handful of beacons, still damps fading
+#define RSSI_EWMA_SHIFT 2
+
+void ap_table_init(ap_table_t *table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+ap_entry_t *ap_table_find(ap_table_t *table, const uint8_t bssid[6])
+{
+    for (int i = 0; i < table->count; i++) {
+        if (memcmp(table->entries[i].rec.bssid, bssid, 6) == 0) {
+            return &table->entries[i];
+        }
+    }
+    return NULL;
+}
+
+ap_entry_t *ap_table_update(ap_table_t *table, const scan_record_t *rec, int64_t now_us)
+{
+    ap_entry_t *e = ap_table_find(table, rec->bssid);
+
+    if (e) {
+        int16_t sample_q4 = rec->rssi * 16;
+        e->rssi_avg_q4 += (sample_q4 - e->rssi_avg_q4) >> RSSI_EWMA_SHIFT;
+
+        // Hidden networks answer probes with the real SSID; keep the better one
+        scan_record_t prev = e->rec;
+        e->rec = *rec;
+        if (rec->ssid_len == 0 && prev.ssid_len > 0) {
+            memcpy(e->rec.ssid, prev.ssid, sizeof(prev.ssid));
+            e->rec.ssid_len = prev.ssid_len;
+        }
+        // A BSSID's OUI never changes: keep what the insert looked up
+        if (table->oui_db) {
+            e->rec.vendor_id = prev.vendor_id;
+        }
+    } else {
+        if (table->count < AP_TABLE_MAX) {
+            e = &table->entries[table->count++];
+        } else {
+            e = &table->entries[0];
+            for (int i = 1; i < table->count; i++) {
+                if (table->entries[i].last_seen_us < e->last_seen_us) {
+                    e = &table->entries[i];
+                }
+            }
+            table->evictions++;
+        }
+
+        e->rec = *rec;
+        e->rssi_avg_q4 = rec->rssi * 16;
+        e->samples = 0;
+        e->first_seen_us = now_us;
+        if (table->oui_db && (SCAN_RECORD_MASK & SCAN_FIELD_VENDOR)) {
+            e->rec.vendor_id = oui_db_lookup(table->oui_db, rec->bssid);
+        }
+    }
+
+    // Estimated from the smoothed RSSI, so it inherits the same damping
+    if (table->distance_cal) {
+        const rssi_distance_model_t *m = rssi_distance_cal_lookup(table->distance_cal, rec->bssid);
+        e->rec.distance_cm = rssi_distance_cm(m, e->rssi_avg_q4);
+    }
+    e->samples++;
+    e->last_seen_us = now_us;
+    e->dirty = true;
+
+    return e;
+}
+
+size_t ap_table_expire(ap_table_t *table, int64_t now_us, int64_t max_age_us)
+{
+    size_t removed = 0;
+    int i = 0;
+
+    while (i < table->count) {
+        if (now_us - table->entries[i].last_seen_us > max_age_us) {
+            // Order is not significant, so fill the hole with the last entry
+            table->entries[i] = table->entries[--table->count];
+            removed++;
+        } else {
+            i++;
+        }
+    }
+
+    return removed;
+}
+
+void ap_table_clear_dirty(ap_table_t *table)
+{
+    for (int i = 0; i < table->count; i++) {
+        table->entries[i].dirty = false;
+    }
+}
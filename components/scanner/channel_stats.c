@@ -0,0 +1,166 @@
+#include <string.h>
+
+#include "channel_stats.h"
+
+// Power reference and clamp range; -100 dBm is 1.0 (256 in Q8)
+#define RSSI_FLOOR_DBM  (-100)
+#define RSSI_CEIL_DBM   (-10)
+
+// Load maps interference linearly between these
+#define LOAD_MIN_DBM    (-95)
+#define LOAD_MAX_DBM    (-30)
+
+// Spectral overlap of two 2.4 GHz channels by channel distance, Q12
+static const uint16_t overlap_q12[] = { 4096, 2979, 1112, 154, 22 };
+
+// 10^(i/10) in Q8 and the rounding thresholds 10^((i+0.5)/10) in Q8
+static const uint16_t mant_q8[10] = { 256, 322, 406, 511, 643, 810, 1019, 1283, 1615, 2033 };
+static const uint16_t mant_mid_q8[10] = { 287, 362, 456, 574, 723, 910, 1145, 1441, 1815, 2285 };
+static const uint32_t decade[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+uint64_t channel_stats_db_to_q8(int db)
+{
+    if (db < 0) {
+        return 0;
+    }
+    if (db >= 100) {
+        db = 99;
+    }
+    return (uint64_t)decade[db / 10] * mant_q8[db % 10];
+}
+
+int channel_stats_q8_to_db(uint64_t p_q8)
+{
+    if (p_q8 < mant_mid_q8[0] / 2) {
+        return -1;
+    }
+
+    int k = 0;
+    while (k < 9 && p_q8 >= (uint64_t)decade[k + 1] * 256) {
+        k++;
+    }
+
+    // Ratio within the decade, still Q8: 256..2559
+    uint32_t r = (uint32_t)(p_q8 / decade[k]);
+    int i = 0;
+    while (i < 10 && r >= mant_mid_q8[i]) {
+        i++;
+    }
+
+    return 10 * k + i;
+}
+
+void channel_stats_reset(channel_stats_t *cs)
+{
+    memset(cs, 0, sizeof(*cs));
+    for (int c = 0; c <= CHANNEL_STATS_MAX; c++) {
+        cs->strongest[c] = CHANNEL_STATS_NONE;
+    }
+}
+
+void channel_stats_add(channel_stats_t *cs, const scan_record_t *rec)
+{
+    int ch = rec->channel;
+    if (ch < 1 || ch > CHANNEL_STATS_MAX) {
+        return;
+    }
+
+    int rssi = rec->rssi;
+    if (rssi < RSSI_FLOOR_DBM) {
+        rssi = RSSI_FLOOR_DBM;
+    } else if (rssi > RSSI_CEIL_DBM) {
+        rssi = RSSI_CEIL_DBM;
+    }
+
+    if (cs->ap_count[ch] < UINT8_MAX) {
+        cs->ap_count[ch]++;
+    }
+    if (rec->rssi > cs->strongest[ch]) {
+        cs->strongest[ch] = rec->rssi;
+    }
+
+    uint64_t p = channel_stats_db_to_q8(rssi - RSSI_FLOOR_DBM);
+    int n_overlap = (int)(sizeof(overlap_q12) / sizeof(overlap_q12[0]));
+    for (int d = -(n_overlap - 1); d < n_overlap; d++) {
+        int k = ch + d;
+        if (k < 1 || k > CHANNEL_STATS_MAX) {
+            continue;
+        }
+        cs->power_q8[k] += (p * overlap_q12[d < 0 ? -d : d]) >> 12;
+    }
+}
+
+void channel_stats_finish(const channel_stats_t *cs, channel_stat_t out[CHANNEL_STATS_MAX + 1])
+{
+    memset(out, 0, sizeof(channel_stat_t) * (CHANNEL_STATS_MAX + 1));
+
+    for (int c = 1; c <= CHANNEL_STATS_MAX; c++) {
+        out[c].ap_count = cs->ap_count[c];
+        out[c].strongest = cs->strongest[c];
+
+        int db = channel_stats_q8_to_db(cs->power_q8[c]);
+        if (db < 0) {
+            out[c].interference_dbm = CHANNEL_STATS_NONE;
+            continue;
+        }
+        int dbm = db + RSSI_FLOOR_DBM;
+        out[c].interference_dbm = (int8_t)dbm;
+
+        if (dbm <= LOAD_MIN_DBM) {
+            out[c].load = 0;
+        } else if (dbm >= LOAD_MAX_DBM) {
+            out[c].load = 100;
+        } else {
+            out[c].load = (uint8_t)((dbm - LOAD_MIN_DBM) * 100 / (LOAD_MAX_DBM - LOAD_MIN_DBM));
+        }
+    }
+}
+
+size_t channel_stats_encode(const channel_stat_t stats[CHANNEL_STATS_MAX + 1], uint8_t *out,
+                            size_t cap)
+{
+    if (cap < CHANNEL_STATS_WIRE_LEN) {
+        return 0;
+    }
+
+    size_t off = 1;
+    out[0] = CHANNEL_STATS_MAX;
+    for (int c = 1; c <= CHANNEL_STATS_MAX; c++) {
+        out[off++] = (uint8_t)c;
+        out[off++] = stats[c].ap_count;
+        out[off++] = (uint8_t)stats[c].strongest;
+        out[off++] = (uint8_t)stats[c].interference_dbm;
+        out[off++] = stats[c].load;
+    }
+
+    return off;
+}
+
+size_t channel_stats_decode(const uint8_t *in, size_t len, channel_stat_t out[CHANNEL_STATS_MAX + 1])
+{
+    if (len < 1 || len < 1 + (size_t)in[0] * CHANNEL_STATS_ENTRY_LEN) {
+        return 0;
+    }
+
+    memset(out, 0, sizeof(channel_stat_t) * (CHANNEL_STATS_MAX + 1));
+    for (int c = 0; c <= CHANNEL_STATS_MAX; c++) {
+        out[c].strongest = CHANNEL_STATS_NONE;
+        out[c].interference_dbm = CHANNEL_STATS_NONE;
+    }
+
+    const uint8_t *p = in + 1;
+    for (unsigned i = 0; i < in[0]; i++, p += CHANNEL_STATS_ENTRY_LEN) {
+        if (p[0] < 1 || p[0] > CHANNEL_STATS_MAX) {
+            continue;
+        }
+        channel_stat_t *s = &out[p[0]];
+        s->ap_count = p[1];
+        s->strongest = (int8_t)p[2];
+        s->interference_dbm = (int8_t)p[3];
+        s->load = p[4];
+    }
+
+    return 1 + (size_t)in[0] * CHANNEL_STATS_ENTRY_LEN;
+}
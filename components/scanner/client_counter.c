@@ -0,0 +1,78 @@
+#include <string.h>
+
+#include "client_counter.h"
+
+#define MAC_MULTICAST   0x01
+#define MAC_LOCAL       0x02
+
+// Elements that vary per probe rather than per device
+static bool ie_is_volatile(uint8_t id)
+{
+    return id == IEEE80211_IE_SSID || id == IEEE80211_IE_DS_PARAMS;
+}
+
+// FNV-1a over the stable IEs, same finalizer as hll_hash_bytes
+static uint32_t probe_fingerprint(const ieee80211_mgmt_t *mgmt)
+{
+    ieee80211_ie_iter_t it;
+    uint8_t id;
+    uint8_t len;
+    const uint8_t *data;
+    uint32_t h = 2166136261u;
+
+    ieee80211_ie_iter_init(&it, mgmt->body, mgmt->body_len);
+    while (ieee80211_ie_next(&it, &id, &data, &len)) {
+        if (ie_is_volatile(id)) {
+            continue;
+        }
+        h = (h ^ id) * 16777619u;
+        for (int i = 0; i < len; i++) {
+            h = (h ^ data[i]) * 16777619u;
+        }
+    }
+
+    return hll_hash_bytes(&h, sizeof(h));
+}
+
+void client_counter_init(client_counter_t *cc, int64_t short_window_us, int64_t long_window_us,
+                         int64_t now_us)
+{
+    const int64_t window_us[CLIENT_WINDOW_COUNT] = { short_window_us, long_window_us };
+
+    for (int w = 0; w < CLIENT_WINDOW_COUNT; w++) {
+        hll_window_init(&cc->global[w], window_us[w] / HLL_WINDOW_SLOTS, now_us);
+        hll_window_init(&cc->randomized[w], window_us[w] / HLL_WINDOW_SLOTS, now_us);
+    }
+    cc->probes = 0;
+}
+
+void client_counter_add(client_counter_t *cc, const ieee80211_mgmt_t *mgmt, int64_t now_us)
+{
+    const uint8_t *sa = mgmt->sa;
+
+    if (sa[0] & MAC_MULTICAST) {
+        return;
+    }
+    cc->probes++;
+
+    if (sa[0] & MAC_LOCAL) {
+        uint32_t h = probe_fingerprint(mgmt);
+        for (int w = 0; w < CLIENT_WINDOW_COUNT; w++) {
+            hll_window_add(&cc->randomized[w], h, now_us);
+        }
+    } else {
+        uint32_t h = hll_hash_bytes(sa, 6);
+        for (int w = 0; w < CLIENT_WINDOW_COUNT; w++) {
+            hll_window_add(&cc->global[w], h, now_us);
+        }
+    }
+}
+
+void client_counter_get(client_counter_t *cc, int64_t now_us, client_counts_t *counts)
+{
+    for (int w = 0; w < CLIENT_WINDOW_COUNT; w++) {
+        counts->global[w] = hll_window_estimate(&cc->global[w], now_us);
+        counts->randomized[w] = hll_window_estimate(&cc->randomized[w], now_us);
+    }
+    counts->probes = cc->probes;
+}
@@ -0,0 +1,87 @@
+#include "cobs.h"
+
+void cobs_encoder_init(cobs_encoder_t *enc, uint8_t *out, size_t cap)
+{
+    enc->out = out;
+    enc->cap = cap;
+    enc->code_pos = 0;
+    enc->pos = 1;
+    enc->code = 1;
+    enc->overflow = cap < 1;
+}
+
+static void cobs_close_block(cobs_encoder_t *enc)
+{
+    enc->out[enc->code_pos] = enc->code;
+    enc->code_pos = enc->pos++;
+    enc->code = 1;
+}
+
+void cobs_encoder_push(cobs_encoder_t *enc, const uint8_t *src, size_t len)
+{
+    for (size_t i = 0; i < len && !enc->overflow; i++) {
+        // Every path below may claim one more output byte
+        if (enc->pos >= enc->cap) {
+            enc->overflow = 1;
+            break;
+        }
+        if (src[i] == 0) {
+            cobs_close_block(enc);
+            continue;
+        }
+        enc->out[enc->pos++] = src[i];
+        if (++enc->code == 0xFF) {
+            if (enc->pos >= enc->cap) {
+                enc->overflow = 1;
+                break;
+            }
+            cobs_close_block(enc);
+        }
+    }
+}
+
+size_t cobs_encoder_finish(cobs_encoder_t *enc)
+{
+    if (enc->overflow) {
+        return 0;
+    }
+    enc->out[enc->code_pos] = enc->code;
+    return enc->pos;
+}
+
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *out, size_t out_cap)
+{
+    cobs_encoder_t enc;
+
+    cobs_encoder_init(&enc, out, out_cap);
+    cobs_encoder_push(&enc, src, len);
+    return cobs_encoder_finish(&enc);
+}
+
+size_t cobs_decode(const uint8_t *src, size_t len, uint8_t *out, size_t out_cap)
+{
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len) {
+        uint8_t code = src[i++];
+        if (code == 0 || i + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t k = 1; k < code; k++) {
+            if (o >= out_cap) {
+                return 0;
+            }
+            out[o++] = src[i++];
+        }
+        // A full 0xFF block carries no implicit zero, nor does the last block
+        if (code != 0xFF && i < len) {
+            if (o >= out_cap) {
+                return 0;
+            }
+            out[o++] = 0;
+        }
+    }
+
+    return o;
+}
@@ -0,0 +1,129 @@
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "dlog.h"
+
+static const char *TAG = "DLOG";
+
+#define DLOG_DRAIN_STACK        3072
+#define DLOG_DRAIN_PRIO         1
+
+static void print_entry(const dlog_entry_t *e)
+{
+    char line[128];
+    dlog_format(e, line, sizeof(line));
+
+    switch (dlog_event_level(e->id)) {
+    case DLOG_LEVEL_E:
+        ESP_LOGE(TAG, "[%lu.%03lu] %s", (unsigned long)(e->timestamp_us / 1000000),
+                 (unsigned long)(e->timestamp_us / 1000 % 1000), line);
+        break;
+    case DLOG_LEVEL_W:
+        ESP_LOGW(TAG, "[%lu.%03lu] %s", (unsigned long)(e->timestamp_us / 1000000),
+                 (unsigned long)(e->timestamp_us / 1000 % 1000), line);
+        break;
+    default:
+        ESP_LOGI(TAG, "[%lu.%03lu] %s", (unsigned long)(e->timestamp_us / 1000000),
+                 (unsigned long)(e->timestamp_us / 1000 % 1000), line);
+        break;
+    }
+}
+
+#if CONFIG_SCANNER_DLOG_ENABLE
+_Static_assert((CONFIG_SCANNER_DLOG_SLOTS & (CONFIG_SCANNER_DLOG_SLOTS - 1)) == 0,
+               "CONFIG_SCANNER_DLOG_SLOTS must be a power of two");
+
+static dlog_slot_t slots[CONFIG_SCANNER_DLOG_SLOTS];
+static dlog_ring_t ring;
+static dlog_config_t config;
+static TaskHandle_t drain_task = NULL;
+
+void dlog_write(uint16_t id, const uint32_t *args, uint8_t nargs)
+{
+    if (!drain_task) {
+        return;
+    }
+
+    dlog_ring_push(&ring, (uint32_t)esp_timer_get_time(), id, args, nargs);
+    // Wake the drain early once half full; otherwise it comes round on its period
+    if (dlog_ring_fill(&ring) == CONFIG_SCANNER_DLOG_SLOTS / 2) {
+        xTaskNotifyGive(drain_task);
+    }
+}
+
+static void drain_task_fn(void *arg)
+{
+    static uint8_t batch[DLOG_BATCH_MAX];
+    static dlog_entry_t pending[DLOG_BATCH_MAX / 7];
+    uint32_t dropped_seen = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_SCANNER_DLOG_DRAIN_MS));
+
+        dlog_entry_t e;
+        bool have = dlog_ring_pop(&ring, &e);
+        while (have) {
+            // Fill one payload; the entry that doesn't fit starts the next
+            size_t len = DLOG_WIRE_HDR_LEN;
+            uint8_t n = 0;
+            size_t used;
+            while (have && n < 255 &&
+                   (used = dlog_encode_entry(&e, batch + len, sizeof(batch) - len)) > 0) {
+                pending[n++] = e;
+                len += used;
+                have = dlog_ring_pop(&ring, &e);
+            }
+
+            uint32_t dropped = atomic_load_explicit(&ring.dropped, memory_order_relaxed);
+            dlog_encode_finish(batch, dropped, n);
+            if (!config.sink || !config.sink(batch, len, config.arg)) {
+                for (uint8_t i = 0; i < n; i++) {
+                    print_entry(&pending[i]);
+                }
+            }
+            if (dropped != dropped_seen) {
+                ESP_LOGW(TAG, "%lu entries dropped, ring full",
+                         (unsigned long)(dropped - dropped_seen));
+                dropped_seen = dropped;
+            }
+        }
+    }
+}
+
+esp_err_t dlog_start(const dlog_config_t *cfg)
+{
+    if (drain_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    config = *cfg;
+    dlog_ring_init(&ring, slots, CONFIG_SCANNER_DLOG_SLOTS);
+
+    if (xTaskCreate(drain_task_fn, "dlog", DLOG_DRAIN_STACK, NULL, DLOG_DRAIN_PRIO,
+                    &drain_task) != pdPASS) {
+        drain_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+#else
+void dlog_write(uint16_t id, const uint32_t *args, uint8_t nargs)
+{
+    dlog_entry_t e = {
+        .timestamp_us = (uint32_t)esp_timer_get_time(),
+        .id = id,
+        .nargs = nargs > DLOG_MAX_ARGS ? DLOG_MAX_ARGS : nargs,
+    };
+    memcpy(e.args, args, e.nargs * sizeof(uint32_t));
+    print_entry(&e);
+}
+
+esp_err_t dlog_start(const dlog_config_t *cfg)
+{
+    return ESP_OK;
+}
+#endif
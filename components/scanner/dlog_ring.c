@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "dlog_ring.h"
+
+#define DLOG_EVENT_FMT_(name, level, fmt) fmt,
+static const char *const event_fmt[DLOG_EV_COUNT] = {
+    DLOG_EVENTS(DLOG_EVENT_FMT_)
+};
+
+#define DLOG_EVENT_NAME_(name, level, fmt) #name,
+static const char *const event_name[DLOG_EV_COUNT] = {
+    DLOG_EVENTS(DLOG_EVENT_NAME_)
+};
+
+#define DLOG_EVENT_LEVEL_(name, level, fmt) DLOG_LEVEL_##level,
+static const uint8_t event_level[DLOG_EV_COUNT] = {
+    DLOG_EVENTS(DLOG_EVENT_LEVEL_)
+};
+
+/* ===================== RING ===================== */
+void dlog_ring_init(dlog_ring_t *r, dlog_slot_t *slots, size_t n)
+{
+    r->slots = slots;
+    r->mask = (uint32_t)n - 1;
+    r->tail = 0;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->dropped, 0);
+    for (size_t i = 0; i < n; i++) {
+        atomic_init(&slots[i].seq, (uint32_t)i);
+    }
+}
+
+bool dlog_ring_push(dlog_ring_t *r, uint32_t timestamp_us, uint16_t id, const uint32_t *args,
+                    uint8_t nargs)
+{
+    uint32_t pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+    dlog_slot_t *slot;
+
+    while (1) {
+        slot = &r->slots[pos & r->mask];
+        uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int32_t dif = (int32_t)(seq - pos);
+
+        if (dif == 0) {
+            // Free for this lap; claim it unless another producer got there
+            if (atomic_compare_exchange_weak_explicit(&r->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            // Still holding last lap's entry: full
+            atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+        }
+    }
+
+    if (nargs > DLOG_MAX_ARGS) {
+        nargs = DLOG_MAX_ARGS;
+    }
+    slot->entry.timestamp_us = timestamp_us;
+    slot->entry.id = id;
+    slot->entry.nargs = nargs;
+    memcpy(slot->entry.args, args, nargs * sizeof(uint32_t));
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+bool dlog_ring_pop(dlog_ring_t *r, dlog_entry_t *out)
+{
+    dlog_slot_t *slot = &r->slots[r->tail & r->mask];
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+    if (seq != r->tail + 1) {
+        return false;
+    }
+
+    *out = slot->entry;
+    // Hand the slot to the producer one lap ahead
+    atomic_store_explicit(&slot->seq, r->tail + r->mask + 1, memory_order_release);
+    r->tail++;
+    return true;
+}
+
+uint32_t dlog_ring_fill(dlog_ring_t *r)
+{
+    return atomic_load_explicit(&r->head, memory_order_relaxed) - r->tail;
+}
+
+/* ===================== WIRE ===================== */
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+size_t dlog_encode_entry(const dlog_entry_t *e, uint8_t *out, size_t cap)
+{
+    size_t len = 7 + 4 * (size_t)e->nargs;
+    if (cap < len) {
+        return 0;
+    }
+
+    put_u32(out, e->timestamp_us);
+    put_u16(out + 4, e->id);
+    out[6] = e->nargs;
+    for (uint8_t i = 0; i < e->nargs; i++) {
+        put_u32(out + 7 + 4 * i, e->args[i]);
+    }
+    return len;
+}
+
+void dlog_encode_finish(uint8_t *out, uint32_t dropped, uint8_t n)
+{
+    put_u32(out, dropped);
+    out[4] = n;
+}
+
+size_t dlog_decode_header(const uint8_t *in, size_t len, uint32_t *dropped, uint8_t *n)
+{
+    if (len < DLOG_WIRE_HDR_LEN) {
+        return 0;
+    }
+    *dropped = get_u32(in);
+    *n = in[4];
+    return DLOG_WIRE_HDR_LEN;
+}
+
+size_t dlog_decode_entry(const uint8_t *in, size_t len, dlog_entry_t *out)
+{
+    if (len < 7 || in[6] > DLOG_MAX_ARGS || len < 7 + 4 * (size_t)in[6]) {
+        return 0;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->timestamp_us = get_u32(in);
+    out->id = get_u16(in + 4);
+    out->nargs = in[6];
+    for (uint8_t i = 0; i < out->nargs; i++) {
+        out->args[i] = get_u32(in + 7 + 4 * i);
+    }
+    return 7 + 4 * (size_t)out->nargs;
+}
+
+/* ===================== FORMAT ===================== */
+const char *dlog_event_name(uint16_t id)
+{
+    return id < DLOG_EV_COUNT ? event_name[id] : "?";
+}
+
+dlog_level_t dlog_event_level(uint16_t id)
+{
+    return id < DLOG_EV_COUNT ? (dlog_level_t)event_level[id] : DLOG_LEVEL_I;
+}
+
+int dlog_format(const dlog_entry_t *e, char *buf, size_t cap)
+{
+    size_t len = 0;
+    uint8_t arg = 0;
+
+// snprintf-style accounting: keep counting past cap, write what fits
+#define EMIT(...) do {                                                          \
+        int n_ = snprintf(buf + (len < cap ? len : cap), len < cap ? cap - len : 0, \
+                          __VA_ARGS__);                                         \
+        len += n_ > 0 ? (size_t)n_ : 0;                                         \
+    } while (0)
+
+    if (cap > 0) {
+        buf[0] = '\0';
+    }
+    if (e->id >= DLOG_EV_COUNT) {
+        EMIT("event %u:", e->id);
+        for (uint8_t i = 0; i < e->nargs; i++) {
+            EMIT(" %lu", (unsigned long)e->args[i]);
+        }
+        return (int)len;
+    }
+
+    const char *p = event_fmt[e->id];
+    while (*p) {
+        if (*p != '%') {
+            EMIT("%c", *p++);
+            continue;
+        }
+        if (p[1] == '%') {
+            EMIT("%%");
+            p += 2;
+            continue;
+        }
+
+        // Flags, width and precision are kept; length modifiers dropped
+        // since every argument is a u32
+        char spec[16];
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && n < sizeof(spec) - 2) {
+            spec[n++] = *p++;
+        }
+        while (*p && strchr("hlzjt", *p)) {
+            p++;
+        }
+        char conv = *p ? *p++ : 'u';
+        spec[n++] = conv;
+        spec[n] = '\0';
+
+        uint32_t v = arg < e->nargs ? e->args[arg] : 0;
+        arg++;
+        switch (conv) {
+        case 'd':
+        case 'i':
+        case 'c':
+            EMIT(spec, (int)(int32_t)v);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            EMIT(spec, (unsigned)v);
+            break;
+        default:
+            EMIT("%s", spec);
+            break;
+        }
+    }
+#undef EMIT
+
+    return (int)len;
+}
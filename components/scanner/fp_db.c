@@ -0,0 +1,215 @@
+#include <string.h>
+
+#include "fp_db.h"
+
+int fp_db_find(const fp_db_t *db, const uint8_t bssid[6])
+{
+    size_t lo = 0, hi = db->n_bssids;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int c = memcmp(db->bssids + mid * 6, bssid, 6);
+        if (c == 0) {
+            return (int)mid;
+        }
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
+}
+
+/* ===================== QUERY ===================== */
+size_t fp_query_load(const fp_db_t *db, fp_query_t *q, const scan_record_t *recs, size_t n)
+{
+    q->n = 0;
+    q->unknown = 0;
+    for (size_t i = 0; i < n; i++) {
+        int d = fp_db_find(db, recs[i].bssid);
+        if (d < 0) {
+            q->unknown += q->unknown < UINT8_MAX;
+            continue;
+        }
+        uint8_t v = fp_db_quantize(db, recs[i].rssi);
+        uint8_t j = 0;
+        while (j < q->n && q->idx[j] != d) {
+            j++;
+        }
+        if (j == q->n) {
+            if (q->n == FP_QUERY_MAX) {
+                continue;
+            }
+            q->idx[q->n] = (uint16_t)d;
+            q->q[q->n++] = v;
+        } else if (v > q->q[j]) {
+            q->q[j] = v;
+        }
+    }
+
+    q->norm2 = 0;
+    for (uint8_t i = 0; i < q->n; i++) {
+        q->norm2 += (uint32_t)q->q[i] * q->q[i];
+    }
+    return q->n;
+}
+
+/* ===================== MATCHING ===================== */
+typedef struct {
+    uint32_t dist;
+    uint16_t fp;
+    uint16_t loc;
+} candidate_t;
+
+static int candidate_before(uint32_t dist, uint16_t fp, const candidate_t *c)
+{
+    return dist < c->dist || (dist == c->dist && fp < c->fp);
+}
+
+// Keeps the best k distinct locations, nearest first; returns the new count
+static size_t top_offer(candidate_t *top, size_t n, size_t k, uint16_t loc, uint32_t dist,
+                        uint16_t fp)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (top[i].loc != loc) {
+            continue;
+        }
+        if (!candidate_before(dist, fp, &top[i])) {
+            return n;
+        }
+        memmove(&top[i], &top[i + 1], (n - i - 1) * sizeof(*top));
+        n--;
+        break;
+    }
+    if (n == k && !candidate_before(dist, fp, &top[k - 1])) {
+        return n;
+    }
+
+    size_t i = n < k ? n : k - 1;
+    while (i > 0 && candidate_before(dist, fp, &top[i - 1])) {
+        top[i] = top[i - 1];
+        i--;
+    }
+    top[i] = (candidate_t){ .dist = dist, .fp = fp, .loc = loc };
+    return n < k ? n + 1 : k;
+}
+
+size_t fp_db_match(const fp_db_t *db, const fp_query_t *q, uint32_t *acc, fp_match_t *out,
+                   size_t k, fp_match_stats_t *stats)
+{
+    candidate_t top[FP_MATCH_MAX];
+    size_t n = 0;
+
+    k = k < FP_MATCH_MAX ? k : FP_MATCH_MAX;
+    if (k == 0 || db->n_fps == 0) {
+        return 0;
+    }
+
+    // Dot products, from the posting lists of the APs heard only
+    memset(acc, 0, db->n_fps * sizeof(*acc));
+    for (uint8_t i = 0; i < q->n; i++) {
+        const uint32_t end = db->post[q->idx[i] + 1];
+        const uint32_t s = q->q[i];
+        for (uint32_t p = db->post[q->idx[i]]; p < end; p++) {
+            acc[db->fp[p]] += s * db->q[p];
+        }
+        if (stats) {
+            stats->postings += end - db->post[q->idx[i]];
+        }
+    }
+
+    // One sweep; a fingerprint that shares nothing sits at |f|^2 + |s|^2
+    uint32_t bound = UINT32_MAX;
+    for (uint16_t f = 0; f < db->n_fps; f++) {
+        uint32_t dist = db->norm2[f] + q->norm2 - 2 * acc[f];
+        if (stats) {
+            stats->touched += acc[f] != 0;
+        }
+        if (dist > bound) {
+            continue;
+        }
+        n = top_offer(top, n, k, db->loc[f], dist, f);
+        bound = n == k ? top[k - 1].dist : UINT32_MAX;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        out[i].loc = top[i].loc;
+        out[i].dist = top[i].dist;
+    }
+    return n;
+}
+
+size_t fp_db_footprint(const fp_db_t *db)
+{
+    return (size_t)db->n_bssids * (6 + 4) + 4 + (size_t)db->n_postings * 3 +
+           (size_t)db->n_fps * (2 + 4);
+}
+
+/* ===================== WIRE ===================== */
+size_t fp_result_encode(const fp_result_t *r, uint8_t *out, size_t cap)
+{
+    uint8_t k = r->k < FP_MATCH_MAX ? r->k : FP_MATCH_MAX;
+    size_t len = FP_WIRE_HDR_LEN + (size_t)k * FP_WIRE_MATCH_LEN;
+    if (cap < len) {
+        return 0;
+    }
+
+    out[0] = (uint8_t)r->version;
+    out[1] = (uint8_t)(r->version >> 8);
+    out[2] = (uint8_t)(r->version >> 16);
+    out[3] = (uint8_t)(r->version >> 24);
+    out[4] = r->step_db;
+    out[5] = r->heard;
+    out[6] = r->unknown;
+    out[7] = k;
+    uint8_t *p = out + FP_WIRE_HDR_LEN;
+    for (uint8_t i = 0; i < k; i++) {
+        p[0] = (uint8_t)r->match[i].loc;
+        p[1] = (uint8_t)(r->match[i].loc >> 8);
+        p[2] = (uint8_t)r->match[i].dist;
+        p[3] = (uint8_t)(r->match[i].dist >> 8);
+        p[4] = (uint8_t)(r->match[i].dist >> 16);
+        p[5] = (uint8_t)(r->match[i].dist >> 24);
+        p += FP_WIRE_MATCH_LEN;
+    }
+    return len;
+}
+
+size_t fp_result_decode(const uint8_t *in, size_t len, fp_result_t *out)
+{
+    if (len < FP_WIRE_HDR_LEN || in[7] > FP_MATCH_MAX ||
+        len < FP_WIRE_HDR_LEN + (size_t)in[7] * FP_WIRE_MATCH_LEN) {
+        return 0;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->version = in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+    out->step_db = in[4];
+    out->heard = in[5];
+    out->unknown = in[6];
+    out->k = in[7];
+    const uint8_t *p = in + FP_WIRE_HDR_LEN;
+    for (uint8_t i = 0; i < out->k; i++) {
+        out->match[i].loc = (uint16_t)(p[0] | p[1] << 8);
+        out->match[i].dist = p[2] | (uint32_t)p[3] << 8 | (uint32_t)p[4] << 16 |
+                             (uint32_t)p[5] << 24;
+        p += FP_WIRE_MATCH_LEN;
+    }
+    return FP_WIRE_HDR_LEN + (size_t)out->k * FP_WIRE_MATCH_LEN;
+}
+
+size_t fp_db_locate(const fp_db_t *db, const scan_record_t *recs, size_t n, uint32_t *acc,
+                    size_t k, fp_result_t *out)
+{
+    fp_query_t q;
+
+    memset(out, 0, sizeof(*out));
+    out->version = db->version;
+    out->step_db = db->step_db;
+    out->heard = (uint8_t)fp_query_load(db, &q, recs, n);
+    out->unknown = q.unknown;
+    if (q.n > 0) {
+        out->k = (uint8_t)fp_db_match(db, &q, acc, out->match, k, NULL);
+    }
+    return out->k;
+}
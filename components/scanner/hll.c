@@ -0,0 +1,137 @@
+#include <math.h>
+#include <string.h>
+
+#include "hll.h"
+
+#define HLL_RANK_MAX 15
+
+static uint8_t reg_get(const hll_t *hll, uint32_t idx)
+{
+    uint8_t b = hll->reg[idx >> 1];
+    return (idx & 1) ? (b >> 4) : (b & 0x0F);
+}
+
+static void reg_set(hll_t *hll, uint32_t idx, uint8_t val)
+{
+    uint8_t *b = &hll->reg[idx >> 1];
+    *b = (idx & 1) ? ((*b & 0x0F) | (val << 4)) : ((*b & 0xF0) | val);
+}
+
+void hll_clear(hll_t *hll)
+{
+    memset(hll->reg, 0, sizeof(hll->reg));
+}
+
+void hll_add(hll_t *hll, uint32_t hash)
+{
+    uint32_t idx = hash >> (32 - HLL_P);
+    uint32_t rest = hash << HLL_P;
+
+    // Rank = position of the first set bit in the remaining bits, 1-based
+    uint8_t rank = 1;
+    while (rank < HLL_RANK_MAX && !(rest & 0x80000000u)) {
+        rest <<= 1;
+        rank++;
+    }
+
+    if (rank > reg_get(hll, idx)) {
+        reg_set(hll, idx, rank);
+    }
+}
+
+void hll_merge(hll_t *dst, const hll_t *src)
+{
+    for (int i = 0; i < HLL_BYTES; i++) {
+        uint8_t a = dst->reg[i];
+        uint8_t b = src->reg[i];
+        uint8_t lo = (a & 0x0F) > (b & 0x0F) ? (a & 0x0F) : (b & 0x0F);
+        uint8_t hi = (a & 0xF0) > (b & 0xF0) ? (a & 0xF0) : (b & 0xF0);
+        dst->reg[i] = hi | lo;
+    }
+}
+
+uint32_t hll_estimate(const hll_t *hll)
+{
+    const float m = HLL_REGISTERS;
+    const float alpha = 0.7213f / (1.0f + 1.079f / m);
+    float sum = 0.0f;
+    int zeros = 0;
+
+    for (int i = 0; i < HLL_REGISTERS; i++) {
+        uint8_t r = reg_get(hll, i);
+        sum += 1.0f / (float)(1u << r);
+        if (r == 0) {
+            zeros++;
+        }
+    }
+
+    float est = alpha * m * m / sum;
+
+    // Small-range correction: linear counting is far better below 2.5m
+    if (est <= 2.5f * m && zeros > 0) {
+        est = m * logf(m / zeros);
+    }
+
+    return (uint32_t)(est + 0.5f);
+}
+
+uint32_t hll_hash_bytes(const void *data, size_t len)
+{
+    // FNV-1a followed by the murmur3 finalizer for good high-bit mixing
+    const uint8_t *p = data;
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+
+    return h;
+}
+
+/* ===================== SLIDING WINDOW ===================== */
+static void window_advance(hll_window_t *w, int64_t now_us)
+{
+    // Bounded by the slot count: a long gap just clears everything once
+    for (int i = 0; i < HLL_WINDOW_SLOTS && now_us - w->slot_start_us >= w->slot_us; i++) {
+        w->head = (w->head + 1) % HLL_WINDOW_SLOTS;
+        hll_clear(&w->slots[w->head]);
+        w->slot_start_us += w->slot_us;
+    }
+    if (now_us - w->slot_start_us >= w->slot_us) {
+        w->slot_start_us = now_us;
+    }
+}
+
+void hll_window_init(hll_window_t *w, int64_t slot_us, int64_t now_us)
+{
+    memset(w->slots, 0, sizeof(w->slots));
+    w->slot_us = slot_us;
+    w->slot_start_us = now_us;
+    w->head = 0;
+}
+
+void hll_window_add(hll_window_t *w, uint32_t hash, int64_t now_us)
+{
+    window_advance(w, now_us);
+    hll_add(&w->slots[w->head], hash);
+}
+
+uint32_t hll_window_estimate(hll_window_t *w, int64_t now_us)
+{
+    hll_t merged;
+
+    window_advance(w, now_us);
+    merged = w->slots[0];
+    for (int i = 1; i < HLL_WINDOW_SLOTS; i++) {
+        hll_merge(&merged, &w->slots[i]);
+    }
+
+    return hll_estimate(&merged);
+}
@@ -0,0 +1,132 @@
+#include "ieee80211_parse.h"
+
+#define FC_TYPE(fc)         (((fc) >> 2) & 0x3)
+#define FC_SUBTYPE(fc)      (((fc) >> 4) & 0xF)
+#define FC_TYPE_MGMT        0
+
+#define BSS_FIXED_LEN       12  // timestamp(8) interval(2) capability(2)
+#define CAP_PRIVACY         0x0010
+
+static const uint8_t wpa_oui_type[4] = { 0x00, 0x50, 0xF2, 0x01 };
+
+bool ieee80211_parse_mgmt(const uint8_t *frame, size_t len, bool has_fcs, ieee80211_mgmt_t *mgmt)
+{
+    if (has_fcs) {
+        if (len < IEEE80211_FCS_LEN) {
+            return false;
+        }
+        len -= IEEE80211_FCS_LEN;
+    }
+    if (len < IEEE80211_MGMT_HDR_LEN) {
+        return false;
+    }
+
+    uint16_t fc = frame[0] | (frame[1] << 8);
+    if (FC_TYPE(fc) != FC_TYPE_MGMT) {
+        return false;
+    }
+
+    mgmt->subtype = FC_SUBTYPE(fc);
+    mgmt->da = frame + 4;
+    mgmt->sa = frame + 10;
+    mgmt->bssid = frame + 16;
+    mgmt->body = frame + IEEE80211_MGMT_HDR_LEN;
+    mgmt->body_len = len - IEEE80211_MGMT_HDR_LEN;
+
+    return true;
+}
+
+void ieee80211_ie_iter_init(ieee80211_ie_iter_t *it, const uint8_t *ies, size_t len)
+{
+    it->pos = ies;
+    it->end = ies + len;
+}
+
+bool ieee80211_ie_next(ieee80211_ie_iter_t *it, uint8_t *id, const uint8_t **data, uint8_t *len)
+{
+    if (it->end - it->pos < 2) {
+        return false;
+    }
+
+    uint8_t ie_len = it->pos[1];
+    if (it->end - it->pos - 2 < ie_len) {
+        return false;
+    }
+
+    *id = it->pos[0];
+    *len = ie_len;
+    *data = it->pos + 2;
+    it->pos += 2 + ie_len;
+
+    return true;
+}
+
+bool ieee80211_parse_bss(const ieee80211_mgmt_t *mgmt, ieee80211_bss_info_t *info)
+{
+    if (mgmt->subtype != IEEE80211_STYPE_BEACON && mgmt->subtype != IEEE80211_STYPE_PROBE_RESP) {
+        return false;
+    }
+    if (mgmt->body_len < BSS_FIXED_LEN) {
+        return false;
+    }
+
+    const uint8_t *b = mgmt->body;
+    info->beacon_interval = b[8] | (b[9] << 8);
+    info->capability = b[10] | (b[11] << 8);
+    info->ssid = NULL;
+    info->ssid_len = 0;
+    info->channel = 0;
+
+    bool rsn = false;
+    bool wpa = false;
+    bool have_ssid = false;
+
+    ieee80211_ie_iter_t it;
+    ieee80211_ie_iter_init(&it, b + BSS_FIXED_LEN, mgmt->body_len - BSS_FIXED_LEN);
+
+    uint8_t id;
+    uint8_t len;
+    const uint8_t *data;
+    while (ieee80211_ie_next(&it, &id, &data, &len)) {
+        switch (id) {
+        case IEEE80211_IE_SSID:
+            // Only the first SSID element counts; some APs repeat it
+            if (!have_ssid && len <= 32) {
+                info->ssid = data;
+                info->ssid_len = len;
+                have_ssid = true;
+            }
+            break;
+        case IEEE80211_IE_DS_PARAMS:
+            if (len >= 1) {
+                info->channel = data[0];
+            }
+            break;
+        case IEEE80211_IE_RSN:
+            rsn = true;
+            break;
+        case IEEE80211_IE_VENDOR:
+            if (len >= 4 && data[0] == wpa_oui_type[0] && data[1] == wpa_oui_type[1] &&
+                data[2] == wpa_oui_type[2] && data[3] == wpa_oui_type[3]) {
+                wpa = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (rsn && wpa) {
+        info->security = IEEE80211_SEC_WPA_WPA2;
+    } else if (rsn) {
+        info->security = IEEE80211_SEC_WPA2;
+    } else if (wpa) {
+        info->security = IEEE80211_SEC_WPA;
+    } else if (info->capability & CAP_PRIVACY) {
+        info->security = IEEE80211_SEC_WEP;
+    } else {
+        info->security = IEEE80211_SEC_OPEN;
+    }
+
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ap_table.h"
+#include "scan_record.h"
+
+/* ===================== AP SNAPSHOT =====================
+ * Serialized copy of the AP table for readers that must not stall the
+ * scanner (e.g. a GATT read served from the BLE host task).
+ *
+ * Double buffered: the single writer encodes into the back buffer and
+ * flips. A sequence counter bumped on every flip lets readers detect that
+ * the buffer they were copying got reused and retry; the writer never waits.
+ *
+ * Blob layout (little endian):
+ *   generation(u32) count(u16) timestamp_us(u64) fields(u8) record[count]
+ * with records in scan_record wire format carrying the fields in the
+ * mask (see scan_record.h). The generation only moves
+ * when the record bytes change, so a client can read the header alone
+ * and skip an unchanged snapshot.
+ *
+ * ATT caps an attribute value at 512 bytes, so a full table is handed out
+ * in pages: the blob header plus page(u8) pages(u8), then as many whole
+ * records as fit.
+ */
+
+#define AP_SNAPSHOT_HDR_LEN     15
+#define AP_SNAPSHOT_MAX_LEN     (AP_SNAPSHOT_HDR_LEN + AP_TABLE_MAX * SCAN_RECORD_MAX_LEN)
+#define AP_SNAPSHOT_PAGE_HDR_LEN (AP_SNAPSHOT_HDR_LEN + 2)
+#define AP_SNAPSHOT_PAGE_MAX    512
+
+typedef struct {
+    atomic_uint_least32_t seq;      // flips so far
+    uint8_t front;
+    uint16_t len[2];
+    uint8_t buf[2][AP_SNAPSHOT_MAX_LEN];
+    uint32_t generation;            // writer side only
+    uint32_t read_retries;
+} ap_snapshot_t;
+
+void ap_snapshot_init(ap_snapshot_t *snap);
+
+// Writer side, caller holds the table lock. Returns true if a new
+// generation was published, false if the contents were unchanged.
+bool ap_snapshot_publish(ap_snapshot_t *snap, const ap_table_t *table, int64_t now_us);
+
+// Reader side, any task. Copies the current blob into out and returns its
+// length (0 if cap is too small).
+size_t ap_snapshot_read(ap_snapshot_t *snap, uint8_t *out, size_t cap);
+
+// Parses the blob header; returns false on a short buffer
+bool ap_snapshot_parse_header(const uint8_t *blob, size_t len, uint32_t *generation,
+                              uint16_t *count, uint64_t *timestamp_us, uint8_t *fields);
+
+// Cuts page `page` of at most max_len bytes out of a blob. Returns the page
+// length, 0 if there is no such page. pages_out gets the page count.
+size_t ap_snapshot_page(const uint8_t *blob, size_t len, unsigned page,
+                        uint8_t *out, size_t max_len, unsigned *pages_out);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "oui_db.h"
+#include "rssi_distance.h"
+#include "scan_record.h"
+
+/* ===================== AP TABLE =====================
+ * Fixed-size table of access points keyed by BSSID. Fed by active scans
+ * and by the passive capture engine. Not thread safe: callers serialize.
+ */
+
+// Set from CONFIG_SCANNER_AP_TABLE_SIZE in firmware builds, -D on the host
+#ifndef AP_TABLE_MAX
+#define AP_TABLE_MAX 64
+#endif
+
+typedef struct {
+    scan_record_t rec;          // latest sample
+    int16_t rssi_avg_q4;        // EWMA, 1/16 dBm
+    uint32_t samples;
+    int64_t first_seen_us;
+    int64_t last_seen_us;
+    bool dirty;                 // updated since last ap_table_clear_dirty
+} ap_entry_t;
+
+typedef struct {
+    ap_entry_t entries[AP_TABLE_MAX];
+    uint16_t count;
+    uint32_t evictions;
+    // Optional, set after init: fills rec.distance_cm from rssi_avg_q4
+    const rssi_distance_cal_t *distance_cal;
+    // Optional, set after init: fills rec.vendor_id once per entry, when
+    // SCAN_RECORD_MASK carries the field
+    const oui_db_t *oui_db;
+} ap_table_t;
+
+void ap_table_init(ap_table_t *table);
+
+ap_entry_t *ap_table_find(ap_table_t *table, const uint8_t bssid[6]);
+
+// Inserts or refreshes an entry; when full, the least recently seen is evicted
+ap_entry_t *ap_table_update(ap_table_t *table, const scan_record_t *rec, int64_t now_us);
+
+// Drops entries not seen for max_age_us, returns how many were removed
+size_t ap_table_expire(ap_table_t *table, int64_t now_us, int64_t max_age_us);
+
+void ap_table_clear_dirty(ap_table_t *table);
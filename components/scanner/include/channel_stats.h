@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scan_record.h"
+
+/* ===================== CHANNEL CONGESTION =====================
+ * Per-channel occupancy for 2.4 GHz channel planning, built one scan
+ * record at a time. Each AP adds its received power to its own channel
+ * and, scaled by the spectral overlap of 20 MHz channels 5 MHz apart, to
+ * up to four neighbours on either side. Everything is integer: power is
+ * linear in Q8 relative to -100 dBm, converted with small dB tables.
+ *
+ * Wire form (stream frame payload / GATT value):
+ *   n(u8) then n x { channel(u8) ap_count(u8) strongest(i8)
+ *                    interference_dbm(i8) load(u8) }
+ */
+
+#define CHANNEL_STATS_MAX       14
+#define CHANNEL_STATS_NONE      (-128)      // strongest/interference with nothing heard
+#define CHANNEL_STATS_ENTRY_LEN 5
+#define CHANNEL_STATS_WIRE_LEN  (1 + CHANNEL_STATS_MAX * CHANNEL_STATS_ENTRY_LEN)
+
+typedef struct {
+    uint8_t ap_count;           // APs with this primary channel
+    int8_t strongest;           // dBm
+    int8_t interference_dbm;    // overlap-weighted power from all APs
+    uint8_t load;               // 0-100, interference mapped from -95 to -30 dBm
+} channel_stat_t;
+
+typedef struct {
+    uint64_t power_q8[CHANNEL_STATS_MAX + 1];   // index = channel
+    uint8_t ap_count[CHANNEL_STATS_MAX + 1];
+    int8_t strongest[CHANNEL_STATS_MAX + 1];
+} channel_stats_t;
+
+void channel_stats_reset(channel_stats_t *cs);
+
+// Constant time per record; 5 GHz records are ignored
+void channel_stats_add(channel_stats_t *cs, const scan_record_t *rec);
+
+// out is indexed by channel, out[0] unused
+void channel_stats_finish(const channel_stats_t *cs, channel_stat_t out[CHANNEL_STATS_MAX + 1]);
+
+// Returns bytes written, or 0 if cap is too small
+size_t channel_stats_encode(const channel_stat_t stats[CHANNEL_STATS_MAX + 1], uint8_t *out,
+                            size_t cap);
+
+// Returns bytes consumed, or 0 on malformed input; absent channels read as empty
+size_t channel_stats_decode(const uint8_t *in, size_t len, channel_stat_t out[CHANNEL_STATS_MAX + 1]);
+
+// Integer dB <-> linear power (Q8, 0 dB = 1.0)
+uint64_t channel_stats_db_to_q8(int db);
+int channel_stats_q8_to_db(uint64_t p_q8);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "hll.h"
+#include "ieee80211_parse.h"
+
+/* ===================== CLIENT COUNTER =====================
+ * Estimates distinct nearby clients from probe requests over a short and
+ * a long sliding window. Randomized (locally administered) MACs rotate,
+ * so counting them by address would inflate the result; they are counted
+ * by a fingerprint of their probe IEs instead and reported separately.
+ */
+
+typedef enum {
+    CLIENT_WINDOW_SHORT,
+    CLIENT_WINDOW_LONG,
+    CLIENT_WINDOW_COUNT,
+} client_window_t;
+
+typedef struct {
+    hll_window_t global[CLIENT_WINDOW_COUNT];
+    hll_window_t randomized[CLIENT_WINDOW_COUNT];
+    uint32_t probes;
+} client_counter_t;
+
+typedef struct {
+    uint32_t global[CLIENT_WINDOW_COUNT];
+    uint32_t randomized[CLIENT_WINDOW_COUNT];
+    uint32_t probes;
+} client_counts_t;
+
+void client_counter_init(client_counter_t *cc, int64_t short_window_us, int64_t long_window_us,
+                         int64_t now_us);
+
+// mgmt must be a probe request
+void client_counter_add(client_counter_t *cc, const ieee80211_mgmt_t *mgmt, int64_t now_us);
+
+void client_counter_get(client_counter_t *cc, int64_t now_us, client_counts_t *counts);
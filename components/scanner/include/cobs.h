@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== COBS FRAMING =====================
+ * Consistent Overhead Byte Stuffing. Encoded output never contains 0x00,
+ * so a single zero byte can delimit frames on a raw serial stream.
+ */
+
+// Worst-case encoded size for a payload of len bytes (no delimiter)
+#define COBS_MAX_ENCODED_LEN(len) ((len) + ((len) / 254) + 1)
+
+// Returns encoded length, or 0 if out_cap is too small
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *out, size_t out_cap);
+
+// Incremental encoder, so a frame can be encoded from scattered pieces
+// (header, payload, CRC) without first assembling it in a scratch buffer
+typedef struct {
+    uint8_t *out;
+    size_t cap;
+    size_t pos;
+    size_t code_pos;
+    uint8_t code;
+    int overflow;
+} cobs_encoder_t;
+
+void cobs_encoder_init(cobs_encoder_t *enc, uint8_t *out, size_t cap);
+void cobs_encoder_push(cobs_encoder_t *enc, const uint8_t *src, size_t len);
+
+// Returns encoded length, or 0 if the output buffer overflowed
+size_t cobs_encoder_finish(cobs_encoder_t *enc);
+
+// Returns decoded length, or 0 on malformed input / small buffer
+size_t cobs_decode(const uint8_t *src, size_t len, uint8_t *out, size_t out_cap);
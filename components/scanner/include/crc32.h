@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32/ISO-HDLC (zlib polynomial), pass 0 as the initial crc
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "dlog_ring.h"
+
+/* ===================== DEFERRED LOGGING =====================
+ * Hot-path logging that costs a ring push instead of a printf and a
+ * blocking UART write:
+ *
+ *   DLOG(SCAN_DONE, ap_num, fusion.scans);
+ *
+ * records the event ID from dlog_events.h, a timestamp and the raw
+ * arguments. A low-priority drain task hands batches to the binary sink
+ * (a stream frame, formatted on the host) or, with no sink, formats and
+ * prints them itself, off the caller's time.
+ *
+ * Arguments are converted to u32; pass integers only. Task context only:
+ * the producer may wake the drain task.
+ *
+ * With CONFIG_SCANNER_DLOG_ENABLE off, DLOG formats and prints inline,
+ * like ESP_LOGx.
+ */
+
+typedef struct {
+    // Optional, drain task context. Takes one wire payload (dlog_ring.h);
+    // returns false to have that batch printed locally instead.
+    bool (*sink)(const uint8_t *payload, size_t len, void *arg);
+    void *arg;
+} dlog_config_t;
+
+esp_err_t dlog_start(const dlog_config_t *cfg);
+
+void dlog_write(uint16_t id, const uint32_t *args, uint8_t nargs);
+
+// Largest payload the drain task hands to the sink
+#define DLOG_BATCH_MAX          512
+
+#define DLOG(ev, ...) do {                                                      \
+        const uint32_t dlog_args_[] = { 0, ##__VA_ARGS__ };                     \
+        dlog_write(DLOG_EV_##ev, dlog_args_ + 1,                                \
+                   sizeof(dlog_args_) / sizeof(dlog_args_[0]) - 1);             \
+    } while (0)
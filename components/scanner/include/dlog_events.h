@@ -0,0 +1,27 @@
+#pragma once
+
+/* ===================== DEFERRED LOG EVENTS =====================
+ * Every deferred log line, declared once. The device records only the
+ * event's index and its raw arguments; the format string is applied
+ * later, by the drain task or by a host tool compiled against this same
+ * table.
+ *
+ * X(NAME, level, format). Formats take integer conversions only (d i u x
+ * X o c, with flags and width), one u32 argument each, at most
+ * DLOG_MAX_ARGS. Append new events at the end: the index is the wire ID.
+ */
+
+#define DLOG_EVENTS(X)                                                              \
+    X(SCAN_CYCLE,       I, "=== Scan cycle %u ===")                                 \
+    X(WIFI_UP,          I, "WiFi up for scanning in %u ms")                         \
+    X(WIFI_NO_START,    W, "No STA_START event, scanning anyway")                   \
+    X(SCAN_FAILED,      E, "Scan failed: 0x%x")                                     \
+    X(FUSION_DROPPED,   W, "%u sightings beyond %u APs dropped")                    \
+    X(SCAN_DONE,        I, "Found %u networks in %u scans")                         \
+    X(SCAN_AP,          I, "  %06x%06x %4d dBm ch%-2u seen %u/%u")                  \
+    X(STREAM_DROPPED,   W, "Stream frame dropped")                                  \
+    X(SCAN_DUTY,        I, "Churn %d/1000, radio duty %u.%u%% (fixed 30 s: %u.%u%%)") \
+    X(NEXT_SCAN,        I, "Next scan %u ms after this one started")                \
+    X(FUSED,            I, "Fused %u scans: %u APs, %u in every scan")              \
+    X(SCAN_INTERVAL,    I, "Churn %d/1000, next scan in %u ms, radio duty %u.%u%% (fixed 5 s: %u.%u%%)") \
+    X(LOCATED,          I, "Location %u at distance %u; %u APs known, %u not; %u us")
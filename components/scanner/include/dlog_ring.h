@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dlog_events.h"
+
+/* ===================== DEFERRED LOG RING =====================
+ * Fixed-size binary log entries (event ID, timestamp, raw u32 arguments)
+ * in a bounded lock-free ring: any number of producers, one consumer.
+ * Each slot carries a sequence number; a producer claims a slot with one
+ * compare-and-swap on the head and publishes it by storing the slot's
+ * sequence, so a producer preempted mid-write only holds back the
+ * consumer, never other producers. When the ring is full the entry is
+ * dropped and counted; logging never blocks.
+ *
+ * Wire form (stream frame payload):
+ *   dropped(u32) n(u8)
+ *   then n x { timestamp_us(u32) id(u16) nargs(u8) args[nargs](u32) },
+ *   little-endian. dropped is the running total since boot.
+ */
+
+#define DLOG_MAX_ARGS           6
+#define DLOG_WIRE_HDR_LEN       5
+#define DLOG_WIRE_ENTRY_MAX     (7 + 4 * DLOG_MAX_ARGS)
+
+#define DLOG_EVENT_ID_(name, level, fmt) DLOG_EV_##name,
+typedef enum {
+    DLOG_EVENTS(DLOG_EVENT_ID_)
+    DLOG_EV_COUNT,
+} dlog_event_t;
+
+typedef enum {
+    DLOG_LEVEL_E,
+    DLOG_LEVEL_W,
+    DLOG_LEVEL_I,
+} dlog_level_t;
+
+typedef struct {
+    uint32_t timestamp_us;      // wraps after ~71 minutes
+    uint16_t id;
+    uint8_t nargs;
+    uint32_t args[DLOG_MAX_ARGS];
+} dlog_entry_t;
+
+typedef struct {
+    atomic_uint_least32_t seq;
+    dlog_entry_t entry;
+} dlog_slot_t;
+
+typedef struct {
+    dlog_slot_t *slots;
+    uint32_t mask;              // slot count - 1
+    atomic_uint_least32_t head; // next slot to claim
+    uint32_t tail;              // consumer only
+    atomic_uint_least32_t dropped;
+} dlog_ring_t;
+
+// n must be a power of two
+void dlog_ring_init(dlog_ring_t *r, dlog_slot_t *slots, size_t n);
+
+// Producer side, any task or ISR. Returns false (and counts a drop) if full.
+bool dlog_ring_push(dlog_ring_t *r, uint32_t timestamp_us, uint16_t id, const uint32_t *args,
+                    uint8_t nargs);
+
+// Consumer side, one task. Returns false if nothing is published yet.
+bool dlog_ring_pop(dlog_ring_t *r, dlog_entry_t *out);
+
+// Entries claimed but not yet popped; approximate while producers run
+uint32_t dlog_ring_fill(dlog_ring_t *r);
+
+// Appends one entry to a wire payload being built in out[0..cap); the
+// header is written by dlog_encode_finish. Returns bytes written, 0 if full.
+size_t dlog_encode_entry(const dlog_entry_t *e, uint8_t *out, size_t cap);
+void dlog_encode_finish(uint8_t *out, uint32_t dropped, uint8_t n);
+
+// Walks a wire payload. Returns bytes consumed by the header (*n and
+// *dropped filled), 0 on a short buffer.
+size_t dlog_decode_header(const uint8_t *in, size_t len, uint32_t *dropped, uint8_t *n);
+// Returns bytes consumed by one entry, 0 on malformed input
+size_t dlog_decode_entry(const uint8_t *in, size_t len, dlog_entry_t *out);
+
+// Renders an entry with its format; unknown IDs print raw. Returns the
+// length snprintf would have produced.
+int dlog_format(const dlog_entry_t *e, char *buf, size_t cap);
+
+const char *dlog_event_name(uint16_t id);
+dlog_level_t dlog_event_level(uint16_t id);
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scan_record.h"
+
+/* ===================== FINGERPRINT POSITIONING =====================
+ * Matches a scan against a survey of known locations on the device, so
+ * only the best location IDs and their scores leave it instead of every
+ * record.
+ *
+ * The database is generated at build time by tools/fp_gen.py from a
+ * survey CSV and is const, so it stays in flash. A fixed dictionary of
+ * the surveyed BSSIDs gives each AP an index; a fingerprint is a sparse
+ * vector of quantised RSSI over that dictionary:
+ *
+ *   q = (rssi - floor_dbm + step_db / 2) / step_db, at least 1
+ *
+ * with 0 meaning "not heard". Distance is the squared Euclidean distance
+ * in q units over the union of APs, unheard counting as 0; BSSIDs missing
+ * from the dictionary are ignored. Expanded,
+ *
+ *   dist = |f|^2 + |s|^2 - 2 f.s
+ *
+ * and only APs both sides heard add to the dot product. So the entries
+ * are stored inverted, one posting list per AP, and a match reads just
+ * the lists of the APs the scan heard, a few percent of the table, into
+ * a per-fingerprint accumulator; one sequential sweep over that and the
+ * norms then gives every distance exactly. Layout, structure of arrays:
+ *
+ *   bssids   n_bssids x 6 bytes, sorted: the dictionary
+ *   post     n_bssids + 1 starts into the posting arrays
+ *   fp, q    per posting: fingerprint index (ascending within a list), q
+ *   loc      per fingerprint, location ID (a location has several samples)
+ *   norm2    per fingerprint, sum of q^2
+ */
+
+#define FP_MATCH_MAX            8       // top-K bound
+#define FP_QUERY_MAX            64      // scan records considered per query
+#define FP_DB_MAX_FPS           UINT16_MAX
+
+typedef struct {
+    uint16_t n_bssids;
+    uint16_t n_fps;
+    uint32_t n_postings;
+    int8_t floor_dbm;
+    uint8_t step_db;
+    const uint8_t *bssids;      // n_bssids x 6
+    const uint32_t *post;       // n_bssids + 1
+    const uint16_t *fp;
+    const uint8_t *q;
+    const uint16_t *loc;
+    const uint32_t *norm2;
+    uint32_t version;           // CRC-32 of the survey rows
+} fp_db_t;
+
+typedef struct {
+    uint16_t idx[FP_QUERY_MAX]; // dictionary APs heard
+    uint8_t q[FP_QUERY_MAX];
+    uint8_t n;
+    uint8_t unknown;            // records not in the dictionary
+    uint32_t norm2;
+} fp_query_t;
+
+typedef struct {
+    uint16_t loc;
+    uint32_t dist;              // squared distance in q units
+} fp_match_t;
+
+typedef struct {
+    uint32_t postings;          // posting entries read
+    uint32_t touched;           // fingerprints sharing an AP with the scan
+} fp_match_stats_t;
+
+// Generated table, present when CONFIG_SCANNER_FP_ENABLE is set
+extern const fp_db_t fp_db_builtin;
+
+// Shared with tools/fp_gen.py, which must quantise the same way
+static inline uint8_t fp_db_quantize(const fp_db_t *db, int rssi)
+{
+    int q = (rssi - db->floor_dbm + db->step_db / 2) / db->step_db;
+    return q < 1 ? 1 : q > 255 ? 255 : (uint8_t)q;
+}
+
+// Dictionary index, or -1
+int fp_db_find(const fp_db_t *db, const uint8_t bssid[6]);
+
+// Loads a scan into q; the strongest sighting of a BSSID counts. Returns
+// the APs matched.
+size_t fp_query_load(const fp_db_t *db, fp_query_t *q, const scan_record_t *recs, size_t n);
+
+// Best k (<= FP_MATCH_MAX) distinct locations, nearest first; ties go to
+// the lower fingerprint index. acc is caller scratch of n_fps words.
+// Returns the number written. stats is optional.
+size_t fp_db_match(const fp_db_t *db, const fp_query_t *q, uint32_t *acc, fp_match_t *out,
+                   size_t k, fp_match_stats_t *stats);
+
+// Flash taken by the tables, in bytes
+size_t fp_db_footprint(const fp_db_t *db);
+
+/* Wire form (stream frame payload):
+ *   version(u32) step_db(u8) heard(u8) unknown(u8) k(u8)
+ *   then k x { loc(u16) dist(u32) }, little-endian, nearest first
+ */
+#define FP_WIRE_HDR_LEN         8
+#define FP_WIRE_MATCH_LEN       6
+#define FP_WIRE_MAX_LEN         (FP_WIRE_HDR_LEN + FP_MATCH_MAX * FP_WIRE_MATCH_LEN)
+
+typedef struct {
+    uint32_t version;
+    uint8_t step_db;
+    uint8_t heard;
+    uint8_t unknown;
+    uint8_t k;
+    fp_match_t match[FP_MATCH_MAX];
+} fp_result_t;
+
+// Returns bytes written, or 0 if cap is too small
+size_t fp_result_encode(const fp_result_t *r, uint8_t *out, size_t cap);
+
+// Returns bytes consumed, or 0 on malformed input
+size_t fp_result_decode(const uint8_t *in, size_t len, fp_result_t *out);
+
+// One scan to its wire result: load, match, header. No match when the
+// scan shares no AP with the survey. Returns out->k.
+size_t fp_db_locate(const fp_db_t *db, const scan_record_t *recs, size_t n, uint32_t *acc,
+                    size_t k, fp_result_t *out);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== HYPERLOGLOG =====================
+ * Fixed-memory distinct counting. 256 registers of 4 bits (128 bytes per
+ * sketch), standard error about 1.04 / sqrt(256) = 6.5%. 4-bit registers
+ * cap the rank at 15, which is only reached far beyond the client counts a
+ * scanner will ever see.
+ */
+
+#define HLL_P           8
+#define HLL_REGISTERS   (1 << HLL_P)
+#define HLL_BYTES       (HLL_REGISTERS / 2)
+
+// A sliding window is this many sub-sketches, rotated every slot_us
+#define HLL_WINDOW_SLOTS 4
+
+typedef struct {
+    uint8_t reg[HLL_BYTES];
+} hll_t;
+
+typedef struct {
+    hll_t slots[HLL_WINDOW_SLOTS];
+    int64_t slot_us;
+    int64_t slot_start_us;
+    uint8_t head;
+} hll_window_t;
+
+void hll_clear(hll_t *hll);
+void hll_add(hll_t *hll, uint32_t hash);
+void hll_merge(hll_t *dst, const hll_t *src);
+uint32_t hll_estimate(const hll_t *hll);
+
+uint32_t hll_hash_bytes(const void *data, size_t len);
+
+// Window covers between (HLL_WINDOW_SLOTS - 1) and HLL_WINDOW_SLOTS slot_us
+// of history, depending on how far into the current slot we are
+void hll_window_init(hll_window_t *w, int64_t slot_us, int64_t now_us);
+void hll_window_add(hll_window_t *w, uint32_t hash, int64_t now_us);
+uint32_t hll_window_estimate(hll_window_t *w, int64_t now_us);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== 802.11 MANAGEMENT PARSER =====================
+ * Zero-copy: every pointer returned refers into the caller's frame buffer,
+ * which must stay valid while the parsed view is in use. No allocation,
+ * no platform dependencies, safe to call from the promiscuous callback.
+ */
+
+#define IEEE80211_MGMT_HDR_LEN      24
+#define IEEE80211_FCS_LEN           4
+
+#define IEEE80211_STYPE_PROBE_REQ   0x4
+#define IEEE80211_STYPE_PROBE_RESP  0x5
+#define IEEE80211_STYPE_BEACON      0x8
+
+#define IEEE80211_IE_SSID           0
+#define IEEE80211_IE_DS_PARAMS      3
+#define IEEE80211_IE_RSN            48
+#define IEEE80211_IE_VENDOR         221
+
+// Values match the first entries of wifi_auth_mode_t
+typedef enum {
+    IEEE80211_SEC_OPEN = 0,
+    IEEE80211_SEC_WEP = 1,
+    IEEE80211_SEC_WPA = 2,
+    IEEE80211_SEC_WPA2 = 3,
+    IEEE80211_SEC_WPA_WPA2 = 4,
+} ieee80211_sec_t;
+
+typedef struct {
+    uint8_t subtype;
+    const uint8_t *da;
+    const uint8_t *sa;
+    const uint8_t *bssid;
+    const uint8_t *body;        // after the 24-byte header
+    size_t body_len;            // FCS excluded when has_fcs was set
+} ieee80211_mgmt_t;
+
+typedef struct {
+    const uint8_t *ssid;        // not NUL terminated
+    uint8_t ssid_len;
+    uint8_t channel;            // from DS params, 0 if absent
+    uint16_t beacon_interval;
+    uint16_t capability;
+    ieee80211_sec_t security;
+} ieee80211_bss_info_t;
+
+typedef struct {
+    const uint8_t *pos;
+    const uint8_t *end;
+} ieee80211_ie_iter_t;
+
+// Returns false unless frame is a well-formed management frame
+bool ieee80211_parse_mgmt(const uint8_t *frame, size_t len, bool has_fcs, ieee80211_mgmt_t *mgmt);
+
+// For beacons and probe responses: fixed fields plus the IEs we care about
+bool ieee80211_parse_bss(const ieee80211_mgmt_t *mgmt, ieee80211_bss_info_t *info);
+
+// The AP's channel: DS params is authoritative, since adjacent-channel
+// leakage is common; the channel the radio was on only without it
+static inline uint8_t ieee80211_bss_channel(const ieee80211_bss_info_t *info, uint8_t hop_channel)
+{
+    return info->channel ? info->channel : hop_channel;
+}
+
+void ieee80211_ie_iter_init(ieee80211_ie_iter_t *it, const uint8_t *ies, size_t len);
+
+// Yields the next element; returns false at the end or on a truncated element
+bool ieee80211_ie_next(ieee80211_ie_iter_t *it, uint8_t *id, const uint8_t **data, uint8_t *len);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== BLE LINK TUNER =====================
+ * Picks the BLE connection interval from the notification backlog: a
+ * queue at or above high_water asks for the fast interval so the burst
+ * drains in a few events, an empty queue for idle_hold_ms relaxes to the
+ * idle interval to save power. Requests are rate limited because each
+ * parameter update takes several connection events to land.
+ *
+ * Also keeps the application throughput figures (payload bytes actually
+ * handed to the stack) for the stats log. Intervals are in 1.25 ms units.
+ */
+
+typedef struct {
+    uint16_t fast_itvl;
+    uint16_t idle_itvl;
+    uint16_t high_water;
+    uint32_t idle_hold_ms;
+    uint32_t min_request_gap_ms;
+} link_tuner_config_t;
+
+typedef struct {
+    uint64_t bytes;
+    uint32_t msgs;
+    uint32_t drops;             // dropped on a full queue or a dead link
+    uint32_t retries;           // stack out of buffers, sent again later
+    uint32_t itvl_requests;
+    uint16_t conn_itvl;         // as granted by the central
+    uint32_t bytes_per_s;       // over the last completed window
+} link_tuner_stats_t;
+
+typedef struct {
+    link_tuner_config_t cfg;
+    uint16_t requested_itvl;    // 0 until the first request
+    int64_t last_request_us;
+    int64_t last_busy_us;
+    int64_t window_start_us;
+    uint64_t window_bytes;
+    link_tuner_stats_t stats;
+} link_tuner_t;
+
+void link_tuner_init(link_tuner_t *tuner, const link_tuner_config_t *cfg, int64_t now_us);
+
+// New connection: forget the previous request, keep the counters
+void link_tuner_reset(link_tuner_t *tuner, uint16_t conn_itvl, int64_t now_us);
+
+// Returns the interval to request now, or 0 to leave the link alone
+uint16_t link_tuner_update(link_tuner_t *tuner, size_t queue_depth, int64_t now_us);
+
+void link_tuner_on_sent(link_tuner_t *tuner, size_t bytes);
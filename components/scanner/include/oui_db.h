@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== OUI VENDOR INDEX =====================
+ * Maps the OUI (first three octets) of a BSSID to a small vendor ID, so
+ * records carry two bytes instead of a vendor name. Clients resolve IDs
+ * with the vendor list the generator writes next to the table.
+ *
+ * The tables are generated at build time by tools/oui_gen.py from an IEEE
+ * MA-L registry CSV and are const, so on the device they stay in flash
+ * (memory-mapped rodata) and cost no RAM.
+ *
+ * Layout is a hash-and-displace perfect hash: the OUI hashes to a bucket,
+ * the bucket's displacement picks the slot, and the slot holds the OUI
+ * for verification plus its vendor ID. Every lookup is two hashes and
+ * two table reads, hit or miss.
+ *
+ *   slot: oui[3] (big endian) vendor(u16 LE); empty slots are ff ff ff
+ */
+
+#define OUI_DB_UNKNOWN      0           // vendor ID for unlisted OUIs
+#define OUI_DB_SLOT_LEN     5
+#define OUI_DB_EMPTY        0xFFFFFFu   // multicast, never a registered OUI
+
+typedef struct {
+    uint32_t seed;
+    uint32_t n_buckets;
+    uint32_t n_slots;
+    const uint16_t *disp;       // n_buckets displacements
+    const uint8_t *slots;       // n_slots x OUI_DB_SLOT_LEN
+    uint16_t n_vendors;         // IDs are 1..n_vendors
+    const uint32_t *name_off;   // per ID - 1 into names, NULL when built without names
+    const char *names;          // NUL separated
+    uint32_t version;           // CRC-32 of the source rows, to match client vendor lists
+} oui_db_t;
+
+// Generated table, present when CONFIG_SCANNER_OUI_ENABLE is set
+extern const oui_db_t oui_db_builtin;
+
+// Vendor ID for the BSSID's OUI. Locally administered and multicast
+// addresses (randomized BSSIDs, mesh) have no vendor and return OUI_DB_UNKNOWN.
+uint16_t oui_db_lookup(const oui_db_t *db, const uint8_t bssid[6]);
+
+// Vendor name, or NULL for unknown IDs and tables built without names
+const char *oui_db_vendor_name(const oui_db_t *db, uint16_t id);
+
+// Flash taken by the tables, in bytes
+size_t oui_db_footprint(const oui_db_t *db);
+
+// Shared with tools/oui_gen.py, which must produce the same slots
+static inline uint32_t oui_db_hash(uint32_t key, uint32_t seed)
+{
+    uint32_t h = key ^ seed;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// Maps a hash onto [0, n) with a multiply instead of a divide
+static inline uint32_t oui_db_reduce(uint32_t h, uint32_t n)
+{
+    return (uint32_t)(((uint64_t)h * n) >> 32);
+}
+
+static inline uint32_t oui_db_slot_seed(uint32_t seed, uint16_t disp)
+{
+    return seed + 0x9E3779B9u * ((uint32_t)disp + 1);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "stage_duty.h"
+
+/* ===================== POWER MANAGEMENT =====================
+ * Dynamic frequency scaling and automatic light sleep around the scan
+ * pipeline. Each stage holds a CPU_FREQ_MAX and a NO_LIGHT_SLEEP lock
+ * only while it runs; between cycles nothing is held, so the CPU drops to
+ * min_freq_mhz and the idle task can light-sleep until the next timer,
+ * interrupt or BLE connection event.
+ *
+ * Stage time is also accounted in a stage_duty_t and summarised every
+ * report_s seconds, which is where the duty cycle figures come from.
+ * Without CONFIG_PM_ENABLE only the accounting is active.
+ */
+
+typedef struct {
+    int max_freq_mhz;           // 0 leaves the PM configuration alone
+    int min_freq_mhz;
+    bool light_sleep;
+    uint32_t report_s;          // 0: no periodic summary
+
+    // Optional, esp_timer task context, after the summary is logged
+    void (*on_report)(const stage_duty_summary_t *s, void *arg);
+    void *arg;
+} power_mgr_config_t;
+
+esp_err_t power_mgr_init(const power_mgr_config_t *cfg);
+
+// Brackets one stage; nests, and may be called from several tasks
+void power_stage_begin(duty_stage_t stage);
+void power_stage_end(duty_stage_t stage);
+
+// One scan report done; the per-report figures divide by this
+void power_mgr_report_done(void);
+
+// Summary of the window since the last one; starts a new window
+void power_mgr_take(stage_duty_summary_t *out);
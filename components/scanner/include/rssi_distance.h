@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== RSSI DISTANCE =====================
+ * Log-distance path-loss estimate, d = 10^((tx - rssi) / (10 n)) metres,
+ * where tx is the RSSI at 1 m and n the path-loss exponent. All integer:
+ * the power of ten is rewritten as 2^y and evaluated with a 64-entry
+ * table and linear interpolation, so a sample costs one multiply and a
+ * table lookup instead of a soft-float pow(). Beyond the 1 cm output
+ * resolution the error is under 0.01%, far below the model's own
+ * uncertainty.
+ *
+ * Per-AP calibration is a small table keyed by BSSID; APs without an
+ * entry use the default model.
+ */
+
+#define RSSI_DISTANCE_MAX_CM    1000000     // clamp, 10 km
+#define RSSI_DISTANCE_N_MIN_Q8  256         // exponent range 1.0 - 8.0
+#define RSSI_DISTANCE_N_MAX_Q8  2048
+
+typedef struct {
+    int16_t tx_q4;              // RSSI at 1 m, 1/16 dBm
+    uint16_t n_q8;              // path-loss exponent, Q8
+    int32_t k_q24;              // log2(10) / (160 n), derived
+} rssi_distance_model_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    rssi_distance_model_t model;
+} rssi_distance_cal_entry_t;
+
+typedef struct {
+    rssi_distance_cal_entry_t *entries;
+    size_t count;
+    size_t cap;
+    rssi_distance_model_t dflt;
+} rssi_distance_cal_t;
+
+// n_q8 is clamped to the supported range
+void rssi_distance_model_init(rssi_distance_model_t *m, int16_t tx_q4, uint16_t n_q8);
+
+// rssi_q4 in 1/16 dBm, e.g. ap_entry_t.rssi_avg_q4. Returns centimetres, >= 1.
+uint32_t rssi_distance_cm(const rssi_distance_model_t *m, int16_t rssi_q4);
+
+// log2(x) in Q16, x > 0
+int32_t rssi_distance_log2_q16(uint32_t x);
+
+// Exponent (Q8) that puts rssi_q4 at dist_cm for a given tx; 0 if the
+// sample cannot determine it (dist_cm <= 100 or rssi above tx)
+uint16_t rssi_distance_fit_exponent(int16_t tx_q4, int16_t rssi_q4, uint32_t dist_cm);
+
+void rssi_distance_cal_init(rssi_distance_cal_t *cal, rssi_distance_cal_entry_t *storage,
+                            size_t cap, const rssi_distance_model_t *dflt);
+
+// Adds or replaces the model for one AP; false when the table is full
+bool rssi_distance_cal_set(rssi_distance_cal_t *cal, const uint8_t bssid[6], int16_t tx_q4,
+                           uint16_t n_q8);
+
+// Parses "aa:bb:cc:dd:ee:ff@<tx dBm>/<n x10>" items separated by commas or
+// spaces, e.g. "aa:bb:cc:dd:ee:ff@-45/30". Returns how many were added.
+size_t rssi_distance_cal_add_list(rssi_distance_cal_t *cal, const char *list);
+
+// Never NULL: falls back to the default model
+const rssi_distance_model_t *rssi_distance_cal_lookup(const rssi_distance_cal_t *cal,
+                                                      const uint8_t bssid[6]);
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "scan_record.h"
+
+/* ===================== SCAN CACHE =====================
+ * Last known AP list and per-channel occupancy, kept in RTC memory on
+ * every scan (survives resets and deep sleep) and mirrored to NVS at a
+ * limited rate (survives power loss without wearing the flash). Lets the
+ * firmware hand out a stale-but-useful snapshot right after boot and scan
+ * the busiest channels first.
+ */
+
+#define SCAN_CACHE_MAX_RECORDS  20
+#define SCAN_CACHE_CHANNELS     14
+
+typedef struct {
+    uint16_t count;
+    uint8_t channel_aps[SCAN_CACHE_CHANNELS + 1];   // index = channel
+    scan_record_t records[SCAN_CACHE_MAX_RECORDS];
+} scan_cache_t;
+
+// Loads RTC copy if valid, else the NVS copy. ESP_ERR_NOT_FOUND if neither.
+esp_err_t scan_cache_load(scan_cache_t *cache);
+
+// Stores a fresh scan; NVS is only written every nvs_period_s seconds
+void scan_cache_store(const scan_record_t *recs, size_t count, uint32_t nvs_period_s);
+
+// Fills order with occupied channels, busiest first; returns how many
+size_t scan_cache_busy_channels(const scan_cache_t *cache, uint8_t *order, size_t max);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scan_record.h"
+
+/* ===================== MULTI-SCAN FUSION =====================
+ * Merges several short active scans into one report. A weak or busy AP
+ * missed by one sub-scan is usually caught by another, so the union of
+ * N short scans finds at least what one long scan would, while the radio
+ * is released between them.
+ *
+ * Per BSSID the report gives the median RSSI over the sub-scans that saw
+ * it (robust to a single faded or boosted sample), the fraction of
+ * sub-scans that saw it, and how long ago it was last seen. The other
+ * record fields come from the latest sighting.
+ */
+
+#define SCAN_FUSION_MAX_SCANS   8
+
+typedef struct {
+    scan_record_t rec;                      // latest sighting
+    int8_t rssi[SCAN_FUSION_MAX_SCANS];     // one sample per sub-scan that saw it
+    uint8_t seen;
+    uint8_t last_scan;                      // index of the sub-scan that last saw it
+    int64_t last_seen_us;
+} scan_fusion_entry_t;
+
+typedef struct {
+    scan_fusion_entry_t *entries;
+    size_t count;
+    size_t cap;
+    uint8_t scans;              // sub-scans merged since the last reset
+    uint32_t dropped;           // sightings of new BSSIDs with the storage full
+} scan_fusion_t;
+
+typedef struct {
+    scan_record_t rec;          // rssi is the median
+    uint8_t seen;               // presence = seen / scans
+    uint8_t scans;
+    uint32_t age_ms;            // since the last sighting
+} scan_fusion_ap_t;
+
+void scan_fusion_init(scan_fusion_t *f, scan_fusion_entry_t *storage, size_t cap);
+
+// Starts a new report
+void scan_fusion_reset(scan_fusion_t *f);
+
+// Merges one sub-scan. Past SCAN_FUSION_MAX_SCANS sub-scans are ignored
+// until the next reset. A BSSID listed twice in one sub-scan counts once.
+void scan_fusion_add_scan(scan_fusion_t *f, const scan_record_t *recs, size_t n, int64_t now_us);
+
+// Fused APs, strongest median first. Returns how many were written.
+size_t scan_fusion_report(const scan_fusion_t *f, int64_t now_us, scan_fusion_ap_t *out,
+                          size_t cap);
+
+// Median of n samples; the mean of the middle two, rounded, when n is even
+int8_t scan_fusion_median(const int8_t *samples, uint8_t n);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "scan_fusion.h"
+
+// Largest sub-scan result kept; the driver drops the rest
+#define SCAN_FUSION_WIFI_MAX_APS    32
+
+typedef struct {
+    uint8_t scans;                  // sub-scans per report, 1..SCAN_FUSION_MAX_SCANS
+    uint16_t dwell_ms;              // active dwell per channel, per sub-scan
+    uint16_t gap_ms;                // radio released between sub-scans
+
+    // Optional, called for every record of every sub-scan as it arrives
+    void (*on_record)(const scan_record_t *rec, void *arg);
+    void *arg;
+} scan_fusion_wifi_config_t;
+
+// Runs cfg->scans blocking active scans of all channels into f (reset
+// first), sleeping gap_ms between them so BLE and other tasks get the
+// radio and CPU. Adds the time spent scanning to *radio_us if not NULL.
+// Fails only if no sub-scan completed.
+esp_err_t scan_fusion_wifi_run(scan_fusion_t *f, const scan_fusion_wifi_config_t *cfg,
+                               int64_t *radio_us);
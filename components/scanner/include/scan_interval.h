@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scan_record.h"
+
+/* ===================== ADAPTIVE SCAN INTERVAL =====================
+ * Picks the delay before the next scan from scan-to-scan churn: APs that
+ * appeared, disappeared or moved by at least rssi_delta_db. Any churn at
+ * or above the threshold snaps back to min_ms, a churn-free scan doubles
+ * the interval up to max_ms, anything in between holds it.
+ *
+ * The interval runs start to start. A scan cycle can outlast min_ms, so
+ * scan_interval_period stretches it to leave min_ms idle after the cycle.
+ */
+
+#define SCAN_INTERVAL_MAX_APS 64
+
+typedef struct {
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint8_t rssi_delta_db;
+    uint16_t churn_threshold_permille;
+} scan_interval_config_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    int8_t rssi;
+} scan_interval_ap_t;
+
+typedef struct {
+    scan_interval_config_t cfg;
+    uint32_t interval_ms;
+    uint16_t last_churn_permille;
+    scan_interval_ap_t prev[SCAN_INTERVAL_MAX_APS];     // sorted by BSSID
+    uint16_t prev_count;
+    uint32_t scans;
+    uint64_t elapsed_ms;        // sum of periods handed out
+} scan_interval_t;
+
+void scan_interval_init(scan_interval_t *ctl, const scan_interval_config_t *cfg);
+
+// Feed one completed scan, returns the delay before the next one
+uint32_t scan_interval_update(scan_interval_t *ctl, const scan_record_t *recs, size_t count);
+
+// Start-to-start period after the update: the interval, but at least
+// busy_ms (the cycle just run) plus min_ms
+uint32_t scan_interval_period(scan_interval_t *ctl, uint32_t busy_ms);
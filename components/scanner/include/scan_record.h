@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== SCAN RECORD =====================
+ * Platform-neutral view of one access point, shared by the firmware
+ * and the host tools.
+ *
+ * The wire schema is declared once in SCAN_RECORD_FIELDS; the encoder,
+ * decoder and length bounds are all expanded from it. A record carries
+ * the fields whose bit is set in a field mask, in table order, little
+ * endian. The mask travels once per container (stream batch, snapshot
+ * header), never per record. With the default mask the layout is
+ *   bssid[6] rssi(i8) channel(u8) authmode(u8) ssid_len(u8) ssid[ssid_len]
+ *
+ * The device encodes with the compile-time SCAN_RECORD_MASK, so disabled
+ * fields cost neither bytes nor cycles; decoders take the mask they were
+ * sent and accept any combination.
+ */
+
+#define SCAN_RECORD_SSID_MAX    32
+
+// X(NAME, bit, kind, member); BSSID is the key and always present.
+// Append new fields at the end: bit order is wire order.
+#define SCAN_RECORD_FIELDS(X)                   \
+    X(BSSID,    0, MAC, bssid)                  \
+    X(RSSI,     1, I8,  rssi)                   \
+    X(CHANNEL,  2, U8,  channel)                \
+    X(AUTHMODE, 3, U8,  authmode)               \
+    X(SSID,     4, STR, ssid)                   \
+    X(DISTANCE, 5, U32, distance_cm)            \
+    X(VENDOR,   6, U16, vendor_id)
+
+// Wire width of each kind; STR is a length byte plus up to SSID_MAX bytes
+#define SCAN_RECORD_KIND_MAX_MAC    6
+#define SCAN_RECORD_KIND_MAX_I8     1
+#define SCAN_RECORD_KIND_MAX_U8     1
+#define SCAN_RECORD_KIND_MAX_U16    2
+#define SCAN_RECORD_KIND_MAX_U32    4
+#define SCAN_RECORD_KIND_MAX_STR    (1 + SCAN_RECORD_SSID_MAX)
+
+#define SCAN_RECORD_FIELD_BIT_(name, bit, kind, member) SCAN_FIELD_##name = 1u << (bit),
+enum {
+    SCAN_RECORD_FIELDS(SCAN_RECORD_FIELD_BIT_)
+};
+
+#define SCAN_RECORD_ALL_(name, bit, kind, member) | (1u << (bit))
+#define SCAN_RECORD_MASK_ALL    (0 SCAN_RECORD_FIELDS(SCAN_RECORD_ALL_))
+#define SCAN_RECORD_MASK_DEFAULT \
+    (SCAN_FIELD_BSSID | SCAN_FIELD_RSSI | SCAN_FIELD_CHANNEL | SCAN_FIELD_AUTHMODE | SCAN_FIELD_SSID)
+
+// Set from the "Record fields" Kconfig menu in firmware builds, -D on the host
+#ifndef SCAN_RECORD_MASK
+#define SCAN_RECORD_MASK        SCAN_RECORD_MASK_DEFAULT
+#endif
+
+// What scan_record_encode actually writes, and what containers announce
+#define SCAN_RECORD_WIRE_MASK   ((uint8_t)(SCAN_RECORD_MASK | SCAN_FIELD_BSSID))
+
+// Longest record this build encodes, and longest any mask can produce
+#define SCAN_RECORD_MAX_(name, bit, kind, member) \
+    + ((SCAN_RECORD_MASK >> (bit)) & 1) * SCAN_RECORD_KIND_MAX_##kind
+#define SCAN_RECORD_MAX_ANY_(name, bit, kind, member) + SCAN_RECORD_KIND_MAX_##kind
+#define SCAN_RECORD_MAX_LEN     (0 SCAN_RECORD_FIELDS(SCAN_RECORD_MAX_))
+#define SCAN_RECORD_MAX_LEN_ANY (0 SCAN_RECORD_FIELDS(SCAN_RECORD_MAX_ANY_))
+
+typedef struct {
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t authmode;
+    uint8_t ssid_len;
+    char ssid[SCAN_RECORD_SSID_MAX + 1];
+    uint32_t distance_cm;       // 0 = no estimate
+    uint16_t vendor_id;         // oui_db.h, 0 = unknown
+} scan_record_t;
+
+// Encodes the SCAN_RECORD_MASK fields. Returns bytes written, or 0 if cap is too small.
+size_t scan_record_encode(const scan_record_t *rec, uint8_t *out, size_t cap);
+
+// Same with a runtime mask, for host tools; BSSID is always included
+size_t scan_record_encode_mask(const scan_record_t *rec, uint8_t mask, uint8_t *out, size_t cap);
+
+// Decodes one record sent with `mask`; absent fields read as zero / empty.
+// Returns bytes consumed, or 0 on truncated input.
+size_t scan_record_decode(const uint8_t *in, size_t len, uint8_t mask, scan_record_t *rec);
+
+// Length of the record at `in` without decoding it, 0 if truncated
+size_t scan_record_wire_len(const uint8_t *in, size_t len, uint8_t mask);
+
+// Inline so config parsers (watchlist, distance calibration) share it
+// without linking each other
+static inline int scan_record_hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Parses "aa:bb:cc:dd:ee:ff" (or '-' separated) into out, returns false
+// on malformed input
+static inline bool scan_record_parse_mac(const char *s, uint8_t out[6])
+{
+    for (int i = 0; i < 6; i++) {
+        int hi = scan_record_hex_nibble(s[0]);
+        int lo = scan_record_hex_nibble(s[1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i] = (uint8_t)((hi << 4) | lo);
+        s += 2;
+        if (i < 5) {
+            if (*s != ':' && *s != '-') {
+                return false;
+            }
+            s++;
+        }
+    }
+    return true;
+}
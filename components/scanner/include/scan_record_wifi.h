@@ -0,0 +1,9 @@
+#pragma once
+
+#include "esp_wifi.h"
+
+#include "scan_record.h"
+
+// Converts an esp_wifi scan result into the platform-neutral record,
+// setting every field
+void scan_record_from_wifi(const wifi_ap_record_t *ap, scan_record_t *rec);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "sched_job.h"
+
+/* ===================== SCAN SCHEDULER =====================
+ * Periodic jobs on absolute esp_timer deadlines instead of tick delays:
+ * microsecond resolution (a FreeRTOS tick is 10 ms) and no drift from the
+ * work done in each cycle. One one-shot timer is re-armed for the
+ * earliest pending deadline.
+ *
+ * Task jobs: the owning task loops on
+ *
+ *   do_cycle();
+ *   scan_sched_wait(job);
+ *
+ * and is released at each deadline. A cycle that runs past its deadline
+ * is a miss; the next one then starts at once and the job stays on its
+ * grid (sched_job.h). Callback jobs run in the esp_timer task and must be
+ * short.
+ *
+ * Every report_s seconds each job's runs, misses and wake-up lateness
+ * (average, p99, max) are logged.
+ */
+
+#define SCAN_SCHED_MAX_JOBS     8
+
+typedef struct scan_sched_job scan_sched_job_t;
+
+typedef struct {
+    uint32_t report_s;          // 0: no periodic report
+} scan_sched_config_t;
+
+esp_err_t scan_sched_init(const scan_sched_config_t *cfg);
+
+// First deadline one period from now. With fn NULL this is a task job for
+// scan_sched_wait; otherwise fn(arg) runs at each deadline in the
+// esp_timer task. NULL when out of slots or not initialised.
+scan_sched_job_t *scan_sched_add(const char *name, uint32_t period_us, void (*fn)(void *arg),
+                                 void *arg);
+
+// Takes effect from the deadline last served
+void scan_sched_set_period(scan_sched_job_t *job, uint32_t period_us);
+
+// Task jobs only: blocks until the next deadline. Returns the deadlines
+// missed since the previous wait, 0 when on time.
+uint32_t scan_sched_wait(scan_sched_job_t *job);
+
+// Summary of the window since the last one; starts a new window
+void scan_sched_take(scan_sched_job_t *job, sched_job_summary_t *out);
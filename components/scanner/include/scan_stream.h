@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/* ===================== BINARY STREAM OUTPUT =====================
+ * COBS/CRC framed output on a dedicated UART or the USB-Serial-JTAG port.
+ * Producers only copy into a ring buffer; a writer task owns the port, so
+ * a slow or disconnected host never stalls the scan path.
+ */
+
+typedef struct {
+    uint32_t frames_sent;
+    uint32_t frames_dropped;
+    uint32_t bytes_sent;
+} scan_stream_stats_t;
+
+esp_err_t scan_stream_init(void);
+
+// Never blocks, so it is safe from esp_timer callbacks. Returns
+// ESP_ERR_NO_MEM when the frame was dropped: the ring was full, or another
+// producer was encoding at the same moment.
+esp_err_t scan_stream_send(uint8_t type, uint8_t flags, const void *payload, size_t len);
+
+void scan_stream_get_stats(scan_stream_stats_t *stats);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+
+/* ===================== DEADLINE JOBS =====================
+ * Bookkeeping for one periodic job on absolute deadlines. Deadlines sit
+ * on a fixed grid (first + k x period), so neither the job's own run time
+ * nor wake-up latency accumulates into the cadence. A period change takes
+ * effect from the last deadline served.
+ *
+ * Each run records how late it started after its deadline (jitter).
+ * Deadlines that pass while the job is still busy with an earlier one are
+ * counted as misses and skipped, not made up in a burst: the late run
+ * goes at once and the next deadline is the first grid point after it.
+ *
+ * Portable: times in us on any monotonic clock.
+ */
+
+// Lateness histogram: bucket b counts < 16 us << 2b, the last one the rest
+#define SCHED_JITTER_BUCKETS    8
+
+typedef struct {
+    int64_t period_us;
+    int64_t deadline_us;        // next deadline
+    uint32_t runs;
+    uint32_t misses;
+
+    // Lateness of timely runs since the last sched_job_take
+    uint32_t late_n;
+    uint64_t late_sum_us;
+    uint32_t late_max_us;
+    uint32_t late_hist[SCHED_JITTER_BUCKETS];
+} sched_job_t;
+
+typedef struct {
+    uint32_t runs;              // since init
+    uint32_t misses;            // since init
+    uint32_t late_n;            // timely runs in the window
+    uint32_t late_avg_us;
+    uint32_t late_p99_us;       // bucket bound, capped at the max
+    uint32_t late_max_us;
+} sched_job_summary_t;
+
+// First deadline at first_us
+void sched_job_init(sched_job_t *j, int64_t period_us, int64_t first_us);
+
+// Moves the pending deadline to the last one served plus period_us
+void sched_job_set_period(sched_job_t *j, int64_t period_us);
+
+// Woken for the pending deadline at now_us: records the lateness and
+// advances. Returns deadlines skipped because the wake came a full period
+// or more late (usually 0).
+uint32_t sched_job_wake(sched_job_t *j, int64_t now_us);
+
+// The job came back for its deadline only after it had passed: a miss,
+// plus any further deadlines already gone. Runs now; returns the count.
+uint32_t sched_job_overdue(sched_job_t *j, int64_t now_us);
+
+// Summary of the window since the last take; starts the next window
+void sched_job_take(sched_job_t *j, sched_job_summary_t *out);
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== STAGE DUTY CYCLE =====================
+ * Active-time accounting for the stages of a scan report. Each stage is
+ * bracketed with begin/end; nested or concurrent brackets of one stage
+ * (two tasks transmitting) count once. Different stages may overlap, e.g.
+ * encoding while the radio is still up. Outside every stage the device
+ * is assumed idle: CPU at the minimum frequency or in light sleep.
+ *
+ * A summary covers the window since the previous one: per stage the
+ * permille of wall time spent in it and the time per scan report, plus
+ * the same for the union of all stages ("awake"). Energy per report is
+ * then roughly sum(stage current x stage time) + idle current x the rest.
+ *
+ * Wire form (stream frame payload):
+ *   window_ms(u32) reports(u16) n(u8)
+ *   then n x { permille(u16) us_per_report(u32) }, little-endian,
+ *   in stage order with the awake union last
+ */
+
+typedef enum {
+    DUTY_STAGE_SCAN,            // radio on, scanning
+    DUTY_STAGE_ENCODE,          // tables, snapshot, frame encoding
+    DUTY_STAGE_TX,              // pushing bytes to UART, USB or BLE
+    DUTY_STAGE_COUNT,
+} duty_stage_t;
+
+#define DUTY_AWAKE              DUTY_STAGE_COUNT    // summary index of the union
+#define STAGE_DUTY_ENTRY_LEN    6
+#define STAGE_DUTY_WIRE_LEN     (7 + (DUTY_STAGE_COUNT + 1) * STAGE_DUTY_ENTRY_LEN)
+
+typedef struct {
+    uint8_t depth[DUTY_STAGE_COUNT];
+    int64_t since_us[DUTY_STAGE_COUNT];
+    uint64_t active_us[DUTY_STAGE_COUNT + 1];
+    uint8_t awake_depth;
+    int64_t awake_since_us;
+    int64_t window_start_us;
+    uint32_t reports;
+} stage_duty_t;
+
+typedef struct {
+    uint32_t window_ms;
+    uint32_t reports;
+    uint16_t permille[DUTY_STAGE_COUNT + 1];
+    uint32_t us_per_report[DUTY_STAGE_COUNT + 1];   // 0 with no reports in the window
+} stage_duty_summary_t;
+
+void stage_duty_init(stage_duty_t *d, int64_t now_us);
+
+void stage_duty_begin(stage_duty_t *d, duty_stage_t stage, int64_t now_us);
+void stage_duty_end(stage_duty_t *d, duty_stage_t stage, int64_t now_us);
+
+// One scan report finished; the per-report figures divide by this
+void stage_duty_report(stage_duty_t *d);
+
+// Summarises the window up to now and starts the next one. Stages still
+// open are split at now.
+void stage_duty_take(stage_duty_t *d, int64_t now_us, stage_duty_summary_t *out);
+
+const char *stage_duty_name(int stage);
+
+// Returns bytes written, or 0 if cap is too small
+size_t stage_duty_encode(const stage_duty_summary_t *s, uint8_t *out, size_t cap);
+
+// Returns bytes consumed, or 0 on malformed input; stages beyond n read as 0
+size_t stage_duty_decode(const uint8_t *in, size_t len, stage_duty_summary_t *out);
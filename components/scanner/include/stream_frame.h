@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cobs.h"
+
+/* ===================== STREAM FRAMES =====================
+ * Raw frame: type(u8) flags(u8) seq(u16) timestamp_us(u64) payload crc32
+ * The raw frame is COBS encoded and terminated with a single 0x00.
+ */
+
+#define STREAM_FRAME_HDR_LEN        12
+#define STREAM_FRAME_CRC_LEN        4
+#define STREAM_FRAME_MAX_PAYLOAD    1024
+#define STREAM_FRAME_MAX_RAW        (STREAM_FRAME_HDR_LEN + STREAM_FRAME_MAX_PAYLOAD + STREAM_FRAME_CRC_LEN)
+#define STREAM_FRAME_MAX_WIRE       (COBS_MAX_ENCODED_LEN(STREAM_FRAME_MAX_RAW) + 1)
+
+typedef enum {
+    STREAM_FRAME_AP_BATCH = 0x01,   // u8 count, u8 field mask, then count scan records
+    STREAM_FRAME_CHANNEL_HIST = 0x02,   // per-channel congestion, see channel_stats.h
+    STREAM_FRAME_DUTY = 0x03,           // per-stage duty cycle, see stage_duty.h
+    STREAM_FRAME_LOG = 0x04,            // deferred log entries, see dlog_ring.h
+    STREAM_FRAME_LOCATION = 0x05,       // top-K fingerprint matches, see fp_db.h
+} stream_frame_type_t;
+
+// Header flags
+#define STREAM_FLAG_STALE           0x01    // replayed from the boot cache, not a live scan
+#define STREAM_FLAG_SYNTHETIC       0x02    // generated load, see synth_load.h
+
+typedef enum {
+    STREAM_FRAME_OK = 0,
+    STREAM_FRAME_ERR_COBS = -1,
+    STREAM_FRAME_ERR_SHORT = -2,
+    STREAM_FRAME_ERR_CRC = -3,
+    STREAM_FRAME_ERR_SIZE = -4,
+} stream_frame_err_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t flags;
+    uint16_t seq;
+    uint64_t timestamp_us;
+} stream_frame_hdr_t;
+
+// Builds a complete wire frame including the trailing delimiter.
+// Returns bytes written, or 0 if the payload or buffer is too large/small.
+size_t stream_frame_encode(const stream_frame_hdr_t *hdr, const uint8_t *payload, size_t len,
+                           uint8_t *out, size_t cap);
+
+// Decodes one wire frame with the delimiter already stripped
+int stream_frame_decode(const uint8_t *wire, size_t len, stream_frame_hdr_t *hdr,
+                        uint8_t *payload, size_t cap, size_t *payload_len);
+
+/* ===================== DEFRAMER ===================== */
+typedef struct {
+    uint8_t buf[STREAM_FRAME_MAX_WIRE];
+    size_t len;
+    uint32_t overflows;
+} stream_deframer_t;
+
+// Feeds one byte; returns the wire length when a frame completes, else 0.
+// The completed frame is in d->buf until the next push.
+size_t stream_deframer_push(stream_deframer_t *d, uint8_t byte);
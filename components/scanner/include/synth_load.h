@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scan_record.h"
+
+/* ===================== SYNTHETIC LOAD =====================
+ * Deterministic fake scan records at a fixed rate, for benchmarking the
+ * encode/batch/transmit path independently of the radio environment.
+ *
+ * Every record carries its own sequence number so a receiver can count
+ * loss per record, not just per frame:
+ *   bssid   02:5a:<seq, big endian u32>
+ *   ssid    "SYN <seq %08X> <gen time ms %08X>"
+ * The generation time in the SSID also gives text-only transports (BLE
+ * notifications) a latency reference.
+ */
+
+#define SYNTH_LOAD_OUI0         0x02    // locally administered
+#define SYNTH_LOAD_OUI1         0x5A
+
+typedef struct {
+    uint32_t rate;              // records per second
+    uint16_t batch;             // records per frame
+    uint32_t count;             // records in total, 0 = endless
+} synth_load_config_t;
+
+typedef struct {
+    synth_load_config_t cfg;
+    int64_t start_us;
+    uint32_t next_seq;
+} synth_load_t;
+
+void synth_load_init(synth_load_t *gen, const synth_load_config_t *cfg, int64_t now_us);
+
+// Time the next batch is due; batches are scheduled from the start time so
+// a late one does not push the rest back
+int64_t synth_load_due_us(const synth_load_t *gen);
+
+bool synth_load_done(const synth_load_t *gen);
+
+// Fills the next batch (up to cfg.batch records) and returns its size
+size_t synth_load_next(synth_load_t *gen, scan_record_t *recs, int64_t now_us);
+
+// Receiver side: extracts the sequence number, false if not synthetic
+bool synth_load_parse(const scan_record_t *rec, uint32_t *seq);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scan_record.h"
+#include "watchlist.h"
+
+/* ===================== WATCHLIST ALERTS =====================
+ * Appear/disappear edge detection for the BSSIDs on a watchlist. Every
+ * sighting is checked as it arrives (scan result or beacon); an absent
+ * entry raises APPEAR on the first one, a present entry raises DISAPPEAR
+ * once it has gone unheard for absent_ms. Per-entry state is indexed
+ * like the watchlist, so edit the list through watch_alert_add/clear.
+ * Not thread-safe: callers serialize.
+ *
+ * Wire form (GATT notification), WATCH_ALERT_WIRE_LEN bytes:
+ *   kind(u8) bssid[6] rssi(i8) channel(u8)
+ */
+
+#define WATCH_ALERT_WIRE_LEN    9
+
+typedef enum {
+    WATCH_ALERT_APPEAR = 1,
+    WATCH_ALERT_DISAPPEAR = 2,
+} watch_alert_kind_t;
+
+typedef struct {
+    uint8_t kind;               // watch_alert_kind_t
+    uint8_t bssid[6];
+    int8_t rssi;                // last heard
+    uint8_t channel;
+} watch_alert_event_t;
+
+typedef struct {
+    uint32_t last_seen_ms;
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t present;
+} watch_alert_slot_t;
+
+typedef struct {
+    watchlist_t *wl;
+    watch_alert_slot_t *slots;  // one per watchlist capacity entry
+    uint32_t absent_ms;
+    size_t present;             // entries currently present
+    uint32_t checks;
+    uint32_t hits;
+} watch_alert_t;
+
+// slots holds wl->cap entries; wl may already have entries, all start absent
+void watch_alert_init(watch_alert_t *wa, watchlist_t *wl, watch_alert_slot_t *slots,
+                      uint32_t absent_ms);
+
+// Adds to the watchlist, keeping the state of existing entries; false when full
+bool watch_alert_add(watch_alert_t *wa, const uint8_t bssid[6]);
+
+// Empties the watchlist, without raising DISAPPEAR
+void watch_alert_clear(watch_alert_t *wa);
+
+// Changes the time unheard before DISAPPEAR, e.g. when the scan interval
+// does; present entries keep their last sighting
+void watch_alert_set_absent_ms(watch_alert_t *wa, uint32_t absent_ms);
+
+// Returns true and fills ev when this sighting is an appearance
+bool watch_alert_check(watch_alert_t *wa, const scan_record_t *rec, uint32_t now_ms,
+                       watch_alert_event_t *ev);
+
+// Writes up to max disappearances to evs and returns how many. Entries
+// past max stay present and are reported on the next call.
+size_t watch_alert_expire(watch_alert_t *wa, uint32_t now_ms, watch_alert_event_t *evs, size_t max);
+
+// Returns WATCH_ALERT_WIRE_LEN, or 0 if cap is too small
+size_t watch_alert_encode(const watch_alert_event_t *ev, uint8_t *out, size_t cap);
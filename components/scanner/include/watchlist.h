@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================== BSSID WATCHLIST =====================
+ * Sorted array of BSSIDs over caller-provided storage, so the same code
+ * serves a handful of tracked APs or a large list loaded at runtime.
+ *
+ * Large lists can attach a Bloom filter: nearly every BSSID heard is not
+ * on the list, and the filter rejects those in three bit tests instead
+ * of a binary search over thousands of entries.
+ */
+
+typedef struct {
+    uint8_t (*entries)[6];
+    size_t count;
+    size_t cap;
+    uint8_t *bloom;             // optional, NULL without a filter
+    uint32_t bloom_mask;        // filter size in bits - 1
+} watchlist_t;
+
+void watchlist_init(watchlist_t *wl, uint8_t (*storage)[6], size_t cap);
+
+// bytes must be a power of two; ~2 bytes per entry keeps false hits under 1%.
+// Existing entries are hashed in.
+void watchlist_attach_bloom(watchlist_t *wl, uint8_t *bits, size_t bytes);
+
+void watchlist_clear(watchlist_t *wl);
+
+// Adds BSSIDs from a comma/space separated list, returns how many were added
+size_t watchlist_add_list(watchlist_t *wl, const char *list);
+
+bool watchlist_add(watchlist_t *wl, const uint8_t bssid[6]);
+
+// Bloom test only: false means definitely absent. Always true without a filter.
+bool watchlist_may_contain(const watchlist_t *wl, const uint8_t bssid[6]);
+
+// Returns the entry index, or -1 when absent
+int watchlist_find(const watchlist_t *wl, const uint8_t bssid[6]);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+
+#include "ap_table.h"
+#include "ieee80211_parse.h"
+
+/* ===================== PASSIVE CAPTURE =====================
+ * Promiscuous-mode beacon/probe-response capture with channel hopping.
+ * Frames are parsed in the Wi-Fi callback and written straight into the
+ * AP table, giving per-AP RSSI at beacon rate on the current channel.
+ * Wi-Fi must already be initialized and started in STA mode.
+ */
+
+typedef struct {
+    ap_table_t *table;
+    SemaphoreHandle_t table_lock;   // never waited on from the callback
+    uint16_t dwell_ms;              // time per channel
+    uint16_t channel_mask;          // bit n enables channel n (1..13)
+
+    // Optional, runs in the Wi-Fi task for every probe request heard
+    void (*probe_req_cb)(const ieee80211_mgmt_t *mgmt, int8_t rssi, void *arg);
+    void *probe_req_arg;
+
+    // Optional, runs in the Wi-Fi task for every beacon / probe response,
+    // before and regardless of the table update
+    void (*bss_cb)(const scan_record_t *rec, void *arg);
+    void *bss_arg;
+} wifi_capture_config_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t beacons;
+    uint32_t probe_resps;
+    uint32_t probe_reqs;
+    uint32_t malformed;
+    uint32_t lock_misses;           // samples dropped because the table was busy
+    uint32_t hops;
+} wifi_capture_stats_t;
+
+esp_err_t wifi_capture_start(const wifi_capture_config_t *cfg);
+esp_err_t wifi_capture_stop(void);
+void wifi_capture_get_stats(wifi_capture_stats_t *stats);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+
+#include "ap_table.h"
+#include "watchlist.h"
+
+/* ===================== TARGETED TRACKING =====================
+ * Follows a watchlist of BSSIDs with short single-channel scans on just
+ * the channels they live on, so each target updates several times a
+ * second. A full sweep at a low rate, or after a target goes quiet on its
+ * channel, relocates APs that moved.
+ */
+
+typedef struct {
+    const watchlist_t *watchlist;
+    ap_table_t *table;
+    SemaphoreHandle_t table_lock;
+    uint16_t dwell_ms;              // active dwell per targeted scan
+    uint16_t rate_hz;               // targeted rounds per second
+    uint32_t sweep_period_ms;       // background full sweep
+
+    // Called from the tracker task for every watchlist hit
+    void (*on_update)(const scan_record_t *rec, void *arg);
+    void *arg;
+
+    // Optional, called from the tracker task for every record, target or not
+    void (*on_record)(const scan_record_t *rec, void *arg);
+} wifi_tracker_config_t;
+
+typedef struct {
+    uint32_t rounds;
+    uint32_t targeted_scans;
+    uint32_t sweeps;
+    uint32_t hits;
+    uint32_t overruns;              // rounds that took longer than 1/rate_hz
+} wifi_tracker_stats_t;
+
+// Wi-Fi must already be started in STA mode and scan_sched initialised.
+// Spawns the tracker task.
+esp_err_t wifi_tracker_start(const wifi_tracker_config_t *cfg);
+void wifi_tracker_get_stats(wifi_tracker_stats_t *stats);
@@ -0,0 +1,65 @@
+#include <string.h>
+
+#include "link_tuner.h"
+
+// Throughput is averaged over windows of this length
+#define THROUGHPUT_WINDOW_US 1000000LL
+
+void link_tuner_init(link_tuner_t *tuner, const link_tuner_config_t *cfg, int64_t now_us)
+{
+    memset(tuner, 0, sizeof(*tuner));
+    tuner->cfg = *cfg;
+    tuner->window_start_us = now_us;
+    tuner->last_busy_us = now_us;
+}
+
+void link_tuner_reset(link_tuner_t *tuner, uint16_t conn_itvl, int64_t now_us)
+{
+    tuner->requested_itvl = 0;
+    tuner->last_request_us = now_us - tuner->cfg.min_request_gap_ms * 1000LL;
+    tuner->last_busy_us = now_us;
+    tuner->stats.conn_itvl = conn_itvl;
+}
+
+uint16_t link_tuner_update(link_tuner_t *tuner, size_t queue_depth, int64_t now_us)
+{
+    // Roll the throughput window even when nothing is sent
+    if (now_us - tuner->window_start_us >= THROUGHPUT_WINDOW_US) {
+        tuner->stats.bytes_per_s = (uint32_t)(tuner->window_bytes * 1000000LL /
+                                              (now_us - tuner->window_start_us));
+        tuner->window_bytes = 0;
+        tuner->window_start_us = now_us;
+    }
+
+    if (queue_depth > 0) {
+        tuner->last_busy_us = now_us;
+    }
+
+    uint16_t want;
+    if (queue_depth >= tuner->cfg.high_water) {
+        want = tuner->cfg.fast_itvl;
+    } else if (now_us - tuner->last_busy_us >= tuner->cfg.idle_hold_ms * 1000LL) {
+        want = tuner->cfg.idle_itvl;
+    } else {
+        // In between: keep whatever was asked for last
+        return 0;
+    }
+
+    if (want == tuner->requested_itvl ||
+        now_us - tuner->last_request_us < tuner->cfg.min_request_gap_ms * 1000LL) {
+        return 0;
+    }
+
+    tuner->requested_itvl = want;
+    tuner->last_request_us = now_us;
+    tuner->stats.itvl_requests++;
+
+    return want;
+}
+
+void link_tuner_on_sent(link_tuner_t *tuner, size_t bytes)
+{
+    tuner->stats.bytes += bytes;
+    tuner->stats.msgs++;
+    tuner->window_bytes += bytes;
+}
@@ -0,0 +1,44 @@
+#include "oui_db.h"
+
+uint16_t oui_db_lookup(const oui_db_t *db, const uint8_t bssid[6])
+{
+    // I/G and U/L bits: no registry entry can match
+    if ((bssid[0] & 0x03) || db->n_slots == 0) {
+        return OUI_DB_UNKNOWN;
+    }
+
+    uint32_t key = ((uint32_t)bssid[0] << 16) | ((uint32_t)bssid[1] << 8) | bssid[2];
+    uint32_t b = oui_db_reduce(oui_db_hash(key, db->seed), db->n_buckets);
+    uint32_t s = oui_db_reduce(oui_db_hash(key, oui_db_slot_seed(db->seed, db->disp[b])),
+                               db->n_slots);
+
+    const uint8_t *slot = db->slots + (size_t)s * OUI_DB_SLOT_LEN;
+    if (slot[0] != bssid[0] || slot[1] != bssid[1] || slot[2] != bssid[2]) {
+        return OUI_DB_UNKNOWN;
+    }
+    return slot[3] | (slot[4] << 8);
+}
+
+const char *oui_db_vendor_name(const oui_db_t *db, uint16_t id)
+{
+    if (id == OUI_DB_UNKNOWN || id > db->n_vendors || !db->name_off) {
+        return NULL;
+    }
+    return db->names + db->name_off[id - 1];
+}
+
+size_t oui_db_footprint(const oui_db_t *db)
+{
+    size_t bytes = sizeof(*db) + db->n_buckets * sizeof(uint16_t) +
+                   (size_t)db->n_slots * OUI_DB_SLOT_LEN;
+
+    if (db->name_off && db->n_vendors > 0) {
+        bytes += db->n_vendors * sizeof(uint32_t);
+        // Names are stored back to back; the last one ends the blob
+        const char *last = db->names + db->name_off[db->n_vendors - 1];
+        while (*last++) {
+        }
+        bytes += (size_t)(last - db->names);
+    }
+    return bytes;
+}
@@ -0,0 +1,126 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+
+#include "power_mgr.h"
+
+static const char *TAG = "POWER_MGR";
+
+static portMUX_TYPE duty_mux = portMUX_INITIALIZER_UNLOCKED;
+static stage_duty_t duty;
+static esp_pm_lock_handle_t freq_locks[DUTY_STAGE_COUNT];
+static esp_pm_lock_handle_t sleep_locks[DUTY_STAGE_COUNT];
+static esp_timer_handle_t report_timer = NULL;
+static power_mgr_config_t config;
+
+static void report_tick(void *arg)
+{
+    stage_duty_summary_t s;
+    power_mgr_take(&s);
+
+    ESP_LOGI(TAG, "Duty over %lu s, %lu reports: scan %u.%u%%, encode %u.%u%%, tx %u.%u%%, "
+             "awake %u.%u%%",
+             (unsigned long)(s.window_ms / 1000), (unsigned long)s.reports,
+             s.permille[DUTY_STAGE_SCAN] / 10, s.permille[DUTY_STAGE_SCAN] % 10,
+             s.permille[DUTY_STAGE_ENCODE] / 10, s.permille[DUTY_STAGE_ENCODE] % 10,
+             s.permille[DUTY_STAGE_TX] / 10, s.permille[DUTY_STAGE_TX] % 10,
+             s.permille[DUTY_AWAKE] / 10, s.permille[DUTY_AWAKE] % 10);
+    if (s.reports > 0) {
+        ESP_LOGI(TAG, "Per report: scan %lu ms, encode %lu ms, tx %lu ms, awake %lu ms",
+                 (unsigned long)(s.us_per_report[DUTY_STAGE_SCAN] / 1000),
+                 (unsigned long)(s.us_per_report[DUTY_STAGE_ENCODE] / 1000),
+                 (unsigned long)(s.us_per_report[DUTY_STAGE_TX] / 1000),
+                 (unsigned long)(s.us_per_report[DUTY_AWAKE] / 1000));
+    }
+
+    if (config.on_report) {
+        config.on_report(&s, config.arg);
+    }
+}
+
+esp_err_t power_mgr_init(const power_mgr_config_t *cfg)
+{
+    config = *cfg;
+    stage_duty_init(&duty, esp_timer_get_time());
+
+    if (cfg->max_freq_mhz > 0) {
+        const esp_pm_config_t pm = {
+            .max_freq_mhz = cfg->max_freq_mhz,
+            .min_freq_mhz = cfg->min_freq_mhz,
+            .light_sleep_enable = cfg->light_sleep,
+        };
+        esp_err_t ret = esp_pm_configure(&pm);
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "CPU %d-%d MHz, light sleep %s", cfg->min_freq_mhz, cfg->max_freq_mhz,
+                     cfg->light_sleep ? "on" : "off");
+        } else {
+            // Keep going at the fixed frequency; the accounting still works
+            ESP_LOGW(TAG, "PM configure failed: %s", esp_err_to_name(ret));
+        }
+    }
+
+    for (int s = 0; s < DUTY_STAGE_COUNT; s++) {
+        const char *name = stage_duty_name(s);
+        // Fails with ESP_ERR_NOT_SUPPORTED without CONFIG_PM_ENABLE; the
+        // stage brackets then only account
+        if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, name, &freq_locks[s]) != ESP_OK ||
+            esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, name, &sleep_locks[s]) != ESP_OK) {
+            freq_locks[s] = NULL;
+            sleep_locks[s] = NULL;
+        }
+    }
+
+    if (cfg->report_s > 0) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = report_tick,
+            .name = "duty",
+        };
+        esp_err_t ret = esp_timer_create(&timer_args, &report_timer);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        return esp_timer_start_periodic(report_timer, cfg->report_s * 1000000ULL);
+    }
+
+    return ESP_OK;
+}
+
+void power_stage_begin(duty_stage_t stage)
+{
+    // Up to speed before the work starts, so it is timed at full clock
+    if (freq_locks[stage]) {
+        esp_pm_lock_acquire(freq_locks[stage]);
+        esp_pm_lock_acquire(sleep_locks[stage]);
+    }
+
+    portENTER_CRITICAL(&duty_mux);
+    stage_duty_begin(&duty, stage, esp_timer_get_time());
+    portEXIT_CRITICAL(&duty_mux);
+}
+
+void power_stage_end(duty_stage_t stage)
+{
+    portENTER_CRITICAL(&duty_mux);
+    stage_duty_end(&duty, stage, esp_timer_get_time());
+    portEXIT_CRITICAL(&duty_mux);
+
+    if (freq_locks[stage]) {
+        esp_pm_lock_release(sleep_locks[stage]);
+        esp_pm_lock_release(freq_locks[stage]);
+    }
+}
+
+void power_mgr_report_done(void)
+{
+    portENTER_CRITICAL(&duty_mux);
+    stage_duty_report(&duty);
+    portEXIT_CRITICAL(&duty_mux);
+}
+
+void power_mgr_take(stage_duty_summary_t *out)
+{
+    portENTER_CRITICAL(&duty_mux);
+    stage_duty_take(&duty, esp_timer_get_time(), out);
+    portEXIT_CRITICAL(&duty_mux);
+}
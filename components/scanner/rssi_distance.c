@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "rssi_distance.h"
+#include "scan_record.h"
+
+#define LOG2_10_Q24     55732705
+#define LOG2_10_Q16     217706
+#define LOG2_100_Q16    435412
+
+// 2^(i/64) and log2(1 + i/64), both Q16
+static const uint32_t exp2_q16[65] = {
+    65536, 66250, 66971, 67700, 68438, 69183, 69936, 70698, 71468, 72246, 73032, 73828, 74632,
+    75444, 76266, 77096, 77936, 78785, 79642, 80510, 81386, 82273, 83169, 84074, 84990, 85915,
+    86851, 87796, 88752, 89719, 90696, 91684, 92682, 93691, 94711, 95743, 96785, 97839, 98905,
+    99982, 101070, 102171, 103283, 104408, 105545, 106694, 107856, 109031, 110218, 111418,
+    112631, 113858, 115098, 116351, 117618, 118899, 120194, 121502, 122825, 124163, 125515,
+    126882, 128263, 129660, 131072,
+};
+static const uint32_t log2_q16[65] = {
+    0, 1466, 2909, 4331, 5732, 7112, 8473, 9814, 11136, 12440, 13727, 14996, 16248, 17484,
+    18704, 19909, 21098, 22272, 23433, 24579, 25711, 26830, 27936, 29029, 30109, 31178, 32234,
+    33279, 34312, 35334, 36346, 37346, 38336, 39316, 40286, 41246, 42196, 43137, 44068, 44990,
+    45904, 46809, 47705, 48593, 49472, 50344, 51207, 52063, 52911, 53751, 54584, 55410, 56229,
+    57040, 57845, 58643, 59434, 60219, 60997, 61769, 62534, 63294, 64047, 64794, 65536,
+};
+
+// Delta clamp keeps delta * k_q24 inside int32 for every allowed exponent
+#define DELTA_MAX_Q4    2047
+
+void rssi_distance_model_init(rssi_distance_model_t *m, int16_t tx_q4, uint16_t n_q8)
+{
+    if (n_q8 < RSSI_DISTANCE_N_MIN_Q8) {
+        n_q8 = RSSI_DISTANCE_N_MIN_Q8;
+    } else if (n_q8 > RSSI_DISTANCE_N_MAX_Q8) {
+        n_q8 = RSSI_DISTANCE_N_MAX_Q8;
+    }
+
+    m->tx_q4 = tx_q4;
+    m->n_q8 = n_q8;
+    // The only division, once per model: log2(10) / (160 n) in Q24
+    m->k_q24 = (int32_t)(((uint64_t)LOG2_10_Q24 * 256 + 80 * n_q8) / (160 * (uint32_t)n_q8));
+}
+
+uint32_t rssi_distance_cm(const rssi_distance_model_t *m, int16_t rssi_q4)
+{
+    int32_t delta = m->tx_q4 - rssi_q4;
+    if (delta > DELTA_MAX_Q4) {
+        delta = DELTA_MAX_Q4;
+    } else if (delta < -DELTA_MAX_Q4) {
+        delta = -DELTA_MAX_Q4;
+    }
+
+    // d = 2^y metres, y in Q16; floor division keeps the fraction positive
+    int32_t y = (delta * m->k_q24) >> 8;
+    int32_t k = y >> 16;
+    uint32_t f = (uint32_t)y & 0xFFFF;
+
+    if (k >= 14) {
+        return RSSI_DISTANCE_MAX_CM;
+    }
+    if (k < -7) {
+        return 1;
+    }
+
+    uint32_t i = f >> 10;
+    uint32_t frac = f & 0x3FF;
+    uint32_t mant = exp2_q16[i] + (((exp2_q16[i + 1] - exp2_q16[i]) * frac + 512) >> 10);
+
+    // 100 * mant fits 24 bits; scale by 2^k / 2^16 with rounding
+    uint32_t cm = 100 * mant;
+    int shift = 16 - k;
+    cm = (cm + (1u << (shift - 1))) >> shift;
+
+    if (cm > RSSI_DISTANCE_MAX_CM) {
+        return RSSI_DISTANCE_MAX_CM;
+    }
+    return cm ? cm : 1;
+}
+
+int32_t rssi_distance_log2_q16(uint32_t x)
+{
+    int k = 31;
+    while (k > 0 && !(x & (1u << k))) {
+        k--;
+    }
+
+    // Normalize to 1.xxx with 16 fraction bits
+    uint32_t m = k >= 16 ? x >> (k - 16) : x << (16 - k);
+    uint32_t f = m & 0xFFFF;
+    uint32_t i = f >> 10;
+    uint32_t frac = f & 0x3FF;
+
+    return (k << 16) + (int32_t)(log2_q16[i] + (((log2_q16[i + 1] - log2_q16[i]) * frac + 512) >> 10));
+}
+
+uint16_t rssi_distance_fit_exponent(int16_t tx_q4, int16_t rssi_q4, uint32_t dist_cm)
+{
+    int32_t delta = tx_q4 - rssi_q4;
+    if (dist_cm <= 100 || delta <= 0) {
+        return 0;
+    }
+
+    // n = delta_db * log2(10) / (10 * log2(d_m)); delta_q4 * 16 is delta_db in Q8
+    int64_t l = rssi_distance_log2_q16(dist_cm) - LOG2_100_Q16;
+    if (l <= 0) {
+        return 0;
+    }
+    int64_t n = ((int64_t)delta * 16 * LOG2_10_Q16 + 5 * l) / (10 * l);
+
+    if (n < RSSI_DISTANCE_N_MIN_Q8) {
+        return RSSI_DISTANCE_N_MIN_Q8;
+    }
+    if (n > RSSI_DISTANCE_N_MAX_Q8) {
+        return RSSI_DISTANCE_N_MAX_Q8;
+    }
+    return (uint16_t)n;
+}
+
+void rssi_distance_cal_init(rssi_distance_cal_t *cal, rssi_distance_cal_entry_t *storage,
+                            size_t cap, const rssi_distance_model_t *dflt)
+{
+    cal->entries = storage;
+    cal->count = 0;
+    cal->cap = cap;
+    cal->dflt = *dflt;
+}
+
+bool rssi_distance_cal_set(rssi_distance_cal_t *cal, const uint8_t bssid[6], int16_t tx_q4,
+                           uint16_t n_q8)
+{
+    rssi_distance_cal_entry_t *e = NULL;
+
+    for (size_t i = 0; i < cal->count && !e; i++) {
+        if (memcmp(cal->entries[i].bssid, bssid, 6) == 0) {
+            e = &cal->entries[i];
+        }
+    }
+    if (!e) {
+        if (cal->count >= cal->cap) {
+            return false;
+        }
+        e = &cal->entries[cal->count++];
+        memcpy(e->bssid, bssid, 6);
+    }
+
+    rssi_distance_model_init(&e->model, tx_q4, n_q8);
+    return true;
+}
+
+size_t rssi_distance_cal_add_list(rssi_distance_cal_t *cal, const char *list)
+{
+    size_t added = 0;
+    const char *p = list;
+
+    while (*p) {
+        while (*p == ',' || *p == ' ') {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+
+        uint8_t mac[6];
+        char *end = NULL;
+        bool ok = scan_record_parse_mac(p, mac) && p[17] == '@';
+        long tx = ok ? strtol(p + 18, &end, 10) : 0;
+        ok = ok && *end == '/';
+        long n10 = ok ? strtol(end + 1, &end, 10) : 0;
+        ok = ok && (*end == '\0' || *end == ',' || *end == ' ');
+
+        if (ok && rssi_distance_cal_set(cal, mac, (int16_t)(tx * 16),
+                                        (uint16_t)((n10 * 256 + 5) / 10))) {
+            added++;
+        }
+
+        // Skip to the next separator, valid or not
+        while (*p && *p != ',' && *p != ' ') {
+            p++;
+        }
+    }
+
+    return added;
+}
+
+const rssi_distance_model_t *rssi_distance_cal_lookup(const rssi_distance_cal_t *cal,
+                                                      const uint8_t bssid[6])
+{
+    for (size_t i = 0; i < cal->count; i++) {
+        if (memcmp(cal->entries[i].bssid, bssid, 6) == 0) {
+            return &cal->entries[i].model;
+        }
+    }
+    return &cal->dflt;
+}
@@ -0,0 +1,141 @@
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "crc32.h"
+#include "scan_cache.h"
+
+static const char *TAG = "SCAN_CACHE";
+
+#define CACHE_MAGIC         0x53434331  // "SCC1"
+#define CACHE_NVS_NAMESPACE "scan_cache"
+#define CACHE_NVS_KEY       "snapshot"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t crc;
+    scan_cache_t data;
+} cache_blob_t;
+
+// Not zeroed on reset, so validity is decided by magic and CRC
+RTC_NOINIT_ATTR static cache_blob_t rtc_blob;
+static int64_t last_nvs_write_us = -1;
+
+static bool blob_valid(const cache_blob_t *blob)
+{
+    return blob->magic == CACHE_MAGIC &&
+           blob->data.count <= SCAN_CACHE_MAX_RECORDS &&
+           blob->crc == crc32_update(0, &blob->data, sizeof(blob->data));
+}
+
+static esp_err_t nvs_load(cache_blob_t *blob)
+{
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(CACHE_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    size_t len = sizeof(*blob);
+    ret = nvs_get_blob(nvs, CACHE_NVS_KEY, blob, &len);
+    nvs_close(nvs);
+
+    if (ret == ESP_OK && (len != sizeof(*blob) || !blob_valid(blob))) {
+        ret = ESP_ERR_INVALID_CRC;
+    }
+    return ret;
+}
+
+static void nvs_save(const cache_blob_t *blob)
+{
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(CACHE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NVS open failed: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    ret = nvs_set_blob(nvs, CACHE_NVS_KEY, blob, sizeof(*blob));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NVS save failed: %s", esp_err_to_name(ret));
+    }
+}
+
+esp_err_t scan_cache_load(scan_cache_t *cache)
+{
+    if (blob_valid(&rtc_blob)) {
+        *cache = rtc_blob.data;
+        ESP_LOGI(TAG, "Loaded %d APs from RTC memory", cache->count);
+        return ESP_OK;
+    }
+
+    cache_blob_t blob;
+    if (nvs_load(&blob) == ESP_OK) {
+        *cache = blob.data;
+        rtc_blob = blob;
+        ESP_LOGI(TAG, "Loaded %d APs from NVS", cache->count);
+        return ESP_OK;
+    }
+
+    return ESP_ERR_NOT_FOUND;
+}
+
+void scan_cache_store(const scan_record_t *recs, size_t count, uint32_t nvs_period_s)
+{
+    scan_cache_t *c = &rtc_blob.data;
+
+    if (count > SCAN_CACHE_MAX_RECORDS) {
+        count = SCAN_CACHE_MAX_RECORDS;
+    }
+
+    // Zero first so padding and unused slots give a stable CRC
+    memset(c, 0, sizeof(*c));
+    c->count = count;
+    memcpy(c->records, recs, count * sizeof(recs[0]));
+    for (size_t i = 0; i < count; i++) {
+        if (recs[i].channel <= SCAN_CACHE_CHANNELS && c->channel_aps[recs[i].channel] < UINT8_MAX) {
+            c->channel_aps[recs[i].channel]++;
+        }
+    }
+    rtc_blob.magic = CACHE_MAGIC;
+    rtc_blob.crc = crc32_update(0, c, sizeof(*c));
+
+    int64_t now = esp_timer_get_time();
+    if (last_nvs_write_us < 0 || now - last_nvs_write_us >= nvs_period_s * 1000000LL) {
+        nvs_save(&rtc_blob);
+        last_nvs_write_us = now;
+    }
+}
+
+size_t scan_cache_busy_channels(const scan_cache_t *cache, uint8_t *order, size_t max)
+{
+    uint8_t busy[SCAN_CACHE_CHANNELS];
+    size_t n = 0;
+
+    for (uint8_t ch = 1; ch <= SCAN_CACHE_CHANNELS; ch++) {
+        if (cache->channel_aps[ch] == 0) {
+            continue;
+        }
+        // Insertion sort, busiest first
+        size_t pos = n++;
+        while (pos > 0 && cache->channel_aps[busy[pos - 1]] < cache->channel_aps[ch]) {
+            busy[pos] = busy[pos - 1];
+            pos--;
+        }
+        busy[pos] = ch;
+    }
+
+    if (n > max) {
+        n = max;
+    }
+    memcpy(order, busy, n);
+    return n;
+}
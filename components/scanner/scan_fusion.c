@@ -0,0 +1,134 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "scan_fusion.h"
+
+void scan_fusion_init(scan_fusion_t *f, scan_fusion_entry_t *storage, size_t cap)
+{
+    f->entries = storage;
+    f->cap = cap;
+    scan_fusion_reset(f);
+}
+
+void scan_fusion_reset(scan_fusion_t *f)
+{
+    f->count = 0;
+    f->scans = 0;
+    f->dropped = 0;
+}
+
+static scan_fusion_entry_t *find(scan_fusion_t *f, const uint8_t bssid[6])
+{
+    for (size_t i = 0; i < f->count; i++) {
+        if (memcmp(f->entries[i].rec.bssid, bssid, 6) == 0) {
+            return &f->entries[i];
+        }
+    }
+    return NULL;
+}
+
+void scan_fusion_add_scan(scan_fusion_t *f, const scan_record_t *recs, size_t n, int64_t now_us)
+{
+    if (f->scans >= SCAN_FUSION_MAX_SCANS) {
+        return;
+    }
+    uint8_t scan = f->scans++;
+
+    for (size_t i = 0; i < n; i++) {
+        scan_fusion_entry_t *e = find(f, recs[i].bssid);
+
+        if (!e) {
+            if (f->count == f->cap) {
+                f->dropped++;
+                continue;
+            }
+            e = &f->entries[f->count++];
+            e->seen = 0;
+        } else if (e->last_scan == scan) {
+            continue;
+        }
+
+        // Keep a hidden network's SSID if a later sub-scan only got the beacon
+        scan_record_t prev = e->rec;
+        e->rec = recs[i];
+        if (e->seen > 0 && recs[i].ssid_len == 0 && prev.ssid_len > 0) {
+            memcpy(e->rec.ssid, prev.ssid, sizeof(prev.ssid));
+            e->rec.ssid_len = prev.ssid_len;
+        }
+        e->rssi[e->seen++] = recs[i].rssi;
+        e->last_scan = scan;
+        e->last_seen_us = now_us;
+    }
+}
+
+int8_t scan_fusion_median(const int8_t *samples, uint8_t n)
+{
+    int8_t s[SCAN_FUSION_MAX_SCANS];
+
+    if (n == 0) {
+        return 0;
+    }
+
+    // Insertion sort; n is at most SCAN_FUSION_MAX_SCANS
+    for (uint8_t i = 0; i < n; i++) {
+        int8_t v = samples[i];
+        int j = i;
+        while (j > 0 && s[j - 1] > v) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = v;
+    }
+
+    if (n & 1) {
+        return s[n / 2];
+    }
+    // Mean of the middle two, half away from zero
+    int sum = s[n / 2 - 1] + s[n / 2];
+    return (int8_t)(sum >= 0 ? (sum + 1) / 2 : (sum - 1) / 2);
+}
+
+static int cmp_rssi_desc(const void *a, const void *b)
+{
+    const scan_fusion_ap_t *x = a;
+    const scan_fusion_ap_t *y = b;
+    if (x->rec.rssi != y->rec.rssi) {
+        return y->rec.rssi - x->rec.rssi;
+    }
+    return memcmp(x->rec.bssid, y->rec.bssid, 6);
+}
+
+size_t scan_fusion_report(const scan_fusion_t *f, int64_t now_us, scan_fusion_ap_t *out,
+                          size_t cap)
+{
+    size_t n = f->count < cap ? f->count : cap;
+
+    for (size_t i = 0; i < f->count; i++) {
+        const scan_fusion_entry_t *e = &f->entries[i];
+        scan_fusion_ap_t ap = {
+            .rec = e->rec,
+            .seen = e->seen,
+            .scans = f->scans,
+            .age_ms = (uint32_t)((now_us - e->last_seen_us) / 1000),
+        };
+        ap.rec.rssi = scan_fusion_median(e->rssi, e->seen);
+
+        if (i < cap) {
+            out[i] = ap;
+        } else {
+            // Out of room: keep the strongest
+            size_t weakest = 0;
+            for (size_t k = 1; k < cap; k++) {
+                if (out[k].rec.rssi < out[weakest].rec.rssi) {
+                    weakest = k;
+                }
+            }
+            if (cap > 0 && ap.rec.rssi > out[weakest].rec.rssi) {
+                out[weakest] = ap;
+            }
+        }
+    }
+
+    qsort(out, n, sizeof(*out), cmp_rssi_desc);
+    return n;
+}
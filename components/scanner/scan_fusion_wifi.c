@@ -0,0 +1,58 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+
+#include "scan_fusion_wifi.h"
+#include "scan_record_wifi.h"
+
+static const char *TAG = "SCAN_FUSION";
+
+esp_err_t scan_fusion_wifi_run(scan_fusion_t *f, const scan_fusion_wifi_config_t *cfg,
+                               int64_t *radio_us)
+{
+    // One scanning task at a time, so these can live outside its stack
+    static wifi_ap_record_t aps[SCAN_FUSION_WIFI_MAX_APS];
+    static scan_record_t recs[SCAN_FUSION_WIFI_MAX_APS];
+    esp_err_t last_err = ESP_OK;
+
+    const wifi_scan_config_t scan_config = {
+        .show_hidden = true,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = cfg->dwell_ms / 3,
+        .scan_time.active.max = cfg->dwell_ms,
+    };
+
+    scan_fusion_reset(f);
+    for (uint8_t k = 0; k < cfg->scans && k < SCAN_FUSION_MAX_SCANS; k++) {
+        if (k > 0 && cfg->gap_ms > 0) {
+            vTaskDelay(pdMS_TO_TICKS(cfg->gap_ms));
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        last_err = esp_wifi_scan_start(&scan_config, true);
+        int64_t now = esp_timer_get_time();
+        if (radio_us) {
+            *radio_us += now - t0;
+        }
+        if (last_err != ESP_OK) {
+            ESP_LOGW(TAG, "Sub-scan %u failed: %s", k, esp_err_to_name(last_err));
+            continue;
+        }
+
+        uint16_t n = SCAN_FUSION_WIFI_MAX_APS;
+        if (esp_wifi_scan_get_ap_records(&n, aps) != ESP_OK) {
+            n = 0;
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            scan_record_from_wifi(&aps[i], &recs[i]);
+            if (cfg->on_record) {
+                cfg->on_record(&recs[i], cfg->arg);
+            }
+        }
+        scan_fusion_add_scan(f, recs, n, now);
+    }
+
+    return f->scans > 0 ? ESP_OK : last_err;
+}
@@ -0,0 +1,105 @@
+#include <string.h>
+
+#include "scan_interval.h"
+
+static void sort_by_bssid(scan_interval_ap_t *aps, size_t n)
+{
+    // Insertion sort: n is small and scan order is often already close
+    for (size_t i = 1; i < n; i++) {
+        scan_interval_ap_t key = aps[i];
+        size_t j = i;
+        while (j > 0 && memcmp(aps[j - 1].bssid, key.bssid, 6) > 0) {
+            aps[j] = aps[j - 1];
+            j--;
+        }
+        aps[j] = key;
+    }
+}
+
+static uint16_t churn_permille(const scan_interval_t *ctl, const scan_interval_ap_t *cur, size_t n)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t changed = 0;
+    size_t total = 0;
+
+    // Merge walk over both sorted sets
+    while (i < ctl->prev_count || j < n) {
+        int cmp;
+        if (i == ctl->prev_count) {
+            cmp = 1;
+        } else if (j == n) {
+            cmp = -1;
+        } else {
+            cmp = memcmp(ctl->prev[i].bssid, cur[j].bssid, 6);
+        }
+
+        if (cmp < 0) {
+            changed++;          // disappeared
+            i++;
+        } else if (cmp > 0) {
+            changed++;          // appeared
+            j++;
+        } else {
+            int delta = cur[j].rssi - ctl->prev[i].rssi;
+            if (delta >= ctl->cfg.rssi_delta_db || -delta >= ctl->cfg.rssi_delta_db) {
+                changed++;
+            }
+            i++;
+            j++;
+        }
+        total++;
+    }
+
+    return total ? (uint16_t)(changed * 1000 / total) : 0;
+}
+
+void scan_interval_init(scan_interval_t *ctl, const scan_interval_config_t *cfg)
+{
+    memset(ctl, 0, sizeof(*ctl));
+    ctl->cfg = *cfg;
+    if (ctl->cfg.max_ms < ctl->cfg.min_ms) {
+        ctl->cfg.max_ms = ctl->cfg.min_ms;
+    }
+    ctl->interval_ms = ctl->cfg.min_ms;
+}
+
+uint32_t scan_interval_update(scan_interval_t *ctl, const scan_record_t *recs, size_t count)
+{
+    scan_interval_ap_t cur[SCAN_INTERVAL_MAX_APS];
+    size_t n = count > SCAN_INTERVAL_MAX_APS ? SCAN_INTERVAL_MAX_APS : count;
+
+    for (size_t k = 0; k < n; k++) {
+        memcpy(cur[k].bssid, recs[k].bssid, 6);
+        cur[k].rssi = recs[k].rssi;
+    }
+    sort_by_bssid(cur, n);
+
+    uint16_t churn = churn_permille(ctl, cur, n);
+    if (ctl->scans == 0 || churn >= ctl->cfg.churn_threshold_permille) {
+        // First scan or the environment is moving: look again soon
+        ctl->interval_ms = ctl->cfg.min_ms;
+    } else if (churn == 0) {
+        uint32_t next = ctl->interval_ms * 2;
+        ctl->interval_ms = next > ctl->cfg.max_ms ? ctl->cfg.max_ms : next;
+    }
+
+    memcpy(ctl->prev, cur, n * sizeof(cur[0]));
+    ctl->prev_count = n;
+    ctl->last_churn_permille = churn;
+    ctl->scans++;
+    ctl->elapsed_ms += ctl->interval_ms;
+
+    return ctl->interval_ms;
+}
+
+uint32_t scan_interval_period(scan_interval_t *ctl, uint32_t busy_ms)
+{
+    uint32_t floor_ms = busy_ms + ctl->cfg.min_ms;
+    if (ctl->interval_ms >= floor_ms) {
+        return ctl->interval_ms;
+    }
+
+    ctl->elapsed_ms += floor_ms - ctl->interval_ms;
+    return floor_ms;
+}
@@ -0,0 +1,114 @@
+#include <string.h>
+
+#include "scan_record.h"
+
+/* Per-kind code, pasted into the generated functions below. Each field
+ * is guarded by its mask bit; with a constant mask the compiler drops
+ * the disabled ones entirely.
+ */
+
+#define LEN_MAC(m)      6
+#define LEN_I8(m)       1
+#define LEN_U8(m)       1
+#define LEN_U16(m)      2
+#define LEN_U32(m)      4
+#define LEN_STR(m)      (1 + (rec->m##_len > SCAN_RECORD_SSID_MAX ? SCAN_RECORD_SSID_MAX : rec->m##_len))
+
+#define PUT_MAC(m)      memcpy(out + off, rec->m, 6); off += 6;
+#define PUT_I8(m)       out[off++] = (uint8_t)rec->m;
+#define PUT_U8(m)       out[off++] = rec->m;
+#define PUT_U16(m)      out[off++] = rec->m & 0xFF; out[off++] = rec->m >> 8;
+#define PUT_U32(m)      for (int i = 0; i < 4; i++) { out[off++] = (rec->m >> (8 * i)) & 0xFF; }
+#define PUT_STR(m)                                                              \
+    {                                                                           \
+        size_t n = LEN_STR(m) - 1;                                              \
+        out[off++] = (uint8_t)n;                                                \
+        memcpy(out + off, rec->m, n);                                           \
+        off += n;                                                               \
+    }
+
+// Fixed kinds check their width up front; STR also needs its length byte
+#define SKIP_FIXED(w)   if (len - off < (w)) { return 0; } off += (w);
+#define SKIP_MAC(m)     SKIP_FIXED(6)
+#define SKIP_I8(m)      SKIP_FIXED(1)
+#define SKIP_U8(m)      SKIP_FIXED(1)
+#define SKIP_U16(m)     SKIP_FIXED(2)
+#define SKIP_U32(m)     SKIP_FIXED(4)
+#define SKIP_STR(m)                                                             \
+    if (off >= len || in[off] > SCAN_RECORD_SSID_MAX || len - off - 1 < in[off]) { \
+        return 0;                                                               \
+    }                                                                           \
+    off += 1 + in[off];
+
+#define GET_MAC(m)      memcpy(rec->m, in + off, 6); off += 6;
+#define GET_I8(m)       rec->m = (int8_t)in[off++];
+#define GET_U8(m)       rec->m = in[off++];
+#define GET_U16(m)      rec->m = in[off] | (in[off + 1] << 8); off += 2;
+#define GET_U32(m)                                                              \
+    rec->m = in[off] | (in[off + 1] << 8) | ((uint32_t)in[off + 2] << 16) |     \
+             ((uint32_t)in[off + 3] << 24);                                     \
+    off += 4;
+#define GET_STR(m)                                                              \
+    rec->m##_len = in[off++];                                                   \
+    memcpy(rec->m, in + off, rec->m##_len);                                     \
+    rec->m[rec->m##_len] = '\0';                                                \
+    off += rec->m##_len;
+
+#define GEN_LEN(name, bit, kind, member)                                        \
+    if (mask & (1u << (bit))) { total += LEN_##kind(member); }
+#define GEN_PUT(name, bit, kind, member)                                        \
+    if (mask & (1u << (bit))) { PUT_##kind(member) }
+#define GEN_SKIP(name, bit, kind, member)                                       \
+    if (mask & (1u << (bit))) { SKIP_##kind(member) }
+#define GEN_GET(name, bit, kind, member)                                        \
+    if (mask & (1u << (bit))) { GET_##kind(member) }
+
+static inline size_t encode_fields(const scan_record_t *rec, uint8_t mask, uint8_t *out,
+                                   size_t cap)
+{
+    size_t total = 0;
+    size_t off = 0;
+
+    SCAN_RECORD_FIELDS(GEN_LEN)
+    if (cap < total) {
+        return 0;
+    }
+
+    SCAN_RECORD_FIELDS(GEN_PUT)
+    return off;
+}
+
+size_t scan_record_encode(const scan_record_t *rec, uint8_t *out, size_t cap)
+{
+    return encode_fields(rec, SCAN_RECORD_WIRE_MASK, out, cap);
+}
+
+size_t scan_record_encode_mask(const scan_record_t *rec, uint8_t mask, uint8_t *out, size_t cap)
+{
+    return encode_fields(rec, mask | SCAN_FIELD_BSSID, out, cap);
+}
+
+size_t scan_record_wire_len(const uint8_t *in, size_t len, uint8_t mask)
+{
+    size_t off = 0;
+
+    mask |= SCAN_FIELD_BSSID;
+    SCAN_RECORD_FIELDS(GEN_SKIP)
+    return off;
+}
+
+size_t scan_record_decode(const uint8_t *in, size_t len, uint8_t mask, scan_record_t *rec)
+{
+    // Validate the whole record first so rec is only touched on success
+    size_t total = scan_record_wire_len(in, len, mask);
+    if (total == 0) {
+        return 0;
+    }
+
+    size_t off = 0;
+    memset(rec, 0, sizeof(*rec));
+    mask |= SCAN_FIELD_BSSID;
+    SCAN_RECORD_FIELDS(GEN_GET)
+
+    return off;
+}
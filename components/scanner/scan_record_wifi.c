@@ -0,0 +1,26 @@
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "oui_db.h"
+#include "scan_record_wifi.h"
+
+void scan_record_from_wifi(const wifi_ap_record_t *ap, scan_record_t *rec)
+{
+    memcpy(rec->bssid, ap->bssid, sizeof(rec->bssid));
+    rec->rssi = ap->rssi;
+    rec->channel = ap->primary;
+    rec->authmode = ap->authmode;
+    rec->ssid_len = strnlen((const char *)ap->ssid, SCAN_RECORD_SSID_MAX);
+    memcpy(rec->ssid, ap->ssid, rec->ssid_len);
+    rec->ssid[rec->ssid_len] = '\0';
+    // Callers with an AP table fill in an estimate later
+    rec->distance_cm = 0;
+    rec->vendor_id = OUI_DB_UNKNOWN;
+#if CONFIG_SCANNER_OUI_ENABLE
+    // Disabled fields cost no cycles either
+    if (SCAN_RECORD_MASK & SCAN_FIELD_VENDOR) {
+        rec->vendor_id = oui_db_lookup(&oui_db_builtin, rec->bssid);
+    }
+#endif
+}
@@ -0,0 +1,191 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "scan_sched.h"
+
+static const char *TAG = "SCAN_SCHED";
+
+struct scan_sched_job {
+    const char *name;
+    sched_job_t core;
+    void (*fn)(void *arg);      // NULL: task job
+    void *arg;
+    SemaphoreHandle_t wake;     // task jobs: given at the deadline
+    bool waiting;
+};
+
+static scan_sched_job_t jobs[SCAN_SCHED_MAX_JOBS];
+static size_t n_jobs = 0;
+static SemaphoreHandle_t sched_lock = NULL;
+static esp_timer_handle_t sched_timer = NULL;
+
+// Timer for the earliest deadline that someone is waiting on; a busy task
+// job is left out until it comes back to wait
+static void arm_locked(void)
+{
+    int64_t next = INT64_MAX;
+    for (size_t i = 0; i < n_jobs; i++) {
+        if ((jobs[i].fn || jobs[i].waiting) && jobs[i].core.deadline_us < next) {
+            next = jobs[i].core.deadline_us;
+        }
+    }
+
+    esp_timer_stop(sched_timer);
+    if (next != INT64_MAX) {
+        int64_t delay = next - esp_timer_get_time();
+        esp_timer_start_once(sched_timer, delay > 0 ? (uint64_t)delay : 1);
+    }
+}
+
+static void sched_tick(void *arg)
+{
+    scan_sched_job_t *due[SCAN_SCHED_MAX_JOBS];
+    size_t n_due = 0;
+
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    for (size_t i = 0; i < n_jobs; i++) {
+        scan_sched_job_t *job = &jobs[i];
+        if (job->core.deadline_us > now) {
+            continue;
+        }
+        if (job->fn) {
+            sched_job_wake(&job->core, now);
+            due[n_due++] = job;
+        } else if (job->waiting) {
+            // Lateness is taken when the task actually runs
+            job->waiting = false;
+            xSemaphoreGive(job->wake);
+        }
+    }
+    arm_locked();
+    xSemaphoreGive(sched_lock);
+
+    for (size_t i = 0; i < n_due; i++) {
+        due[i]->fn(due[i]->arg);
+    }
+}
+
+uint32_t scan_sched_wait(scan_sched_job_t *job)
+{
+    uint32_t missed;
+
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    if (job->core.deadline_us <= now) {
+        missed = sched_job_overdue(&job->core, now);
+        xSemaphoreGive(sched_lock);
+        return missed;
+    }
+    job->waiting = true;
+    arm_locked();
+    xSemaphoreGive(sched_lock);
+
+    xSemaphoreTake(job->wake, portMAX_DELAY);
+
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    missed = sched_job_wake(&job->core, esp_timer_get_time());
+    xSemaphoreGive(sched_lock);
+    return missed;
+}
+
+void scan_sched_set_period(scan_sched_job_t *job, uint32_t period_us)
+{
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    sched_job_set_period(&job->core, period_us);
+    if (job->fn || job->waiting) {
+        arm_locked();
+    }
+    xSemaphoreGive(sched_lock);
+}
+
+void scan_sched_take(scan_sched_job_t *job, sched_job_summary_t *out)
+{
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    sched_job_take(&job->core, out);
+    xSemaphoreGive(sched_lock);
+}
+
+scan_sched_job_t *scan_sched_add(const char *name, uint32_t period_us, void (*fn)(void *arg),
+                                 void *arg)
+{
+    if (!sched_lock || period_us == 0) {
+        return NULL;
+    }
+
+    SemaphoreHandle_t wake = NULL;
+    if (!fn && !(wake = xSemaphoreCreateBinary())) {
+        return NULL;
+    }
+
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    if (n_jobs == SCAN_SCHED_MAX_JOBS) {
+        xSemaphoreGive(sched_lock);
+        if (wake) {
+            vSemaphoreDelete(wake);
+        }
+        ESP_LOGE(TAG, "No slot for job %s", name);
+        return NULL;
+    }
+    // Filled before it is counted: the report walks the table unlocked
+    scan_sched_job_t *job = &jobs[n_jobs];
+    *job = (scan_sched_job_t){
+        .name = name,
+        .fn = fn,
+        .arg = arg,
+        .wake = wake,
+    };
+    sched_job_init(&job->core, period_us, esp_timer_get_time() + period_us);
+    n_jobs++;
+    if (fn) {
+        arm_locked();
+    }
+    xSemaphoreGive(sched_lock);
+
+    ESP_LOGI(TAG, "Job %s every %lu us", name, (unsigned long)period_us);
+    return job;
+}
+
+static void report_job(void *arg)
+{
+    for (size_t i = 0; i < n_jobs; i++) {
+        sched_job_summary_t s;
+        scan_sched_take(&jobs[i], &s);
+        ESP_LOGI(TAG, "%s: %lu runs, %lu missed; late avg %lu us, p99 %lu us, max %lu us",
+                 jobs[i].name, (unsigned long)s.runs, (unsigned long)s.misses,
+                 (unsigned long)s.late_avg_us, (unsigned long)s.late_p99_us,
+                 (unsigned long)s.late_max_us);
+    }
+}
+
+esp_err_t scan_sched_init(const scan_sched_config_t *cfg)
+{
+    if (sched_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = sched_tick,
+        .name = "sched",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &sched_timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    sched_lock = xSemaphoreCreateMutex();
+    if (!sched_lock) {
+        esp_timer_delete(sched_timer);
+        sched_timer = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (cfg->report_s > 0 && !scan_sched_add("report", cfg->report_s * 1000000, report_job, NULL)) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
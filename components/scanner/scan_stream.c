@@ -0,0 +1,183 @@
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/ringbuf.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#if CONFIG_SCANNER_STREAM_USB_SERIAL_JTAG
+#include "driver/usb_serial_jtag.h"
+#else
+#include "driver/uart.h"
+#endif
+
+#include "power_mgr.h"
+#include "scan_stream.h"
+#include "stream_frame.h"
+
+static const char *TAG = "SCAN_STREAM";
+
+#define STREAM_WRITER_STACK     3072
+#define STREAM_WRITER_PRIO      3
+#define STREAM_DRIVER_TX_BUF    2048
+#define STREAM_FLUSH_MS         200
+
+static RingbufHandle_t stream_ring = NULL;
+static SemaphoreHandle_t encode_lock = NULL;
+static uint8_t encode_buf[STREAM_FRAME_MAX_WIRE];
+static uint16_t next_seq = 0;
+static scan_stream_stats_t stream_stats;
+
+/* ===================== TRANSPORT ===================== */
+static esp_err_t transport_init(void)
+{
+#if CONFIG_SCANNER_STREAM_USB_SERIAL_JTAG
+    usb_serial_jtag_driver_config_t cfg = {
+        .tx_buffer_size = STREAM_DRIVER_TX_BUF,
+        .rx_buffer_size = 256,
+    };
+    return usb_serial_jtag_driver_install(&cfg);
+#else
+    const uart_config_t cfg = {
+        .baud_rate = CONFIG_SCANNER_STREAM_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    // RX buffer must exceed the hardware FIFO even though we never read
+    esp_err_t ret = uart_driver_install(CONFIG_SCANNER_STREAM_UART_NUM, 256,
+                                        STREAM_DRIVER_TX_BUF, 0, NULL, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = uart_param_config(CONFIG_SCANNER_STREAM_UART_NUM, &cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return uart_set_pin(CONFIG_SCANNER_STREAM_UART_NUM, CONFIG_SCANNER_STREAM_UART_TX_PIN,
+                        UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+#endif
+}
+
+static int transport_write(const void *data, size_t len)
+{
+#if CONFIG_SCANNER_STREAM_USB_SERIAL_JTAG
+    return usb_serial_jtag_write_bytes(data, len, portMAX_DELAY);
+#else
+    return uart_write_bytes(CONFIG_SCANNER_STREAM_UART_NUM, data, len);
+#endif
+}
+
+// Waits until the driver has shifted out what it was given
+static void transport_flush(void)
+{
+#if CONFIG_SCANNER_STREAM_USB_SERIAL_JTAG
+    // The host polls the endpoint; nothing to wait for on this side
+#else
+    uart_wait_tx_done(CONFIG_SCANNER_STREAM_UART_NUM, pdMS_TO_TICKS(STREAM_FLUSH_MS));
+#endif
+}
+
+/* ===================== WRITER TASK ===================== */
+static void stream_writer_task(void *arg)
+{
+    while (1) {
+        size_t len = 0;
+        uint8_t *item = xRingbufferReceive(stream_ring, &len, portMAX_DELAY);
+        if (item == NULL) {
+            continue;
+        }
+
+        // One TX stage per burst, held until the last byte is on the wire:
+        // the UART clock stops in light sleep
+        power_stage_begin(DUTY_STAGE_TX);
+        while (item) {
+            int written = transport_write(item, len);
+            vRingbufferReturnItem(stream_ring, item);
+
+            if (written > 0) {
+                stream_stats.bytes_sent += written;
+                stream_stats.frames_sent++;
+            }
+            item = xRingbufferReceive(stream_ring, &len, 0);
+        }
+        transport_flush();
+        power_stage_end(DUTY_STAGE_TX);
+    }
+}
+
+/* ===================== PUBLIC API ===================== */
+esp_err_t scan_stream_init(void)
+{
+    if (stream_ring) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = transport_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Transport init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    encode_lock = xSemaphoreCreateMutex();
+    stream_ring = xRingbufferCreate(CONFIG_SCANNER_STREAM_RING_SIZE, RINGBUF_TYPE_NOSPLIT);
+    if (!encode_lock || !stream_ring) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xTaskCreate(stream_writer_task, "stream_tx", STREAM_WRITER_STACK, NULL, STREAM_WRITER_PRIO, NULL);
+
+#if CONFIG_SCANNER_STREAM_USB_SERIAL_JTAG
+    ESP_LOGI(TAG, "Binary stream on USB-Serial-JTAG");
+#else
+    ESP_LOGI(TAG, "Binary stream on UART%d @ %d baud (TX GPIO%d)", CONFIG_SCANNER_STREAM_UART_NUM,
+             CONFIG_SCANNER_STREAM_BAUD, CONFIG_SCANNER_STREAM_UART_TX_PIN);
+#endif
+    return ESP_OK;
+}
+
+esp_err_t scan_stream_send(uint8_t type, uint8_t flags, const void *payload, size_t len)
+{
+    if (!stream_ring) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Callers include the esp_timer task (duty reports), which must not
+    // wait behind a preempted producer. Another encode in flight costs
+    // this frame, as a full ring does.
+    if (xSemaphoreTake(encode_lock, 0) != pdTRUE) {
+        stream_stats.frames_dropped++;
+        return ESP_ERR_NO_MEM;
+    }
+
+    stream_frame_hdr_t hdr = {
+        .type = type,
+        .flags = flags,
+        .seq = next_seq++,
+        .timestamp_us = esp_timer_get_time(),
+    };
+    size_t n = stream_frame_encode(&hdr, payload, len, encode_buf, sizeof(encode_buf));
+
+    esp_err_t ret = ESP_OK;
+    if (n == 0) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else if (xRingbufferSend(stream_ring, encode_buf, n, 0) != pdTRUE) {
+        // Host is not keeping up; the sequence gap tells it what was lost
+        stream_stats.frames_dropped++;
+        ret = ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreGive(encode_lock);
+    return ret;
+}
+
+void scan_stream_get_stats(scan_stream_stats_t *stats)
+{
+    *stats = stream_stats;
+}
@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "sched_job.h"
+
+void sched_job_init(sched_job_t *j, int64_t period_us, int64_t first_us)
+{
+    memset(j, 0, sizeof(*j));
+    j->period_us = period_us > 0 ? period_us : 1;
+    j->deadline_us = first_us;
+}
+
+void sched_job_set_period(sched_job_t *j, int64_t period_us)
+{
+    period_us = period_us > 0 ? period_us : 1;
+    j->deadline_us += period_us - j->period_us;
+    j->period_us = period_us;
+}
+
+// Steps past the deadline just served; grid points already behind now_us
+// are skipped and returned as misses
+static uint32_t advance(sched_job_t *j, int64_t now_us)
+{
+    j->runs++;
+    j->deadline_us += j->period_us;
+    if (j->deadline_us > now_us) {
+        return 0;
+    }
+
+    int64_t skip = (now_us - j->deadline_us) / j->period_us + 1;
+    j->deadline_us += skip * j->period_us;
+    j->misses += (uint32_t)skip;
+    return (uint32_t)skip;
+}
+
+uint32_t sched_job_wake(sched_job_t *j, int64_t now_us)
+{
+    int64_t late = now_us - j->deadline_us;
+    uint32_t late_us = late <= 0 ? 0 : late >= UINT32_MAX ? UINT32_MAX : (uint32_t)late;
+
+    int b = 0;
+    while (b < SCHED_JITTER_BUCKETS - 1 && late_us >= (16u << (2 * b))) {
+        b++;
+    }
+    j->late_hist[b]++;
+    j->late_n++;
+    j->late_sum_us += late_us;
+    j->late_max_us = late_us > j->late_max_us ? late_us : j->late_max_us;
+
+    return advance(j, now_us);
+}
+
+uint32_t sched_job_overdue(sched_job_t *j, int64_t now_us)
+{
+    j->misses++;
+    return 1 + advance(j, now_us);
+}
+
+void sched_job_take(sched_job_t *j, sched_job_summary_t *out)
+{
+    out->runs = j->runs;
+    out->misses = j->misses;
+    out->late_n = j->late_n;
+    out->late_avg_us = j->late_n ? (uint32_t)(j->late_sum_us / j->late_n) : 0;
+    out->late_max_us = j->late_max_us;
+
+    // Upper bound of the bucket holding the 99th percentile
+    uint32_t want = j->late_n - j->late_n / 100;
+    uint32_t seen = 0;
+    out->late_p99_us = 0;
+    for (int b = 0; b < SCHED_JITTER_BUCKETS && seen < want; b++) {
+        seen += j->late_hist[b];
+        out->late_p99_us = b < SCHED_JITTER_BUCKETS - 1 ? 16u << (2 * b) : j->late_max_us;
+    }
+    out->late_p99_us = out->late_p99_us < j->late_max_us ? out->late_p99_us : j->late_max_us;
+
+    j->late_n = 0;
+    j->late_sum_us = 0;
+    j->late_max_us = 0;
+    memset(j->late_hist, 0, sizeof(j->late_hist));
+}
@@ -0,0 +1,144 @@
+#include <string.h>
+
+#include "stage_duty.h"
+
+static const char *const stage_names[DUTY_STAGE_COUNT + 1] = {
+    [DUTY_STAGE_SCAN] = "scan",
+    [DUTY_STAGE_ENCODE] = "encode",
+    [DUTY_STAGE_TX] = "tx",
+    [DUTY_AWAKE] = "awake",
+};
+
+void stage_duty_init(stage_duty_t *d, int64_t now_us)
+{
+    memset(d, 0, sizeof(*d));
+    d->window_start_us = now_us;
+}
+
+void stage_duty_begin(stage_duty_t *d, duty_stage_t stage, int64_t now_us)
+{
+    if (d->depth[stage]++ == 0) {
+        d->since_us[stage] = now_us;
+        if (d->awake_depth++ == 0) {
+            d->awake_since_us = now_us;
+        }
+    }
+}
+
+void stage_duty_end(stage_duty_t *d, duty_stage_t stage, int64_t now_us)
+{
+    if (d->depth[stage] == 0) {
+        return;
+    }
+    if (--d->depth[stage] == 0) {
+        d->active_us[stage] += now_us - d->since_us[stage];
+        if (--d->awake_depth == 0) {
+            d->active_us[DUTY_AWAKE] += now_us - d->awake_since_us;
+        }
+    }
+}
+
+void stage_duty_report(stage_duty_t *d)
+{
+    d->reports++;
+}
+
+void stage_duty_take(stage_duty_t *d, int64_t now_us, stage_duty_summary_t *out)
+{
+    // Close open stages at now and reopen them for the next window
+    for (int s = 0; s < DUTY_STAGE_COUNT; s++) {
+        if (d->depth[s] > 0) {
+            d->active_us[s] += now_us - d->since_us[s];
+            d->since_us[s] = now_us;
+        }
+    }
+    if (d->awake_depth > 0) {
+        d->active_us[DUTY_AWAKE] += now_us - d->awake_since_us;
+        d->awake_since_us = now_us;
+    }
+
+    int64_t window_us = now_us - d->window_start_us;
+    out->window_ms = (uint32_t)(window_us / 1000);
+    out->reports = d->reports;
+    for (int s = 0; s <= DUTY_STAGE_COUNT; s++) {
+        uint64_t a = d->active_us[s];
+        out->permille[s] = window_us > 0 ? (uint16_t)((a * 1000 + window_us / 2) / window_us) : 0;
+        out->us_per_report[s] = d->reports > 0 ? (uint32_t)(a / d->reports) : 0;
+        d->active_us[s] = 0;
+    }
+
+    d->window_start_us = now_us;
+    d->reports = 0;
+}
+
+const char *stage_duty_name(int stage)
+{
+    return stage >= 0 && stage <= DUTY_STAGE_COUNT ? stage_names[stage] : "?";
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+size_t stage_duty_encode(const stage_duty_summary_t *s, uint8_t *out, size_t cap)
+{
+    if (cap < STAGE_DUTY_WIRE_LEN) {
+        return 0;
+    }
+
+    put_u32(out, s->window_ms);
+    put_u16(out + 4, s->reports > 0xffff ? 0xffff : (uint16_t)s->reports);
+    out[6] = DUTY_STAGE_COUNT + 1;
+
+    size_t off = 7;
+    for (int i = 0; i <= DUTY_STAGE_COUNT; i++) {
+        put_u16(out + off, s->permille[i]);
+        put_u32(out + off + 2, s->us_per_report[i]);
+        off += STAGE_DUTY_ENTRY_LEN;
+    }
+
+    return off;
+}
+
+size_t stage_duty_decode(const uint8_t *in, size_t len, stage_duty_summary_t *out)
+{
+    if (len < 7 || len < 7 + (size_t)in[6] * STAGE_DUTY_ENTRY_LEN) {
+        return 0;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->window_ms = get_u32(in);
+    out->reports = get_u16(in + 4);
+
+    // Entries in stage order with the union last; a sender with fewer or
+    // more stages still lines its union up with ours
+    size_t n = in[6];
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *e = in + 7 + i * STAGE_DUTY_ENTRY_LEN;
+        size_t slot = i + 1 == n ? DUTY_AWAKE : i;
+        if (slot < DUTY_AWAKE || i + 1 == n) {
+            out->permille[slot] = get_u16(e);
+            out->us_per_report[slot] = get_u32(e + 2);
+        }
+    }
+
+    return 7 + n * STAGE_DUTY_ENTRY_LEN;
+}
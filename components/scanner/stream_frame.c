@@ -0,0 +1,120 @@
+#include <string.h>
+
+#include "crc32.h"
+#include "stream_frame.h"
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static void put_le64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_le64(const uint8_t *p)
+{
+    return get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
+
+size_t stream_frame_encode(const stream_frame_hdr_t *hdr, const uint8_t *payload, size_t len,
+                           uint8_t *out, size_t cap)
+{
+    uint8_t head[STREAM_FRAME_HDR_LEN];
+    uint8_t tail[STREAM_FRAME_CRC_LEN];
+
+    if (len > STREAM_FRAME_MAX_PAYLOAD || cap < 1) {
+        return 0;
+    }
+
+    head[0] = hdr->type;
+    head[1] = hdr->flags;
+    put_le16(head + 2, hdr->seq);
+    put_le64(head + 4, hdr->timestamp_us);
+
+    uint32_t crc = crc32_update(0, head, sizeof(head));
+    crc = crc32_update(crc, payload, len);
+    put_le32(tail, crc);
+
+    // Encode in place from the pieces; no scratch copy of the raw frame
+    cobs_encoder_t enc;
+    cobs_encoder_init(&enc, out, cap - 1);
+    cobs_encoder_push(&enc, head, sizeof(head));
+    cobs_encoder_push(&enc, payload, len);
+    cobs_encoder_push(&enc, tail, sizeof(tail));
+
+    size_t n = cobs_encoder_finish(&enc);
+    if (n == 0) {
+        return 0;
+    }
+    out[n++] = 0x00;
+
+    return n;
+}
+
+int stream_frame_decode(const uint8_t *wire, size_t len, stream_frame_hdr_t *hdr,
+                        uint8_t *payload, size_t cap, size_t *payload_len)
+{
+    uint8_t raw[STREAM_FRAME_MAX_RAW];
+
+    size_t raw_len = cobs_decode(wire, len, raw, sizeof(raw));
+    if (raw_len == 0) {
+        return STREAM_FRAME_ERR_COBS;
+    }
+    if (raw_len < STREAM_FRAME_HDR_LEN + STREAM_FRAME_CRC_LEN) {
+        return STREAM_FRAME_ERR_SHORT;
+    }
+
+    size_t body_len = raw_len - STREAM_FRAME_CRC_LEN;
+    if (crc32_update(0, raw, body_len) != get_le32(raw + body_len)) {
+        return STREAM_FRAME_ERR_CRC;
+    }
+
+    size_t n = body_len - STREAM_FRAME_HDR_LEN;
+    if (n > cap) {
+        return STREAM_FRAME_ERR_SIZE;
+    }
+
+    hdr->type = raw[0];
+    hdr->flags = raw[1];
+    hdr->seq = raw[2] | (raw[3] << 8);
+    hdr->timestamp_us = get_le64(raw + 4);
+    memcpy(payload, raw + STREAM_FRAME_HDR_LEN, n);
+    *payload_len = n;
+
+    return STREAM_FRAME_OK;
+}
+
+size_t stream_deframer_push(stream_deframer_t *d, uint8_t byte)
+{
+    if (byte == 0x00) {
+        size_t n = d->len;
+        d->len = 0;
+        return n;
+    }
+
+    if (d->len >= sizeof(d->buf)) {
+        // Oversized garbage: drop it and resync on the next delimiter
+        d->overflows++;
+        d->len = 0;
+    }
+    d->buf[d->len++] = byte;
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "synth_load.h"
+
+void synth_load_init(synth_load_t *gen, const synth_load_config_t *cfg, int64_t now_us)
+{
+    memset(gen, 0, sizeof(*gen));
+    gen->cfg = *cfg;
+    if (gen->cfg.rate == 0) {
+        gen->cfg.rate = 1;
+    }
+    if (gen->cfg.batch == 0) {
+        gen->cfg.batch = 1;
+    }
+    gen->start_us = now_us;
+}
+
+int64_t synth_load_due_us(const synth_load_t *gen)
+{
+    return gen->start_us + (int64_t)gen->next_seq * 1000000LL / gen->cfg.rate;
+}
+
+bool synth_load_done(const synth_load_t *gen)
+{
+    return gen->cfg.count != 0 && gen->next_seq >= gen->cfg.count;
+}
+
+size_t synth_load_next(synth_load_t *gen, scan_record_t *recs, int64_t now_us)
+{
+    size_t n = 0;
+    uint32_t t_ms = (uint32_t)(now_us / 1000);
+
+    while (n < gen->cfg.batch && !synth_load_done(gen)) {
+        uint32_t seq = gen->next_seq++;
+        scan_record_t *rec = &recs[n++];
+
+        // No distance estimate or vendor; nothing left for the caller to fill
+        memset(rec, 0, sizeof(*rec));
+        rec->bssid[0] = SYNTH_LOAD_OUI0;
+        rec->bssid[1] = SYNTH_LOAD_OUI1;
+        rec->bssid[2] = seq >> 24;
+        rec->bssid[3] = seq >> 16;
+        rec->bssid[4] = seq >> 8;
+        rec->bssid[5] = seq;
+        rec->rssi = (int8_t)(-30 - (int)(seq % 61));
+        rec->channel = 1 + seq % 13;
+        rec->authmode = seq % 5;
+        rec->ssid_len = (uint8_t)snprintf(rec->ssid, sizeof(rec->ssid), "SYN %08lX %08lX",
+                                          (unsigned long)seq, (unsigned long)t_ms);
+    }
+
+    return n;
+}
+
+bool synth_load_parse(const scan_record_t *rec, uint32_t *seq)
+{
+    if (rec->bssid[0] != SYNTH_LOAD_OUI0 || rec->bssid[1] != SYNTH_LOAD_OUI1) {
+        return false;
+    }
+
+    *seq = ((uint32_t)rec->bssid[2] << 24) | ((uint32_t)rec->bssid[3] << 16) |
+           ((uint32_t)rec->bssid[4] << 8) | rec->bssid[5];
+    return true;
+}
@@ -0,0 +1,108 @@
+#include <string.h>
+
+#include "watch_alert.h"
+
+void watch_alert_init(watch_alert_t *wa, watchlist_t *wl, watch_alert_slot_t *slots,
+                      uint32_t absent_ms)
+{
+    memset(wa, 0, sizeof(*wa));
+    wa->wl = wl;
+    wa->slots = slots;
+    wa->absent_ms = absent_ms;
+    memset(slots, 0, sizeof(watch_alert_slot_t) * wl->cap);
+}
+
+bool watch_alert_add(watch_alert_t *wa, const uint8_t bssid[6])
+{
+    size_t before = wa->wl->count;
+    if (!watchlist_add(wa->wl, bssid)) {
+        return false;
+    }
+    if (wa->wl->count == before) {
+        return true;    // already listed
+    }
+
+    // Shift the state of later entries along with the sorted insert
+    size_t idx = (size_t)watchlist_find(wa->wl, bssid);
+    memmove(&wa->slots[idx + 1], &wa->slots[idx], (before - idx) * sizeof(wa->slots[0]));
+    memset(&wa->slots[idx], 0, sizeof(wa->slots[0]));
+    return true;
+}
+
+void watch_alert_clear(watch_alert_t *wa)
+{
+    watchlist_clear(wa->wl);
+    memset(wa->slots, 0, sizeof(watch_alert_slot_t) * wa->wl->cap);
+    wa->present = 0;
+}
+
+void watch_alert_set_absent_ms(watch_alert_t *wa, uint32_t absent_ms)
+{
+    wa->absent_ms = absent_ms;
+}
+
+bool watch_alert_check(watch_alert_t *wa, const scan_record_t *rec, uint32_t now_ms,
+                       watch_alert_event_t *ev)
+{
+    wa->checks++;
+
+    int idx = watchlist_find(wa->wl, rec->bssid);
+    if (idx < 0) {
+        return false;
+    }
+    wa->hits++;
+
+    watch_alert_slot_t *slot = &wa->slots[idx];
+    slot->last_seen_ms = now_ms;
+    slot->rssi = rec->rssi;
+    slot->channel = rec->channel;
+    if (slot->present) {
+        return false;
+    }
+
+    slot->present = 1;
+    wa->present++;
+
+    ev->kind = WATCH_ALERT_APPEAR;
+    memcpy(ev->bssid, rec->bssid, sizeof(ev->bssid));
+    ev->rssi = rec->rssi;
+    ev->channel = rec->channel;
+    return true;
+}
+
+size_t watch_alert_expire(watch_alert_t *wa, uint32_t now_ms, watch_alert_event_t *evs, size_t max)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < wa->wl->count && wa->present > 0 && n < max; i++) {
+        watch_alert_slot_t *slot = &wa->slots[i];
+        // Unsigned difference stays correct across the 49-day wrap
+        if (!slot->present || now_ms - slot->last_seen_ms < wa->absent_ms) {
+            continue;
+        }
+
+        slot->present = 0;
+        wa->present--;
+
+        watch_alert_event_t *ev = &evs[n++];
+        ev->kind = WATCH_ALERT_DISAPPEAR;
+        memcpy(ev->bssid, wa->wl->entries[i], sizeof(ev->bssid));
+        ev->rssi = slot->rssi;
+        ev->channel = slot->channel;
+    }
+
+    return n;
+}
+
+size_t watch_alert_encode(const watch_alert_event_t *ev, uint8_t *out, size_t cap)
+{
+    if (cap < WATCH_ALERT_WIRE_LEN) {
+        return 0;
+    }
+
+    out[0] = ev->kind;
+    memcpy(&out[1], ev->bssid, 6);
+    out[7] = (uint8_t)ev->rssi;
+    out[8] = ev->channel;
+    return WATCH_ALERT_WIRE_LEN;
+}
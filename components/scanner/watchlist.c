@@ -0,0 +1,161 @@
+#include <string.h>
+
+#include "scan_record.h"
+#include "watchlist.h"
+
+// Bloom probes per BSSID
+#define BLOOM_K 3
+
+void watchlist_init(watchlist_t *wl, uint8_t (*storage)[6], size_t cap)
+{
+    wl->entries = storage;
+    wl->count = 0;
+    wl->cap = cap;
+    wl->bloom = NULL;
+    wl->bloom_mask = 0;
+}
+
+static uint32_t bssid_hash(const uint8_t bssid[6])
+{
+    // The low three bytes carry most of the entropy; fold all six anyway
+    uint32_t h = ((uint32_t)bssid[2] << 24) | ((uint32_t)bssid[3] << 16) |
+                 ((uint32_t)bssid[4] << 8) | bssid[5];
+    h ^= ((uint32_t)bssid[0] << 8 | bssid[1]) * 0x9E3779B1u;
+
+    // murmur3 finalizer
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static void bloom_set(watchlist_t *wl, const uint8_t bssid[6])
+{
+    uint32_t h = bssid_hash(bssid);
+    uint32_t step = (h >> 17) | (h << 15) | 1;
+
+    for (int i = 0; i < BLOOM_K; i++, h += step) {
+        uint32_t bit = h & wl->bloom_mask;
+        wl->bloom[bit >> 3] |= 1u << (bit & 7);
+    }
+}
+
+void watchlist_attach_bloom(watchlist_t *wl, uint8_t *bits, size_t bytes)
+{
+    wl->bloom = bits;
+    wl->bloom_mask = (uint32_t)(bytes * 8 - 1);
+    memset(bits, 0, bytes);
+
+    for (size_t i = 0; i < wl->count; i++) {
+        bloom_set(wl, wl->entries[i]);
+    }
+}
+
+void watchlist_clear(watchlist_t *wl)
+{
+    wl->count = 0;
+    if (wl->bloom) {
+        memset(wl->bloom, 0, wl->bloom_mask / 8 + 1);
+    }
+}
+
+bool watchlist_may_contain(const watchlist_t *wl, const uint8_t bssid[6])
+{
+    if (!wl->bloom) {
+        return true;
+    }
+
+    uint32_t h = bssid_hash(bssid);
+    uint32_t step = (h >> 17) | (h << 15) | 1;
+
+    for (int i = 0; i < BLOOM_K; i++, h += step) {
+        uint32_t bit = h & wl->bloom_mask;
+        if (!(wl->bloom[bit >> 3] & (1u << (bit & 7)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool watchlist_add(watchlist_t *wl, const uint8_t bssid[6])
+{
+    // Binary search for the insertion point keeps the array sorted
+    size_t lo = 0;
+    size_t hi = wl->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = memcmp(wl->entries[mid], bssid, 6);
+        if (cmp == 0) {
+            return true;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (wl->count >= wl->cap) {
+        return false;
+    }
+    memmove(wl->entries[lo + 1], wl->entries[lo], (wl->count - lo) * 6);
+    memcpy(wl->entries[lo], bssid, 6);
+    wl->count++;
+    if (wl->bloom) {
+        bloom_set(wl, bssid);
+    }
+
+    return true;
+}
+
+size_t watchlist_add_list(watchlist_t *wl, const char *list)
+{
+    size_t added = 0;
+    const char *p = list;
+
+    while (*p) {
+        while (*p == ',' || *p == ' ' || *p == ';') {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+
+        uint8_t mac[6];
+        if (scan_record_parse_mac(p, mac) && watchlist_add(wl, mac)) {
+            added++;
+        }
+        while (*p && *p != ',' && *p != ' ' && *p != ';') {
+            p++;
+        }
+    }
+
+    return added;
+}
+
+int watchlist_find(const watchlist_t *wl, const uint8_t bssid[6])
+{
+    if (!watchlist_may_contain(wl, bssid)) {
+        return -1;
+    }
+
+    size_t lo = 0;
+    size_t hi = wl->count;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = memcmp(wl->entries[mid], bssid, 6);
+        if (cmp == 0) {
+            return (int)mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return -1;
+}
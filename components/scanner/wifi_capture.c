@@ -0,0 +1,183 @@
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+
+#include "ieee80211_parse.h"
+#include "wifi_capture.h"
+
+static const char *TAG = "WIFI_CAPTURE";
+
+#define CAPTURE_MAX_CHANNEL     13
+// Channels with no beacons in the last pass are only revisited every Nth pass
+#define IDLE_CHANNEL_PERIOD     4
+
+static wifi_capture_config_t capture_cfg;
+static wifi_capture_stats_t capture_stats;
+static esp_timer_handle_t hop_timer = NULL;
+static volatile uint8_t current_channel = 1;
+static volatile uint16_t channel_hits[CAPTURE_MAX_CHANNEL + 1];
+static uint16_t busy_mask = 0;
+static uint32_t pass_count = 0;
+
+/* ===================== FRAME CALLBACK ===================== */
+static void capture_rx_cb(void *buf, wifi_promiscuous_pkt_type_t type)
+{
+    if (type != WIFI_PKT_MGMT) {
+        return;
+    }
+
+    const wifi_promiscuous_pkt_t *pkt = buf;
+    capture_stats.frames++;
+
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t bss;
+    if (!ieee80211_parse_mgmt(pkt->payload, pkt->rx_ctrl.sig_len, true, &mgmt)) {
+        capture_stats.malformed++;
+        return;
+    }
+    if (mgmt.subtype == IEEE80211_STYPE_PROBE_REQ) {
+        capture_stats.probe_reqs++;
+        if (capture_cfg.probe_req_cb) {
+            capture_cfg.probe_req_cb(&mgmt, pkt->rx_ctrl.rssi, capture_cfg.probe_req_arg);
+        }
+        return;
+    }
+    if (!ieee80211_parse_bss(&mgmt, &bss)) {
+        return;     // not a beacon or probe response
+    }
+
+    if (mgmt.subtype == IEEE80211_STYPE_BEACON) {
+        capture_stats.beacons++;
+    } else {
+        capture_stats.probe_resps++;
+    }
+
+    scan_record_t rec = {
+        .rssi = pkt->rx_ctrl.rssi,
+        .channel = ieee80211_bss_channel(&bss, current_channel),
+        .authmode = bss.security,
+        .ssid_len = bss.ssid_len,
+    };
+    memcpy(rec.bssid, mgmt.bssid, sizeof(rec.bssid));
+    memcpy(rec.ssid, bss.ssid, bss.ssid_len);
+    rec.ssid[bss.ssid_len] = '\0';
+
+    if (rec.channel <= CAPTURE_MAX_CHANNEL) {
+        channel_hits[rec.channel]++;
+    }
+
+    if (capture_cfg.bss_cb) {
+        capture_cfg.bss_cb(&rec, capture_cfg.bss_arg);
+    }
+
+    // This runs in the Wi-Fi task: drop the sample rather than stall it
+    if (xSemaphoreTake(capture_cfg.table_lock, 0) != pdTRUE) {
+        capture_stats.lock_misses++;
+        return;
+    }
+    ap_table_update(capture_cfg.table, &rec, esp_timer_get_time());
+    xSemaphoreGive(capture_cfg.table_lock);
+}
+
+/* ===================== CHANNEL HOPPING ===================== */
+static bool channel_wanted(uint8_t ch)
+{
+    if (!(capture_cfg.channel_mask & (1 << ch))) {
+        return false;
+    }
+    // Busy channels every pass, idle ones often enough to notice new APs
+    return (busy_mask & (1 << ch)) || (pass_count % IDLE_CHANNEL_PERIOD) == 0;
+}
+
+static void hop_timer_cb(void *arg)
+{
+    uint8_t ch = current_channel;
+
+    for (int tries = 0; tries < CAPTURE_MAX_CHANNEL * 2; tries++) {
+        if (++ch > CAPTURE_MAX_CHANNEL) {
+            ch = 1;
+            pass_count++;
+
+            // Rebuild the busy set from what the last pass actually heard
+            busy_mask = 0;
+            for (int c = 1; c <= CAPTURE_MAX_CHANNEL; c++) {
+                if (channel_hits[c]) {
+                    busy_mask |= 1 << c;
+                }
+                channel_hits[c] = 0;
+            }
+        }
+        if (channel_wanted(ch)) {
+            break;
+        }
+    }
+
+    if (ch != current_channel) {
+        current_channel = ch;
+        esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE);
+        capture_stats.hops++;
+    }
+}
+
+/* ===================== PUBLIC API ===================== */
+esp_err_t wifi_capture_start(const wifi_capture_config_t *cfg)
+{
+    if (!cfg->table || !cfg->table_lock || cfg->dwell_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (hop_timer) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    capture_cfg = *cfg;
+    if ((capture_cfg.channel_mask & 0x3FFE) == 0) {
+        capture_cfg.channel_mask = 0x3FFE;     // channels 1..13
+    }
+    memset(&capture_stats, 0, sizeof(capture_stats));
+    busy_mask = 0;
+    pass_count = 0;
+
+    const wifi_promiscuous_filter_t filter = {
+        .filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT,
+    };
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous_filter(&filter));
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous_rx_cb(capture_rx_cb));
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
+
+    current_channel = 1;
+    esp_wifi_set_channel(current_channel, WIFI_SECOND_CHAN_NONE);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = hop_timer_cb,
+        .name = "chan_hop",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &hop_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(hop_timer, capture_cfg.dwell_ms * 1000ULL));
+
+    ESP_LOGI(TAG, "Passive capture started (dwell %d ms)", capture_cfg.dwell_ms);
+    return ESP_OK;
+}
+
+esp_err_t wifi_capture_stop(void)
+{
+    if (!hop_timer) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_timer_stop(hop_timer);
+    esp_timer_delete(hop_timer);
+    hop_timer = NULL;
+
+    esp_wifi_set_promiscuous(false);
+    esp_wifi_set_promiscuous_rx_cb(NULL);
+
+    ESP_LOGI(TAG, "Passive capture stopped");
+    return ESP_OK;
+}
+
+void wifi_capture_get_stats(wifi_capture_stats_t *stats)
+{
+    *stats = capture_stats;
+}
@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+
+#include "scan_record_wifi.h"
+#include "scan_sched.h"
+#include "wifi_tracker.h"
+
+static const char *TAG = "WIFI_TRACKER";
+
+#define TRACKER_MAX_CHANNEL     14
+#define TRACKER_MAX_RECORDS     16
+#define SWEEP_MAX_RECORDS       32
+// Targeted scans in a row without a sighting before we go looking for it
+#define TRACKER_MISS_LIMIT      8
+
+typedef struct {
+    uint8_t channel;            // 0 until a sweep finds it
+    uint8_t misses;
+} target_state_t;
+
+static wifi_tracker_config_t tracker_cfg;
+static wifi_tracker_stats_t tracker_stats;
+static target_state_t *targets = NULL;
+static bool sweep_requested = true;
+static scan_sched_job_t *round_job = NULL;
+
+/* ===================== RESULT HANDLING ===================== */
+static void handle_records(const wifi_ap_record_t *aps, uint16_t n, uint8_t scanned_channel)
+{
+    int64_t now = esp_timer_get_time();
+
+    for (int i = 0; i < n; i++) {
+        scan_record_t rec;
+        scan_record_from_wifi(&aps[i], &rec);
+
+        xSemaphoreTake(tracker_cfg.table_lock, portMAX_DELAY);
+        ap_table_update(tracker_cfg.table, &rec, now);
+        xSemaphoreGive(tracker_cfg.table_lock);
+
+        if (tracker_cfg.on_record) {
+            tracker_cfg.on_record(&rec, tracker_cfg.arg);
+        }
+
+        int idx = watchlist_find(tracker_cfg.watchlist, rec.bssid);
+        if (idx < 0) {
+            continue;
+        }
+
+        if (targets[idx].channel != rec.channel) {
+            ESP_LOGI(TAG, "Target %02x:%02x:%02x:%02x:%02x:%02x on channel %d",
+                     rec.bssid[0], rec.bssid[1], rec.bssid[2], rec.bssid[3], rec.bssid[4],
+                     rec.bssid[5], rec.channel);
+        }
+        targets[idx].channel = rec.channel;
+        targets[idx].misses = 0;
+        tracker_stats.hits++;
+
+        if (tracker_cfg.on_update) {
+            tracker_cfg.on_update(&rec, tracker_cfg.arg);
+        }
+    }
+
+    // Anything expected on this channel that did not answer counts a miss
+    if (scanned_channel == 0) {
+        return;
+    }
+    for (size_t t = 0; t < tracker_cfg.watchlist->count; t++) {
+        if (targets[t].channel != scanned_channel) {
+            continue;
+        }
+        bool seen = false;
+        for (int i = 0; i < n && !seen; i++) {
+            seen = memcmp(aps[i].bssid, tracker_cfg.watchlist->entries[t], 6) == 0;
+        }
+        if (!seen && ++targets[t].misses >= TRACKER_MISS_LIMIT) {
+            // Probably moved channel: forget it and let a sweep relocate it
+            targets[t].channel = 0;
+            targets[t].misses = 0;
+            sweep_requested = true;
+        }
+    }
+}
+
+/* ===================== SCANS ===================== */
+static void full_sweep(void)
+{
+    static wifi_ap_record_t aps[SWEEP_MAX_RECORDS];
+    const wifi_scan_config_t scan_config = {
+        .show_hidden = true,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = tracker_cfg.dwell_ms,
+        .scan_time.active.max = tracker_cfg.dwell_ms * 2,
+    };
+
+    if (esp_wifi_scan_start(&scan_config, true) != ESP_OK) {
+        return;
+    }
+    uint16_t n = SWEEP_MAX_RECORDS;
+    esp_wifi_scan_get_ap_records(&n, aps);
+
+    tracker_stats.sweeps++;
+    handle_records(aps, n, 0);
+}
+
+static void targeted_scan(uint8_t channel)
+{
+    static wifi_ap_record_t aps[TRACKER_MAX_RECORDS];
+    const uint8_t *only_bssid = NULL;
+    int on_channel = 0;
+
+    for (size_t t = 0; t < tracker_cfg.watchlist->count; t++) {
+        if (targets[t].channel == channel) {
+            only_bssid = tracker_cfg.watchlist->entries[t];
+            on_channel++;
+        }
+    }
+
+    // A single target lets the driver filter by BSSID as well as channel
+    wifi_scan_config_t scan_config = {
+        .bssid = on_channel == 1 ? (uint8_t *)only_bssid : NULL,
+        .channel = channel,
+        .show_hidden = true,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = tracker_cfg.dwell_ms / 2,
+        .scan_time.active.max = tracker_cfg.dwell_ms,
+    };
+
+    if (esp_wifi_scan_start(&scan_config, true) != ESP_OK) {
+        return;
+    }
+    uint16_t n = TRACKER_MAX_RECORDS;
+    esp_wifi_scan_get_ap_records(&n, aps);
+
+    tracker_stats.targeted_scans++;
+    handle_records(aps, n, channel);
+}
+
+/* ===================== TRACKER TASK ===================== */
+static void wifi_tracker_task(void *arg)
+{
+    int64_t next_sweep_us = 0;
+
+    while (1) {
+        int64_t now = esp_timer_get_time();
+        if (sweep_requested || now >= next_sweep_us) {
+            sweep_requested = false;
+            full_sweep();
+            next_sweep_us = esp_timer_get_time() + tracker_cfg.sweep_period_ms * 1000LL;
+        }
+
+        uint16_t channels = 0;
+        for (size_t t = 0; t < tracker_cfg.watchlist->count; t++) {
+            if (targets[t].channel > 0 && targets[t].channel <= TRACKER_MAX_CHANNEL) {
+                channels |= 1 << targets[t].channel;
+            }
+        }
+        for (int ch = 1; ch <= TRACKER_MAX_CHANNEL; ch++) {
+            if (channels & (1 << ch)) {
+                targeted_scan(ch);
+            }
+        }
+        tracker_stats.rounds++;
+
+        // A round that overran starts the next at once, then back on the grid
+        if (scan_sched_wait(round_job) > 0) {
+            tracker_stats.overruns++;
+        }
+    }
+}
+
+/* ===================== PUBLIC API ===================== */
+esp_err_t wifi_tracker_start(const wifi_tracker_config_t *cfg)
+{
+    if (!cfg->watchlist || cfg->watchlist->count == 0 || !cfg->table || !cfg->table_lock ||
+        cfg->rate_hz == 0 || cfg->dwell_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (targets) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Exact 1/rate_hz rounds; tick delays would round 8 Hz to 120 ms
+    round_job = scan_sched_add("track", 1000000 / cfg->rate_hz, NULL, NULL);
+    if (!round_job) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    targets = calloc(cfg->watchlist->count, sizeof(target_state_t));
+    if (!targets) {
+        return ESP_ERR_NO_MEM;
+    }
+    tracker_cfg = *cfg;
+
+    xTaskCreate(wifi_tracker_task, "wifi_tracker", 4096, NULL, 5, NULL);
+
+    ESP_LOGI(TAG, "Tracking %d BSSIDs at %d Hz, sweep every %lu ms",
+             (int)cfg->watchlist->count, cfg->rate_hz, (unsigned long)cfg->sweep_period_ms);
+    return ESP_OK;
+}
+
+void wifi_tracker_get_stats(wifi_tracker_stats_t *stats)
+{
+    *stats = tracker_stats;
+}
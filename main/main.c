@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "freertos/FreeRTOS.h"
@@ -10,12 +11,59 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_netif.h"
+#include "sdkconfig.h"
+
+#include "esp_timer.h"
+
+#include "channel_stats.h"
+#include "dlog.h"
+#include "fp_db.h"
+#include "power_mgr.h"
+#include "scan_cache.h"
+#include "scan_fusion_wifi.h"
+#include "scan_interval.h"
+#include "scan_record.h"
+#include "scan_record_wifi.h"
+#include "scan_sched.h"
+#include "stream_frame.h"
+#include "synth_load.h"
+#if CONFIG_SCANNER_STREAM_ENABLE
+#include "scan_stream.h"
+#endif
 
 static const char *TAG = "WIFI_BLE_SCANNER";
 
+#define MAX_SCAN_RECORDS 20
+// Union of the sub-scans; the strongest MAX_SCAN_RECORDS are reported
+#define FUSION_MAX_APS 48
+
 // Global state variables
 static bool event_loop_initialized = false;
 static esp_netif_t *sta_netif = NULL;
+static scan_record_t scan_records[MAX_SCAN_RECORDS];
+static uint16_t scan_record_count = 0;
+static SemaphoreHandle_t sta_started = NULL;
+static bool first_data_logged = false;
+#if CONFIG_SCANNER_FP_ENABLE
+static uint32_t *fp_acc = NULL;     // match scratch, one word per fingerprint
+#endif
+
+/* ===================== EVENTS ===================== */
+static void wifi_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data)
+{
+    if (base == WIFI_EVENT && id == WIFI_EVENT_STA_START) {
+        xSemaphoreGive(sta_started);
+    }
+}
+
+static void log_first_data(const char *source)
+{
+    if (!first_data_logged) {
+        first_data_logged = true;
+        ESP_LOGI(TAG, "Time to first data: %lld ms (%s)",
+                 (long long)(esp_timer_get_time() / 1000), source);
+    }
+}
 
 /* ===================== RADIO CONTROL FUNCTIONS ===================== */
 void stop_all_radio(void)
@@ -41,7 +89,7 @@ void stop_all_radio(void)
 
 esp_err_t init_wifi_for_scan(void)
 {
-    ESP_LOGI(TAG, "Initializing WiFi for scanning...");
+    int64_t t0 = esp_timer_get_time();
     
     // Make sure WiFi is stopped first
     esp_wifi_stop();
@@ -52,6 +100,9 @@ esp_err_t init_wifi_for_scan(void)
     if (!event_loop_initialized) {
         ESP_ERROR_CHECK(esp_netif_init());
         ESP_ERROR_CHECK(esp_event_loop_create_default());
+        sta_started = xSemaphoreCreateBinary();
+        ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_START,
+                                                   wifi_event_handler, NULL));
         event_loop_initialized = true;
         ESP_LOGI(TAG, "Event loop initialized");
     }
@@ -67,114 +118,307 @@ esp_err_t init_wifi_for_scan(void)
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    xSemaphoreTake(sta_started, 0);
     ESP_ERROR_CHECK(esp_wifi_start());
     
-    vTaskDelay(pdMS_TO_TICKS(2000)); // Give WiFi time to initialize
-    ESP_LOGI(TAG, "WiFi initialized for scanning");
+    // STA_START means the driver is ready to scan, usually within tens of ms
+    if (xSemaphoreTake(sta_started, pdMS_TO_TICKS(2000)) != pdTRUE) {
+        DLOG(WIFI_NO_START);
+    }
+    DLOG(WIFI_UP, (esp_timer_get_time() - t0) / 1000);
     
     return ESP_OK;
 }
 
-esp_err_t perform_wifi_scan(char *result_buffer, size_t buffer_size)
+#if CONFIG_SCANNER_STREAM_ENABLE
+/* ===================== BINARY STREAM ===================== */
+static esp_err_t stream_scan_results(const scan_record_t *records, uint16_t count_in, uint8_t flags)
 {
-    ESP_LOGI(TAG, "Performing WiFi scan...");
-    
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = true,
-        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-        .scan_time.active.min = 100,
-        .scan_time.active.max = 300
-    };
-    
-    esp_err_t ret = esp_wifi_scan_start(&scan_config, true);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Scan start failed: %s", esp_err_to_name(ret));
-        return ret;
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    size_t len = 2;
+    uint8_t count = 0;
+
+    for (int i = 0; i < count_in; i++) {
+        size_t n = scan_record_encode(&records[i], payload + len, sizeof(payload) - len);
+        if (n == 0) {
+            break;
+        }
+        len += n;
+        count++;
     }
-    
-    uint16_t ap_count = 0;
-    ret = esp_wifi_scan_get_ap_num(&ap_count);
+    payload[0] = count;
+    payload[1] = SCAN_RECORD_WIRE_MASK;
+
+    return scan_stream_send(STREAM_FRAME_AP_BATCH, flags, payload, len);
+}
+
+static esp_err_t stream_channel_stats(const channel_stats_t *cs)
+{
+    channel_stat_t stats[CHANNEL_STATS_MAX + 1];
+    uint8_t payload[CHANNEL_STATS_WIRE_LEN];
+
+    channel_stats_finish(cs, stats);
+    size_t len = channel_stats_encode(stats, payload, sizeof(payload));
+
+    return scan_stream_send(STREAM_FRAME_CHANNEL_HIST, 0, payload, len);
+}
+
+static void stream_duty(const stage_duty_summary_t *s, void *arg)
+{
+    uint8_t payload[STAGE_DUTY_WIRE_LEN];
+    size_t len = stage_duty_encode(s, payload, sizeof(payload));
+
+    scan_stream_send(STREAM_FRAME_DUTY, 0, payload, len);
+}
+
+static bool stream_dlog(const uint8_t *payload, size_t len, void *arg)
+{
+    return scan_stream_send(STREAM_FRAME_LOG, 0, payload, len) == ESP_OK;
+}
+
+#if CONFIG_SCANNER_FP_ENABLE
+static esp_err_t stream_location(const fp_result_t *r)
+{
+    uint8_t payload[FP_WIRE_MAX_LEN];
+    size_t len = fp_result_encode(r, payload, sizeof(payload));
+
+    return scan_stream_send(STREAM_FRAME_LOCATION, 0, payload, len);
+}
+#endif
+#endif
+
+esp_err_t perform_wifi_scan(void)
+{
+    static scan_fusion_entry_t fusion_storage[FUSION_MAX_APS];
+    static scan_fusion_ap_t fused[MAX_SCAN_RECORDS];
+    scan_fusion_t fusion;
+    const scan_fusion_wifi_config_t fusion_cfg = {
+        .scans = CONFIG_SCANNER_FUSION_SCANS,
+        .dwell_ms = CONFIG_SCANNER_FUSION_DWELL_MS,
+        .gap_ms = CONFIG_SCANNER_FUSION_GAP_MS,
+    };
+
+    // Several short scans instead of one long one; see scan_fusion.h
+    scan_fusion_init(&fusion, fusion_storage, FUSION_MAX_APS);
+    esp_err_t ret = scan_fusion_wifi_run(&fusion, &fusion_cfg, NULL);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Get AP count failed: %s", esp_err_to_name(ret));
+        DLOG(SCAN_FAILED, ret);
         return ret;
     }
-    
-    if (ap_count == 0) {
-        snprintf(result_buffer, buffer_size, "No networks found");
-        ESP_LOGI(TAG, "No networks found");
+
+    uint16_t ap_num = scan_fusion_report(&fusion, esp_timer_get_time(), fused, MAX_SCAN_RECORDS);
+    if (ap_num == 0) {
+        scan_record_count = 0;
+        DLOG(SCAN_DONE, 0, fusion.scans);
         return ESP_OK;
     }
-    
-    // Limit to reasonable number
-    uint16_t ap_num = (ap_count > 20) ? 20 : ap_count;
-    wifi_ap_record_t ap_records[ap_num];
-    memset(ap_records, 0, sizeof(ap_records));
-    
-    ret = esp_wifi_scan_get_ap_records(&ap_num, ap_records);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Get AP records failed: %s", esp_err_to_name(ret));
-        return ret;
+    if (fusion.dropped > 0) {
+        DLOG(FUSION_DROPPED, fusion.dropped, FUSION_MAX_APS);
     }
-    
-    // Format results
-    char *ptr = result_buffer;
-    int remaining = buffer_size;
-    
-    int written = snprintf(ptr, remaining, "Found %d networks:\n", ap_num);
-    if (written > 0) {
-        ptr += written;
-        remaining -= written;
+
+    power_stage_begin(DUTY_STAGE_ENCODE);
+    channel_stats_t channels;
+    channel_stats_reset(&channels);
+    for (int i = 0; i < ap_num; i++) {
+        scan_records[i] = fused[i].rec;
+        channel_stats_add(&channels, &scan_records[i]);
+    }
+    scan_record_count = ap_num;
+
+#if CONFIG_SCANNER_FP_ENABLE
+    fp_result_t where = { 0 };
+    if (fp_acc) {
+        int64_t t0 = esp_timer_get_time();
+        fp_db_locate(&fp_db_builtin, scan_records, scan_record_count, fp_acc, CONFIG_SCANNER_FP_K,
+                     &where);
+        DLOG(LOCATED, where.k ? where.match[0].loc : 0, where.k ? where.match[0].dist : 0,
+             where.heard, where.unknown, (uint32_t)(esp_timer_get_time() - t0));
+    }
+#endif
+
+#if CONFIG_SCANNER_STREAM_ENABLE
+    bool send_records = true;
+#if CONFIG_SCANNER_FP_ONLY
+    // Locations replace the records, unless matching is unavailable
+    send_records = fp_acc == NULL;
+#endif
+    // Independent frames: a dropped AP batch must not cost the histogram
+    if (send_records && stream_scan_results(scan_records, scan_record_count, 0) != ESP_OK) {
+        DLOG(STREAM_DROPPED);
+    }
+    if (stream_channel_stats(&channels) != ESP_OK) {
+        DLOG(STREAM_DROPPED);
+    }
+#if CONFIG_SCANNER_FP_ENABLE
+    if (fp_acc && stream_location(&where) != ESP_OK) {
+        DLOG(STREAM_DROPPED);
     }
+#endif
+    log_first_data("live");
+#endif
+    scan_cache_store(scan_records, scan_record_count, CONFIG_SCANNER_CACHE_NVS_PERIOD_S);
     
-    for (int i = 0; i < ap_num && remaining > 50; i++) {
-        written = snprintf(ptr, remaining, "%2d: %-32s (%3d dBm) Ch:%2d\n", 
-                          i+1, ap_records[i].ssid, ap_records[i].rssi, ap_records[i].primary);
-        if (written > 0) {
-            ptr += written;
-            remaining -= written;
-        }
+    // Results as deferred log entries; SSIDs travel in the binary stream
+    DLOG(SCAN_DONE, ap_num, fusion.scans);
+    for (int i = 0; i < ap_num; i++) {
+        const uint8_t *b = fused[i].rec.bssid;
+        DLOG(SCAN_AP, b[0] << 16 | b[1] << 8 | b[2], b[3] << 16 | b[4] << 8 | b[5],
+             fused[i].rec.rssi, fused[i].rec.channel, fused[i].seen, fused[i].scans);
     }
     
-    ESP_LOGI(TAG, "Scan complete");
+    power_stage_end(DUTY_STAGE_ENCODE);
     return ESP_OK;
 }
 
 /* ===================== MAIN TASK ===================== */
 void scanner_task(void *arg)
 {
-    char scan_results[512];
+    scan_interval_t interval_ctl;
+    const scan_interval_config_t interval_cfg = {
+        .min_ms = CONFIG_SCANNER_INTERVAL_MIN_MS,
+        .max_ms = CONFIG_SCANNER_INTERVAL_MAX_MS,
+        .rssi_delta_db = CONFIG_SCANNER_INTERVAL_RSSI_DELTA_DB,
+        .churn_threshold_permille = CONFIG_SCANNER_INTERVAL_CHURN_PERMILLE,
+    };
+    int64_t radio_on_us = 0;
+    uint32_t cycle = 0;
+    // Cycles start on absolute deadlines; the interval is start to start
+    scan_sched_job_t *job = scan_sched_add("scan", CONFIG_SCANNER_INTERVAL_MIN_MS * 1000, NULL,
+                                           NULL);
+
+    scan_interval_init(&interval_ctl, &interval_cfg);
     
     while (1) {
-        ESP_LOGI(TAG, "=== Starting scan cycle ===");
+        DLOG(SCAN_CYCLE, ++cycle);
+        int64_t cycle_start_us = esp_timer_get_time();
+        scan_record_count = 0;
         
-        // Step 1: Initialize and scan WiFi
+        // Step 1: Initialize and scan WiFi; encoding overlaps the end of it
+        power_stage_begin(DUTY_STAGE_SCAN);
         esp_err_t ret = init_wifi_for_scan();
         if (ret == ESP_OK) {
-            memset(scan_results, 0, sizeof(scan_results));
-            ret = perform_wifi_scan(scan_results, sizeof(scan_results));
+            perform_wifi_scan();
         }
         
         // Step 2: Stop WiFi after scan (but keep event loop)
         esp_wifi_stop();
         esp_wifi_deinit();
+        power_stage_end(DUTY_STAGE_SCAN);
+        power_mgr_report_done();
         vTaskDelay(pdMS_TO_TICKS(100));
+        int64_t active_us = esp_timer_get_time() - cycle_start_us;
+        radio_on_us += active_us;
         
-        // Step 3: Process and display results
-        if (strlen(scan_results) > 0) {
-            ESP_LOGI(TAG, "Scan Results:\n%s", scan_results);
-            
-            // Here you would normally send via BLE
-            // For now, just print to serial
+        // Step 3: Pick the next interval from how much the environment moved
+        scan_interval_update(&interval_ctl, scan_records, scan_record_count);
+        // Start to start, leaving at least the minimum idle after this cycle
+        uint32_t interval_ms = scan_interval_period(&interval_ctl, active_us / 1000);
+        // Duty cycle up to the next start, against the old fixed 30 s between scans
+        int64_t total_us = interval_ctl.elapsed_ms * 1000LL;
+        int64_t fixed_idle_us = (int64_t)interval_ctl.scans * 30000 * 1000;
+        uint32_t duty = 1000 * radio_on_us / (total_us > radio_on_us ? total_us : radio_on_us);
+        uint32_t fixed_duty = 1000 * radio_on_us / (radio_on_us + fixed_idle_us);
+        DLOG(SCAN_DUTY, interval_ctl.last_churn_permille, duty / 10, duty % 10, fixed_duty / 10,
+             fixed_duty % 10);
+        DLOG(NEXT_SCAN, interval_ms);
+        scan_sched_set_period(job, interval_ms * 1000);
+        scan_sched_wait(job);
+    }
+}
+
+#if CONFIG_SCANNER_MODE_SYNTHETIC_LOAD && CONFIG_SCANNER_STREAM_ENABLE
+/* ===================== SYNTHETIC LOAD ===================== */
+void synth_task(void *arg)
+{
+    static scan_record_t recs[CONFIG_SCANNER_SYNTH_BATCH];
+    const synth_load_config_t cfg = {
+        .rate = CONFIG_SCANNER_SYNTH_RATE,
+        .batch = CONFIG_SCANNER_SYNTH_BATCH,
+        .count = CONFIG_SCANNER_SYNTH_COUNT,
+    };
+    synth_load_t gen;
+    uint32_t drops = 0;
+
+    synth_load_init(&gen, &cfg, esp_timer_get_time());
+    ESP_LOGI(TAG, "Synthetic load: %d records/s in batches of %d",
+             CONFIG_SCANNER_SYNTH_RATE, CONFIG_SCANNER_SYNTH_BATCH);
+
+    while (!synth_load_done(&gen)) {
+        // Everything due goes out back to back, so rates above one batch
+        // per tick still average out right
+        while (!synth_load_done(&gen) && synth_load_due_us(&gen) <= esp_timer_get_time()) {
+            size_t n = synth_load_next(&gen, recs, esp_timer_get_time());
+            if (stream_scan_results(recs, n, STREAM_FLAG_SYNTHETIC) != ESP_OK) {
+                drops++;
+            }
         }
-        
-        // Wait before next scan
-        ESP_LOGI(TAG, "Waiting 30 seconds before next scan...\n");
-        vTaskDelay(pdMS_TO_TICKS(30000));
+
+        // Always give up at least one tick so a rate we can't sustain
+        // drops frames instead of starving the idle task
+        int64_t wait_ms = (synth_load_due_us(&gen) - esp_timer_get_time()) / 1000;
+        TickType_t ticks = pdMS_TO_TICKS(wait_ms);
+        vTaskDelay(ticks > 0 ? ticks : 1);
     }
+
+    scan_stream_stats_t st;
+    scan_stream_get_stats(&st);
+    ESP_LOGI(TAG, "Synthetic load done: %lu records, %lu frames dropped, %lu bytes sent",
+             (unsigned long)gen.next_seq, (unsigned long)drops, (unsigned long)st.bytes_sent);
+    vTaskDelete(NULL);
 }
+#endif
+
+/* ===================== POWER ===================== */
+static void power_init(void)
+{
+    power_mgr_config_t cfg = {
+        .report_s = CONFIG_SCANNER_PM_REPORT_S,
+#if CONFIG_SCANNER_STREAM_ENABLE
+        .on_report = stream_duty,
+#endif
+    };
+#if CONFIG_SCANNER_PM_ENABLE
+    cfg.max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    cfg.min_freq_mhz = CONFIG_SCANNER_PM_MIN_FREQ_MHZ;
+#if CONFIG_SCANNER_PM_LIGHT_SLEEP
+    cfg.light_sleep = true;
+#endif
+#endif
+
+    if (power_mgr_init(&cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Power management unavailable");
+    }
+}
+
+/* ===================== DEFERRED LOG ===================== */
+static void dlog_init(void)
+{
+    const dlog_config_t cfg = {
+#if CONFIG_SCANNER_STREAM_ENABLE
+        .sink = stream_dlog,
+#endif
+    };
+
+    if (dlog_start(&cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Deferred log unavailable");
+    }
+}
+
+#if CONFIG_SCANNER_FP_ENABLE
+/* ===================== POSITIONING ===================== */
+static void fp_init(void)
+{
+    const fp_db_t *db = &fp_db_builtin;
+
+    fp_acc = malloc(db->n_fps * sizeof(*fp_acc));
+    if (!fp_acc) {
+        ESP_LOGW(TAG, "Fingerprint matching unavailable");
+        return;
+    }
+    ESP_LOGI(TAG, "Fingerprints: %u over %u BSSIDs, %u bytes of flash, survey %08lx",
+             db->n_fps, db->n_bssids, (unsigned)fp_db_footprint(db), (unsigned long)db->version);
+}
+#endif
 
 /* ===================== MAIN ===================== */
 void app_main(void)
@@ -188,14 +432,37 @@ void app_main(void)
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    power_init();
+    dlog_init();
+    const scan_sched_config_t sched_cfg = {
+        .report_s = CONFIG_SCANNER_SCHED_REPORT_S,
+    };
+    ESP_ERROR_CHECK(scan_sched_init(&sched_cfg));
+#if CONFIG_SCANNER_FP_ENABLE
+    fp_init();
+#endif
+
+#if CONFIG_SCANNER_STREAM_ENABLE
+    // Binary output is optional; keep scanning with text logs if it fails
+    if (scan_stream_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Binary stream unavailable");
+    }
+
+    // Last boot's results go out immediately, flagged stale, before any radio work
+    static scan_cache_t boot_cache;
+    if (scan_cache_load(&boot_cache) == ESP_OK && boot_cache.count > 0) {
+        stream_scan_results(boot_cache.records, boot_cache.count, STREAM_FLAG_STALE);
+        log_first_data("cached");
+    }
+#endif
     
+#if CONFIG_SCANNER_MODE_SYNTHETIC_LOAD && CONFIG_SCANNER_STREAM_ENABLE
+    xTaskCreate(synth_task, "synth", 4096, NULL, 5, NULL);
+#else
     // Start scanning task
     xTaskCreate(scanner_task, "scanner", 4096, NULL, 5, NULL);
     
-    ESP_LOGI(TAG, "System started. Scanning WiFi every 30 seconds...");
-    
-    // Keep main task alive
-    while (1) {
-        vTaskDelay(pdMS_TO_TICKS(10000));
-    }
+    ESP_LOGI(TAG, "System started. Scanning WiFi every %d-%d seconds...",
+             CONFIG_SCANNER_INTERVAL_MIN_MS / 1000, CONFIG_SCANNER_INTERVAL_MAX_MS / 1000);
+#endif
 }
\ No newline at end of file
@@ -1,13 +1,19 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/ringbuf.h"
 
 #include "esp_log.h"
 #include "nvs_flash.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
 
 #include "nimble/nimble_port.h"
 #include "nimble/nimble_port_freertos.h"
@@ -16,19 +22,934 @@
 #include "services/gap/ble_svc_gap.h"
 #include "services/gatt/ble_svc_gatt.h"
 
+#include "ap_snapshot.h"
+#include "ap_table.h"
+#include "channel_stats.h"
+#include "dlog.h"
+#include "fp_db.h"
+#include "link_tuner.h"
+#include "power_mgr.h"
+#include "rssi_distance.h"
+#include "scan_cache.h"
+#include "scan_interval.h"
+#include "scan_fusion_wifi.h"
+#include "scan_record_wifi.h"
+#include "scan_sched.h"
+#include "stream_frame.h"
+#if CONFIG_SCANNER_MODE_PASSIVE_CAPTURE
+#include "wifi_capture.h"
+#endif
+#if CONFIG_SCANNER_CLIENT_COUNT
+#include "client_counter.h"
+#endif
+#if CONFIG_SCANNER_MODE_SYNTHETIC_LOAD
+#include "synth_load.h"
+#endif
+#if CONFIG_SCANNER_MODE_TRACKING
+#include "watchlist.h"
+#include "wifi_tracker.h"
+#endif
+#if CONFIG_SCANNER_ALERT_ENABLE
+#include "watch_alert.h"
+#include "watchlist.h"
+#endif
+
 static const char *TAG = "BLE_WIFI";
 
-static uint16_t conn_handle = 0;
+static uint16_t conn_handle = BLE_HS_CONN_HANDLE_NONE;
 static uint16_t notify_handle;
+static uint16_t snapshot_handle;
+static uint16_t channel_handle;
+static uint16_t alert_handle;
+
+// CCCD state; nothing is pushed on a characteristic the client did not ask for
+static volatile bool list_subscribed = false;
+static volatile bool channels_subscribed = false;
+static volatile bool alerts_subscribed = false;
 
 #define DEVICE_NAME "ESP32C3_WIFI"
 #define WIFI_SERVICE_UUID     0x180F
 #define WIFI_CHAR_UUID        0x2A19
+#define SNAPSHOT_CHAR_UUID    0xFF01
+#define CHANNEL_CHAR_UUID     0xFF02
+#define ALERT_CHAR_UUID       0xFF03
+
+// Link layer targets requested after connect: 2M PHY, full-size PDUs
+#define LINK_DLE_OCTETS       251
+#define LINK_DLE_TIME_US      2120
+#define LINK_SUPERVISION_TO   400       // 10 ms units
+#define LINK_REQUEST_GAP_MS   1000
+#define LINK_STATS_PERIOD_US  (10 * 1000 * 1000LL)
+
+#define NOTIFY_MSG_MAX        100
+#define NOTIFY_RETRY_MS       10
+
+// Alerts have their own queue, so bulk traffic can never fill it; one
+// expiry batch fits
+#if CONFIG_SCANNER_ALERT_ENABLE
+#define NOTIFY_ALERT_QUEUE_LEN 8
+#else
+#define NOTIFY_ALERT_QUEUE_LEN 1
+#endif
+
+// Entries not heard from for this long are dropped from the table
+#define AP_MAX_AGE_US         (30 * 1000 * 1000LL)
+
+// Union of the sub-scans behind one active scan report
+#define FUSION_MAX_APS        48
+
+// Capture mode has no scan boundary; rebuild the channel view this often
+#define CHANNEL_REPORT_US     (1000 * 1000LL)
+
+static ap_table_t ap_table;
+static SemaphoreHandle_t ap_table_lock;
+
+// Published copy of ap_table for GATT reads; never blocks the scanner
+static ap_snapshot_t ap_snapshot;
+
+// Latest channel histogram (channel_stats.h wire form), under ap_table_lock
+static uint8_t channel_hist[CHANNEL_STATS_WIRE_LEN];
+static size_t channel_hist_len;
+
+// Snapshot from the previous boot, served until live data exists
+static scan_cache_t boot_cache;
+static bool boot_cache_valid = false;
+static volatile bool live_data_ready = false;
+static bool first_data_logged = false;
+#if CONFIG_SCANNER_FP_ENABLE
+static uint32_t *fp_acc = NULL;     // match scratch, one word per fingerprint
+#endif
+
+#if CONFIG_SCANNER_DISTANCE_ENABLE
+static rssi_distance_cal_entry_t distance_cal_storage[CONFIG_SCANNER_DISTANCE_CAL_MAX];
+static rssi_distance_cal_t distance_cal;
+#endif
+
+#if CONFIG_SCANNER_MODE_TRACKING
+#define TRACK_MAX_BSSIDS      16
+
+static uint8_t track_storage[TRACK_MAX_BSSIDS][6];
+static watchlist_t track_list;
+#endif
+
+#if CONFIG_SCANNER_CLIENT_COUNT
+static client_counter_t client_counter;
+static SemaphoreHandle_t client_lock;
+#endif
+
+/* ===================== NOTIFY =====================
+ * Producers only enqueue; notify_tx_task owns the link. The queue depth
+ * drives the connection interval (see link_tuner.h). Alerts go on a
+ * separate queue that is drained first, so they overtake bulk traffic
+ * but stay in order among themselves.
+ */
+typedef struct {
+    uint16_t attr_handle;
+    uint8_t len;
+    char data[NOTIFY_MSG_MAX];
+} notify_item_t;
+
+static QueueHandle_t notify_queue;
+static QueueHandle_t alert_queue;
+static QueueSetHandle_t notify_set;
+static link_tuner_t link_tuner;
+
+static void notify_enqueue(uint16_t attr_handle, const void *data, size_t len)
+{
+    notify_item_t item;
+    item.attr_handle = attr_handle;
+    item.len = len < NOTIFY_MSG_MAX ? len : NOTIFY_MSG_MAX;
+    memcpy(item.data, data, item.len);
+
+    // Never stall a scanner on a slow link
+    if (xQueueSend(notify_queue, &item, 0) != pdTRUE) {
+        link_tuner.stats.drops++;
+    }
+}
+
+#if CONFIG_SCANNER_ALERT_ENABLE
+static void notify_enqueue_urgent(uint16_t attr_handle, const void *data, size_t len)
+{
+    notify_item_t item;
+    item.attr_handle = attr_handle;
+    item.len = len < NOTIFY_MSG_MAX ? len : NOTIFY_MSG_MAX;
+    memcpy(item.data, data, item.len);
+
+    if (xQueueSend(alert_queue, &item, 0) != pdTRUE) {
+        link_tuner.stats.drops++;
+    }
+}
+#endif
+
+static void notify_msg(const char *msg)
+{
+    if (conn_handle == BLE_HS_CONN_HANDLE_NONE || !list_subscribed) {
+        return;
+    }
+
+    if (!first_data_logged) {
+        first_data_logged = true;
+        ESP_LOGI(TAG, "Time to first data: %lld ms (%s)", (long long)(esp_timer_get_time() / 1000),
+                 live_data_ready ? "live" : "cached");
+    }
+
+    notify_enqueue(notify_handle, msg, strlen(msg));
+}
+
+static void notify_record(const scan_record_t *rec)
+{
+    char msg[100];
+    uint32_t distance_cm = rec->distance_cm;
+
+    if (distance_cm) {
+        snprintf(msg, sizeof(msg), "%s | RSSI: %d | ~%lu.%lu m\n", rec->ssid, rec->rssi,
+                 (unsigned long)(distance_cm / 100), (unsigned long)(distance_cm % 100 / 10));
+    } else {
+        snprintf(msg, sizeof(msg), "%s | RSSI: %d\n", rec->ssid, rec->rssi);
+    }
+    notify_msg(msg);
+}
+
+static void notify_send(uint16_t conn, const notify_item_t *item)
+{
+    while (conn != BLE_HS_CONN_HANDLE_NONE && conn == conn_handle) {
+        // The stack consumes om whatever the outcome
+        struct os_mbuf *om = ble_hs_mbuf_from_flat(item->data, item->len);
+        if (om) {
+            int rc = ble_gatts_notify_custom(conn, item->attr_handle, om);
+            if (rc == 0) {
+                link_tuner_on_sent(&link_tuner, item->len);
+                return;
+            }
+            if (rc != BLE_HS_ENOMEM) {
+                break;
+            }
+        }
+
+        // Out of mbufs: the controller is still draining earlier PDUs
+        link_tuner.stats.retries++;
+        vTaskDelay(pdMS_TO_TICKS(NOTIFY_RETRY_MS));
+    }
+
+    link_tuner.stats.drops++;
+}
+
+static void link_request_interval(uint16_t conn, uint16_t itvl)
+{
+    // A little slack above the minimum keeps iOS centrals from refusing
+    struct ble_gap_upd_params params = {
+        .itvl_min = itvl,
+        .itvl_max = itvl + 12,
+        .latency = 0,
+        .supervision_timeout = LINK_SUPERVISION_TO,
+    };
+
+    int rc = ble_gap_update_params(conn, &params);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "Connection update to %u failed: %d", itvl, rc);
+    }
+}
+
+static void notify_tx_task(void *arg)
+{
+    notify_item_t item;
+    int64_t next_stats_us = esp_timer_get_time() + LINK_STATS_PERIOD_US;
+
+    while (1) {
+        // The timeout keeps the tuner ticking while the queues are idle.
+        // The set holds one entry per queued item, whichever queue woke
+        // us, so taking exactly one item per wakeup keeps it in step.
+        bool have = xQueueSelectFromSet(notify_set, pdMS_TO_TICKS(250)) != NULL &&
+                    (xQueueReceive(alert_queue, &item, 0) == pdTRUE ||
+                     xQueueReceive(notify_queue, &item, 0) == pdTRUE);
+        int64_t now = esp_timer_get_time();
+        uint16_t conn = conn_handle;
+
+        if (conn != BLE_HS_CONN_HANDLE_NONE) {
+            size_t depth = uxQueueMessagesWaiting(notify_queue) +
+                           uxQueueMessagesWaiting(alert_queue) + (have ? 1 : 0);
+            uint16_t itvl = link_tuner_update(&link_tuner, depth, now);
+            if (itvl) {
+                link_request_interval(conn, itvl);
+            }
+        }
+
+        if (have) {
+            power_stage_begin(DUTY_STAGE_TX);
+            notify_send(conn, &item);
+            power_stage_end(DUTY_STAGE_TX);
+        }
+
+        if (conn != BLE_HS_CONN_HANDLE_NONE && now >= next_stats_us) {
+            const link_tuner_stats_t *st = &link_tuner.stats;
+            ESP_LOGI(TAG, "Link: %lu B/s, %lu msgs, %lu retries, %lu drops, interval %u.%02u ms",
+                     (unsigned long)st->bytes_per_s, (unsigned long)st->msgs,
+                     (unsigned long)st->retries, (unsigned long)st->drops,
+                     st->conn_itvl * 125 / 100, st->conn_itvl * 125 % 100);
+            next_stats_us = now + LINK_STATS_PERIOD_US;
+        }
+    }
+}
+
+static void notify_boot_cache(void)
+{
+    char msg[100];
+
+    // Only useful until the first live scan lands
+    if (!boot_cache_valid || live_data_ready) {
+        return;
+    }
+
+    for (int i = 0; i < boot_cache.count; i++) {
+        snprintf(msg, sizeof(msg), "[stale] %s | RSSI: %d\n",
+                 boot_cache.records[i].ssid, boot_cache.records[i].rssi);
+        notify_msg(msg);
+    }
+}
+
+#if CONFIG_SCANNER_BLE_L2CAP
+/* ===================== L2CAP BULK =====================
+ * Optional connection-oriented channel for bulk data: the binary stream
+ * (stream_frame.h, COBS framed) that the serial firmware writes to its
+ * UART, so the same host tools read it. Credit-based flow control paces
+ * the sender, and SDUs of up to CONFIG_SCANNER_BLE_L2CAP_SDU bytes avoid
+ * the per-notification ATT overhead. GATT stays for control and small
+ * live updates.
+ *
+ * On connect, and whenever the client sends BULK_CMD_DUMP, the current
+ * AP table goes out first as AP_BATCH frames. While the channel is open
+ * per-AP updates travel on it instead of the list characteristic.
+ *
+ * Producers copy frames into a byte ring and never wait; bulk_tx_task
+ * owns the channel and cuts the ring into SDUs. Frame boundaries need not
+ * match SDU boundaries because the stream is self-delimiting. The dump
+ * goes through the ring as well, a few frames at a time as space frees
+ * up, so it never cuts into a frame already queued and sequence numbers
+ * stay in order.
+ */
+#define BULK_RX_MTU           64
+#define BULK_CMD_DUMP         0x01
+#define BULK_RETRY_MS         10
+#define BULK_STALL_POLL_MS    1000
+
+typedef struct {
+    uint32_t frames;
+    uint32_t frames_dropped;
+    uint32_t sdus;
+    uint32_t bytes;
+    uint32_t stalls;                // sends that ran out of credits
+} bulk_stats_t;
+
+static struct ble_l2cap_chan *volatile bulk_chan;
+static uint16_t bulk_sdu_len = CONFIG_SCANNER_BLE_L2CAP_SDU;
+static volatile bool bulk_dump_requested;
+static SemaphoreHandle_t bulk_unstalled;
+static SemaphoreHandle_t bulk_lock;
+static RingbufHandle_t bulk_ring;
+static uint8_t bulk_encode_buf[STREAM_FRAME_MAX_WIRE];
+static uint16_t bulk_seq;
+static bulk_stats_t bulk_stats;
+
+// Dump in progress, sliced out of one snapshot; idle when pos == len
+static struct {
+    uint8_t blob[AP_SNAPSHOT_MAX_LEN];
+    size_t len;
+    size_t pos;
+    uint8_t fields;
+    uint64_t timestamp_us;
+} bulk_dump;
+
+static bool bulk_open(void)
+{
+    return bulk_chan != NULL;
+}
+
+// Caller holds bulk_lock
+static void bulk_emit(uint8_t type, uint8_t flags, const uint8_t *payload, size_t len,
+                      uint64_t timestamp_us)
+{
+    stream_frame_hdr_t hdr = {
+        .type = type,
+        .flags = flags,
+        .seq = bulk_seq++,
+        .timestamp_us = timestamp_us,
+    };
+
+    size_t n = stream_frame_encode(&hdr, payload, len, bulk_encode_buf, sizeof(bulk_encode_buf));
+    if (n == 0 || xRingbufferSend(bulk_ring, bulk_encode_buf, n, 0) != pdTRUE) {
+        bulk_stats.frames_dropped++;
+        return;
+    }
+    bulk_stats.frames++;
+}
+
+static void bulk_send_frame(uint8_t type, uint8_t flags, const void *payload, size_t len)
+{
+    if (!bulk_open()) {
+        return;
+    }
+
+    xSemaphoreTake(bulk_lock, portMAX_DELAY);
+    bulk_emit(type, flags, payload, len, (uint64_t)esp_timer_get_time());
+    xSemaphoreGive(bulk_lock);
+}
+
+static void bulk_send_records(const scan_record_t *recs, size_t n, uint8_t flags)
+{
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    size_t len = 2;
+    uint8_t count = 0;
+
+    if (!bulk_open() || n == 0) {
+        return;
+    }
+
+    xSemaphoreTake(bulk_lock, portMAX_DELAY);
+    payload[1] = SCAN_RECORD_WIRE_MASK;
+    for (size_t i = 0; i < n; i++) {
+        if (count == UINT8_MAX || sizeof(payload) - len < SCAN_RECORD_MAX_LEN) {
+            payload[0] = count;
+            bulk_emit(STREAM_FRAME_AP_BATCH, flags, payload, len, (uint64_t)esp_timer_get_time());
+            len = 2;
+            count = 0;
+        }
+        len += scan_record_encode(&recs[i], payload + len, sizeof(payload) - len);
+        count++;
+    }
+    payload[0] = count;
+    bulk_emit(STREAM_FRAME_AP_BATCH, flags, payload, len, (uint64_t)esp_timer_get_time());
+    xSemaphoreGive(bulk_lock);
+}
+
+// Sends data as one or more SDUs; false once the channel is gone. Holds
+// the TX power stage only while sending, not while the peer withholds
+// credits.
+static bool bulk_write(const uint8_t *data, size_t len)
+{
+    bool ok = true;
+
+    power_stage_begin(DUTY_STAGE_TX);
+    while (len > 0) {
+        struct ble_l2cap_chan *chan = bulk_chan;
+        if (!chan) {
+            ok = false;
+            break;
+        }
+
+        size_t n = len < bulk_sdu_len ? len : bulk_sdu_len;
+        struct os_mbuf *om = os_msys_get_pkthdr(n, 0);
+        if (om && os_mbuf_append(om, data, n) != 0) {
+            os_mbuf_free_chain(om);
+            om = NULL;
+        }
+        if (!om) {
+            // mbufs come back as the controller drains earlier SDUs
+            vTaskDelay(pdMS_TO_TICKS(BULK_RETRY_MS));
+            continue;
+        }
+
+        int rc = ble_l2cap_send(chan, om);
+        if (rc == BLE_HS_EBUSY) {
+            // The previous SDU is still queued
+            os_mbuf_free_chain(om);
+            xSemaphoreTake(bulk_unstalled, pdMS_TO_TICKS(BULK_RETRY_MS));
+            continue;
+        }
+        if (rc != 0 && rc != BLE_HS_ESTALLED) {
+            os_mbuf_free_chain(om);
+            ok = false;
+            break;
+        }
+
+        bulk_stats.sdus++;
+        bulk_stats.bytes += n;
+        data += n;
+        len -= n;
+
+        if (rc == BLE_HS_ESTALLED) {
+            // Accepted, but out of credits until the peer grants more. A
+            // peer may never do so; poll the channel rather than block.
+            bulk_stats.stalls++;
+            power_stage_end(DUTY_STAGE_TX);
+            while (bulk_chan == chan &&
+                   xSemaphoreTake(bulk_unstalled, pdMS_TO_TICKS(BULK_STALL_POLL_MS)) != pdTRUE) {
+            }
+            power_stage_begin(DUTY_STAGE_TX);
+        }
+    }
+    power_stage_end(DUTY_STAGE_TX);
+
+    return ok;
+}
+
+// Starts a dump of the current AP table, replacing one in progress
+static void bulk_dump_start(void)
+{
+    uint32_t generation;
+    uint16_t count;
+
+    bulk_dump.len = ap_snapshot_read(&ap_snapshot, bulk_dump.blob, sizeof(bulk_dump.blob));
+    if (!ap_snapshot_parse_header(bulk_dump.blob, bulk_dump.len, &generation, &count,
+                                  &bulk_dump.timestamp_us, &bulk_dump.fields)) {
+        bulk_dump.len = bulk_dump.pos = 0;
+        return;
+    }
+    bulk_dump.pos = AP_SNAPSHOT_HDR_LEN;
+
+    ESP_LOGI(TAG, "Bulk dump: %u APs, generation %lu", count, (unsigned long)generation);
+}
+
+// Queues the next dump frames as AP_BATCH, sliced straight out of the
+// snapshot, for as long as they fit in the ring; the rest waits for the
+// writer to drain it
+static void bulk_dump_step(void)
+{
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+
+    while (bulk_dump.pos < bulk_dump.len) {
+        size_t pos = bulk_dump.pos;
+        size_t plen = 2;
+        uint8_t n = 0;
+        size_t rec_len;
+        while (n < UINT8_MAX &&
+               (rec_len = scan_record_wire_len(bulk_dump.blob + pos, bulk_dump.len - pos,
+                                               bulk_dump.fields)) != 0 &&
+               plen + rec_len <= sizeof(payload)) {
+            memcpy(payload + plen, bulk_dump.blob + pos, rec_len);
+            plen += rec_len;
+            pos += rec_len;
+            n++;
+        }
+        if (n == 0) {
+            bulk_dump.pos = bulk_dump.len;
+            return;
+        }
+        payload[0] = n;
+        payload[1] = bulk_dump.fields;
+
+        size_t need = COBS_MAX_ENCODED_LEN(STREAM_FRAME_HDR_LEN + plen + STREAM_FRAME_CRC_LEN) + 1;
+        xSemaphoreTake(bulk_lock, portMAX_DELAY);
+        bool fits = xRingbufferGetCurFreeSize(bulk_ring) >= need;
+        if (fits) {
+            bulk_emit(STREAM_FRAME_AP_BATCH, 0, payload, plen, bulk_dump.timestamp_us);
+        }
+        xSemaphoreGive(bulk_lock);
+        if (!fits) {
+            return;
+        }
+        bulk_dump.pos = pos;
+    }
+}
+
+static void bulk_tx_task(void *arg)
+{
+    int64_t next_stats_us = esp_timer_get_time() + LINK_STATS_PERIOD_US;
+
+    while (1) {
+        size_t len;
+
+        if (bulk_dump_requested && bulk_open()) {
+            bulk_dump_requested = false;
+            bulk_dump_start();
+        }
+        if (!bulk_open()) {
+            bulk_dump.pos = bulk_dump.len;
+        }
+        bulk_dump_step();
+
+        uint8_t *data = xRingbufferReceiveUpTo(bulk_ring, &len, pdMS_TO_TICKS(250), bulk_sdu_len);
+        if (data) {
+            // Anything left after a disconnect is stale; drop it
+            bulk_write(data, len);
+            vRingbufferReturnItem(bulk_ring, data);
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (bulk_open() && now >= next_stats_us) {
+            ESP_LOGI(TAG, "Bulk: %lu frames (%lu dropped), %lu SDUs, %lu B, %lu stalls",
+                     (unsigned long)bulk_stats.frames, (unsigned long)bulk_stats.frames_dropped,
+                     (unsigned long)bulk_stats.sdus, (unsigned long)bulk_stats.bytes,
+                     (unsigned long)bulk_stats.stalls);
+            next_stats_us = now + LINK_STATS_PERIOD_US;
+        }
+    }
+}
+
+// Hands the stack a buffer for the next SDU from the client
+static int bulk_rx_ready(struct ble_l2cap_chan *chan)
+{
+    struct os_mbuf *sdu = os_msys_get_pkthdr(BULK_RX_MTU, 0);
+    if (!sdu) {
+        return BLE_HS_ENOMEM;
+    }
+    return ble_l2cap_recv_ready(chan, sdu);
+}
+
+static int bulk_event_cb(struct ble_l2cap_event *event, void *arg)
+{
+    struct ble_l2cap_chan_info info;
+
+    switch (event->type) {
+    case BLE_L2CAP_EVENT_COC_CONNECTED:
+        if (event->connect.status != 0) {
+            ESP_LOGW(TAG, "Bulk channel failed: %d", event->connect.status);
+            break;
+        }
+        if (ble_l2cap_get_chan_info(event->connect.chan, &info) == 0) {
+            bulk_sdu_len = info.peer_coc_mtu < CONFIG_SCANNER_BLE_L2CAP_SDU ?
+                           info.peer_coc_mtu : CONFIG_SCANNER_BLE_L2CAP_SDU;
+            ESP_LOGI(TAG, "Bulk channel open: SDU %u, peer MPS %u", bulk_sdu_len,
+                     info.peer_l2cap_mtu);
+        } else {
+            bulk_sdu_len = BULK_RX_MTU;
+        }
+        bulk_dump_requested = true;
+        bulk_chan = event->connect.chan;
+        break;
+
+    case BLE_L2CAP_EVENT_COC_DISCONNECTED:
+        bulk_chan = NULL;
+        // Release a sender waiting for credits that will never come
+        xSemaphoreGive(bulk_unstalled);
+        ESP_LOGI(TAG, "Bulk channel closed");
+        break;
+
+    case BLE_L2CAP_EVENT_COC_ACCEPT:
+        return bulk_rx_ready(event->accept.chan);
+
+    case BLE_L2CAP_EVENT_COC_DATA_RECEIVED:
+        if (event->receive.sdu_rx) {
+            uint8_t cmd = 0;
+            uint16_t n;
+            ble_hs_mbuf_to_flat(event->receive.sdu_rx, &cmd, 1, &n);
+            if (cmd == BULK_CMD_DUMP) {
+                bulk_dump_requested = true;
+            }
+            os_mbuf_free_chain(event->receive.sdu_rx);
+        }
+        bulk_rx_ready(event->receive.chan);
+        break;
+
+    case BLE_L2CAP_EVENT_COC_TX_UNSTALLED:
+        xSemaphoreGive(bulk_unstalled);
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static void bulk_init(void)
+{
+    bulk_unstalled = xSemaphoreCreateBinary();
+    bulk_lock = xSemaphoreCreateMutex();
+    bulk_ring = xRingbufferCreate(CONFIG_SCANNER_BLE_L2CAP_BUF, RINGBUF_TYPE_BYTEBUF);
+    xTaskCreate(bulk_tx_task, "bulk_tx", 3072, NULL, 6, NULL);
+}
+#else
+static bool bulk_open(void)
+{
+    return false;
+}
+
+static void bulk_send_frame(uint8_t type, uint8_t flags, const void *payload, size_t len)
+{
+}
+
+static void bulk_send_records(const scan_record_t *recs, size_t n, uint8_t flags)
+{
+}
+#endif
+
+/* ===================== SNAPSHOT READ =====================
+ * The client writes a page index (u8) and reads that page, using ATT long
+ * reads when it exceeds the MTU. All pages and all Read Blob slices of a
+ * pass come from one pinned copy; writing page 0 starts a new pass. A
+ * plain read of page 0 also re-pins once the previous pass went idle, so
+ * read-only clients still see fresh data.
+ */
+#define SNAPSHOT_PIN_IDLE_US  (500 * 1000)
+
+static uint8_t snapshot_pin[AP_SNAPSHOT_MAX_LEN];
+static size_t snapshot_pin_len;
+static unsigned snapshot_page;
+static int64_t snapshot_access_us;
+
+static void snapshot_repin(void)
+{
+    snapshot_pin_len = ap_snapshot_read(&ap_snapshot, snapshot_pin, sizeof(snapshot_pin));
+}
+
+static int snapshot_access(struct ble_gatt_access_ctxt *ctxt)
+{
+    static uint8_t page_buf[AP_SNAPSHOT_PAGE_MAX];
+    int64_t now = esp_timer_get_time();
+    unsigned pages;
+
+    if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
+        uint8_t page;
+        uint16_t len;
+        if (OS_MBUF_PKTLEN(ctxt->om) != 1 || ble_hs_mbuf_to_flat(ctxt->om, &page, 1, &len) != 0) {
+            return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        }
+        if (page == 0 || snapshot_pin_len == 0) {
+            snapshot_repin();
+        }
+        ap_snapshot_page(snapshot_pin, snapshot_pin_len, 0, page_buf, sizeof(page_buf), &pages);
+        if (page >= pages) {
+            return BLE_ATT_ERR_VALUE_NOT_ALLOWED;
+        }
+        snapshot_page = page;
+        snapshot_access_us = now;
+        return 0;
+    }
+
+    if (ctxt->op != BLE_GATT_ACCESS_OP_READ_CHR) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    // Blob reads of one long read arrive a connection interval apart
+    if (snapshot_pin_len == 0 ||
+        (snapshot_page == 0 && now - snapshot_access_us > SNAPSHOT_PIN_IDLE_US)) {
+        snapshot_repin();
+    }
+    snapshot_access_us = now;
+
+    // NimBLE slices the Read Blob offset out of the full value we append
+    size_t len = ap_snapshot_page(snapshot_pin, snapshot_pin_len, snapshot_page,
+                                  page_buf, sizeof(page_buf), &pages);
+    if (len == 0) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    return os_mbuf_append(ctxt->om, page_buf, len) == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+/* ===================== CHANNEL VIEW ===================== */
+static void publish_channel_stats(const channel_stats_t *cs)
+{
+    channel_stat_t stats[CHANNEL_STATS_MAX + 1];
+    uint8_t buf[CHANNEL_STATS_WIRE_LEN];
+
+    channel_stats_finish(cs, stats);
+    size_t len = channel_stats_encode(stats, buf, sizeof(buf));
+
+    xSemaphoreTake(ap_table_lock, portMAX_DELAY);
+    memcpy(channel_hist, buf, len);
+    channel_hist_len = len;
+    xSemaphoreGive(ap_table_lock);
+
+    // One small message instead of the full list for planning-only clients
+    if (conn_handle != BLE_HS_CONN_HANDLE_NONE && channels_subscribed) {
+        notify_enqueue(channel_handle, buf, len);
+    }
+    bulk_send_frame(STREAM_FRAME_CHANNEL_HIST, 0, buf, len);
+}
+
+static int channel_access(struct ble_gatt_access_ctxt *ctxt)
+{
+    if (ctxt->op != BLE_GATT_ACCESS_OP_READ_CHR) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    // Held only for short copies; don't stall the host task if it isn't
+    if (xSemaphoreTake(ap_table_lock, pdMS_TO_TICKS(10)) != pdTRUE) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+    int rc = os_mbuf_append(ctxt->om, channel_hist, channel_hist_len);
+    xSemaphoreGive(ap_table_lock);
+
+    return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+#if CONFIG_SCANNER_ALERT_ENABLE
+/* ===================== WATCHLIST ALERTS =====================
+ * Every scan result and captured beacon is checked against the alert
+ * watchlist as it arrives. The Bloom filter rejects unlisted BSSIDs
+ * without taking the lock; a racing list edit costs at most one sighting.
+ * A periodic timer raises disappearances.
+ *
+ * Alert characteristic: notifications carry watch_alert.h events. Writes
+ * edit the list: 0x00 clears it, 0x01 followed by n x bssid[6] adds.
+ * Reads return count(u16) cap(u16) present(u16), little endian.
+ */
+#define ALERT_TICK_US         (100 * 1000)
+#define ALERT_EXPIRE_BATCH    8
+#define ALERT_OP_CLEAR        0x00
+#define ALERT_OP_ADD          0x01
+
+static uint8_t alert_storage[CONFIG_SCANNER_ALERT_MAX][6];
+static watch_alert_slot_t alert_slots[CONFIG_SCANNER_ALERT_MAX];
+// Largest power of two that fits: 8-16 bits per entry
+static uint8_t alert_bloom[2 * CONFIG_SCANNER_ALERT_MAX];
+static watchlist_t alert_list;
+static watch_alert_t watch_alert;
+static SemaphoreHandle_t alert_lock;
+static esp_timer_handle_t alert_timer;
+static uint32_t alert_lock_misses;
+
+static uint32_t alert_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void alert_emit(const watch_alert_event_t *ev)
+{
+    uint8_t buf[WATCH_ALERT_WIRE_LEN];
+
+    ESP_LOGI(TAG, "Watch %s %02x:%02x:%02x:%02x:%02x:%02x ch %u RSSI %d",
+             ev->kind == WATCH_ALERT_APPEAR ? "appeared" : "gone",
+             ev->bssid[0], ev->bssid[1], ev->bssid[2], ev->bssid[3], ev->bssid[4], ev->bssid[5],
+             ev->channel, ev->rssi);
+
+    if (conn_handle != BLE_HS_CONN_HANDLE_NONE && alerts_subscribed) {
+        size_t len = watch_alert_encode(ev, buf, sizeof(buf));
+        notify_enqueue_urgent(alert_handle, buf, len);
+    }
+}
+
+// wait is 0 from the Wi-Fi task, where a busy lock drops the sighting
+static void alert_check(const scan_record_t *rec, TickType_t wait)
+{
+    watch_alert_event_t ev;
+
+    if (!watchlist_may_contain(&alert_list, rec->bssid)) {
+        return;
+    }
+    if (xSemaphoreTake(alert_lock, wait) != pdTRUE) {
+        alert_lock_misses++;
+        return;
+    }
+    bool appeared = watch_alert_check(&watch_alert, rec, alert_now_ms(), &ev);
+    xSemaphoreGive(alert_lock);
+
+    if (appeared) {
+        alert_emit(&ev);
+    }
+}
+
+// Sightings come once per scan or sweep, so a timeout shorter than that
+// raises DISAPPEAR between them for APs that never left. Two periods
+// tolerate one missed sighting.
+static void alert_set_sighting_period(uint32_t period_ms)
+{
+    uint32_t absent_ms = CONFIG_SCANNER_ALERT_ABSENT_MS;
+    if (absent_ms < 2 * period_ms) {
+        absent_ms = 2 * period_ms;
+    }
+
+    xSemaphoreTake(alert_lock, portMAX_DELAY);
+    watch_alert_set_absent_ms(&watch_alert, absent_ms);
+    xSemaphoreGive(alert_lock);
+}
+
+static void alert_tick(void *arg)
+{
+    watch_alert_event_t evs[ALERT_EXPIRE_BATCH];
+
+    // Anything left over goes out on the next tick
+    if (xSemaphoreTake(alert_lock, 0) != pdTRUE) {
+        return;
+    }
+    size_t n = watch_alert_expire(&watch_alert, alert_now_ms(), evs, ALERT_EXPIRE_BATCH);
+    xSemaphoreGive(alert_lock);
+
+    for (size_t i = 0; i < n; i++) {
+        alert_emit(&evs[i]);
+    }
+}
+
+static int alert_access(struct ble_gatt_access_ctxt *ctxt)
+{
+    uint8_t buf[1 + 6 * 40];
+    uint16_t len;
+
+    if (ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR) {
+        xSemaphoreTake(alert_lock, portMAX_DELAY);
+        uint16_t v[3] = {
+            (uint16_t)alert_list.count, (uint16_t)alert_list.cap, (uint16_t)watch_alert.present,
+        };
+        xSemaphoreGive(alert_lock);
+        for (int i = 0; i < 3; i++) {
+            buf[2 * i] = v[i] & 0xFF;
+            buf[2 * i + 1] = v[i] >> 8;
+        }
+        return os_mbuf_append(ctxt->om, buf, 6) == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+
+    if (ctxt->op != BLE_GATT_ACCESS_OP_WRITE_CHR) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+    if (OS_MBUF_PKTLEN(ctxt->om) > sizeof(buf) ||
+        ble_hs_mbuf_to_flat(ctxt->om, buf, sizeof(buf), &len) != 0 || len < 1) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+
+    if (buf[0] == ALERT_OP_CLEAR && len == 1) {
+        xSemaphoreTake(alert_lock, portMAX_DELAY);
+        watch_alert_clear(&watch_alert);
+        xSemaphoreGive(alert_lock);
+        ESP_LOGI(TAG, "Watchlist cleared");
+        return 0;
+    }
+    if (buf[0] != ALERT_OP_ADD || (len - 1) % 6 != 0) {
+        return BLE_ATT_ERR_VALUE_NOT_ALLOWED;
+    }
+
+    bool full = false;
+    xSemaphoreTake(alert_lock, portMAX_DELAY);
+    for (uint16_t off = 1; off < len && !full; off += 6) {
+        full = !watch_alert_add(&watch_alert, &buf[off]);
+    }
+    size_t count = alert_list.count;
+    xSemaphoreGive(alert_lock);
+
+    ESP_LOGI(TAG, "Watchlist: %u entries", (unsigned)count);
+    return full ? BLE_ATT_ERR_INSUFFICIENT_RES : 0;
+}
+
+static void alert_init(void)
+{
+    size_t bloom_bytes = 1;
+    while (bloom_bytes * 2 <= sizeof(alert_bloom)) {
+        bloom_bytes *= 2;
+    }
+
+    watchlist_init(&alert_list, alert_storage, CONFIG_SCANNER_ALERT_MAX);
+    watchlist_add_list(&alert_list, CONFIG_SCANNER_ALERT_BSSIDS);
+    watchlist_attach_bloom(&alert_list, alert_bloom, bloom_bytes);
+    watch_alert_init(&watch_alert, &alert_list, alert_slots, CONFIG_SCANNER_ALERT_ABSENT_MS);
+    alert_lock = xSemaphoreCreateMutex();
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = alert_tick,
+        .name = "alert",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &alert_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(alert_timer, ALERT_TICK_US));
+
+    ESP_LOGI(TAG, "Watching %u BSSIDs (Bloom filter %u bytes)", (unsigned)alert_list.count,
+             (unsigned)bloom_bytes);
+}
+#endif
 
 /* ===================== GATT ACCESS ===================== */
 static int gatt_access_cb(uint16_t conn_handle, uint16_t attr_handle,
                           struct ble_gatt_access_ctxt *ctxt, void *arg)
 {
+    if (attr_handle == snapshot_handle) {
+        return snapshot_access(ctxt);
+    }
+    if (attr_handle == channel_handle) {
+        return channel_access(ctxt);
+    }
+#if CONFIG_SCANNER_ALERT_ENABLE
+    if (attr_handle == alert_handle) {
+        return alert_access(ctxt);
+    }
+#endif
     return 0;
 }
 
@@ -44,28 +965,159 @@ static const struct ble_gatt_svc_def gatt_svcs[] = {
                 .flags = BLE_GATT_CHR_F_NOTIFY,
                 .val_handle = &notify_handle,
             },
+            {
+                .uuid = BLE_UUID16_DECLARE(SNAPSHOT_CHAR_UUID),
+                .access_cb = gatt_access_cb,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE,
+                .val_handle = &snapshot_handle,
+            },
+            {
+                .uuid = BLE_UUID16_DECLARE(CHANNEL_CHAR_UUID),
+                .access_cb = gatt_access_cb,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &channel_handle,
+            },
+#if CONFIG_SCANNER_ALERT_ENABLE
+            {
+                .uuid = BLE_UUID16_DECLARE(ALERT_CHAR_UUID),
+                .access_cb = gatt_access_cb,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &alert_handle,
+            },
+#endif
             {0}
         }
     },
     {0}
 };
 
-/* ===================== BLE SYNC ===================== */
-static void ble_app_on_sync(void)
-{
-    ble_svc_gap_device_name_set(DEVICE_NAME);
-    ble_gatts_add_svcs(gatt_svcs);
+/* ===================== GAP EVENTS ===================== */
+static int ble_gap_event_cb(struct ble_gap_event *event, void *arg);
 
+static void ble_advertise(void)
+{
     struct ble_gap_adv_params adv_params = {0};
     adv_params.conn_mode = BLE_GAP_CONN_MODE_UND;
     adv_params.disc_mode = BLE_GAP_DISC_MODE_GEN;
 
     ble_gap_adv_start(BLE_OWN_ADDR_PUBLIC, NULL, BLE_HS_FOREVER,
-                      &adv_params, NULL, NULL);
+                      &adv_params, ble_gap_event_cb, NULL);
 
     ESP_LOGI(TAG, "BLE Advertising");
 }
 
+static void link_on_connect(uint16_t conn)
+{
+    struct ble_gap_conn_desc desc;
+    uint16_t itvl = ble_gap_conn_find(conn, &desc) == 0 ? desc.conn_itvl : 0;
+
+    link_tuner_reset(&link_tuner, itvl, esp_timer_get_time());
+
+    // Each is a request; the central may refuse or settle for less
+    ble_gap_set_prefered_le_phy(conn, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK,
+                                BLE_GAP_LE_PHY_CODED_ANY);
+    ble_gap_set_data_len(conn, LINK_DLE_OCTETS, LINK_DLE_TIME_US);
+    // Up to CONFIG_BT_NIMBLE_ATT_PREFERRED_MTU; don't wait for the central to ask
+    ble_gattc_exchange_mtu(conn, NULL, NULL);
+}
+
+static int ble_gap_event_cb(struct ble_gap_event *event, void *arg)
+{
+    struct ble_gap_conn_desc desc;
+
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT:
+        if (event->connect.status == 0) {
+            conn_handle = event->connect.conn_handle;
+            ESP_LOGI(TAG, "Client connected");
+            link_on_connect(conn_handle);
+        } else {
+            ble_advertise();
+        }
+        break;
+
+    case BLE_GAP_EVENT_CONN_UPDATE:
+        if (ble_gap_conn_find(event->conn_update.conn_handle, &desc) == 0) {
+            link_tuner.stats.conn_itvl = desc.conn_itvl;
+            ESP_LOGI(TAG, "Connection interval %u.%02u ms", desc.conn_itvl * 125 / 100,
+                     desc.conn_itvl * 125 % 100);
+        }
+        break;
+
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+        ESP_LOGI(TAG, "PHY tx %u rx %u (status %d)", event->phy_updated.tx_phy,
+                 event->phy_updated.rx_phy, event->phy_updated.status);
+        break;
+
+    case BLE_GAP_EVENT_DATA_LEN_CHG:
+        ESP_LOGI(TAG, "Data length tx %u rx %u", event->data_len_chg.max_tx_octets,
+                 event->data_len_chg.max_rx_octets);
+        break;
+
+    case BLE_GAP_EVENT_MTU:
+        ESP_LOGI(TAG, "MTU %u", event->mtu.value);
+        break;
+
+    case BLE_GAP_EVENT_DISCONNECT:
+        conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        snapshot_page = 0;
+        snapshot_pin_len = 0;
+        list_subscribed = false;
+        channels_subscribed = false;
+        alerts_subscribed = false;
+        ESP_LOGI(TAG, "Client disconnected");
+        ble_advertise();
+        break;
+
+    case BLE_GAP_EVENT_SUBSCRIBE:
+        if (event->subscribe.attr_handle == notify_handle) {
+            list_subscribed = event->subscribe.cur_notify;
+            if (list_subscribed) {
+                notify_boot_cache();
+            }
+        } else if (event->subscribe.attr_handle == channel_handle) {
+            channels_subscribed = event->subscribe.cur_notify;
+        } else if (event->subscribe.attr_handle == alert_handle) {
+            alerts_subscribed = event->subscribe.cur_notify;
+        }
+        break;
+
+    case BLE_GAP_EVENT_ADV_COMPLETE:
+        ble_advertise();
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+/* ===================== BLE SYNC ===================== */
+static void ble_app_on_sync(void)
+{
+#if CONFIG_SCANNER_BLE_L2CAP
+    // Sync repeats after a host reset; the server survives it
+    static bool bulk_server;
+    if (!bulk_server) {
+        int rc = ble_l2cap_create_server(CONFIG_SCANNER_BLE_L2CAP_PSM, CONFIG_SCANNER_BLE_L2CAP_SDU,
+                                         bulk_event_cb, NULL);
+        if (rc != 0) {
+            ESP_LOGE(TAG, "L2CAP server failed: %d", rc);
+        }
+        bulk_server = rc == 0;
+    }
+#endif
+    ble_svc_gap_device_name_set(DEVICE_NAME);
+    ble_advertise();
+}
+
+static void ble_host_task(void *param)
+{
+    nimble_port_run();
+    nimble_port_freertos_deinit();
+}
+
 /* ===================== BLE INIT ===================== */
 void ble_init(void)
 {
@@ -73,9 +1125,13 @@ void ble_init(void)
     ble_svc_gap_init();
     ble_svc_gatt_init();
 
+    // Services must be registered before the host syncs
+    ble_gatts_count_cfg(gatt_svcs);
+    ble_gatts_add_svcs(gatt_svcs);
+
     ble_hs_cfg.sync_cb = ble_app_on_sync;
 
-    nimble_port_freertos_init(NULL);
+    nimble_port_freertos_init(ble_host_task);
     ESP_LOGI(TAG, "NimBLE Initialized");
 }
 
@@ -92,27 +1148,423 @@ void wifi_init(void)
     esp_wifi_start();
 }
 
+#if CONFIG_SCANNER_FP_ENABLE
+/* ===================== POSITIONING ===================== */
+static void fp_init(void)
+{
+    const fp_db_t *db = &fp_db_builtin;
+
+    fp_acc = malloc(db->n_fps * sizeof(*fp_acc));
+    if (!fp_acc) {
+        ESP_LOGW(TAG, "Fingerprint matching unavailable");
+        return;
+    }
+    ESP_LOGI(TAG, "Fingerprints: %u over %u BSSIDs, %u bytes of flash, survey %08lx",
+             db->n_fps, db->n_bssids, (unsigned)fp_db_footprint(db), (unsigned long)db->version);
+}
+
+// Over the bulk channel as a LOCATION frame, else one notify line
+static void publish_location(const fp_result_t *r)
+{
+    if (bulk_open()) {
+        uint8_t payload[FP_WIRE_MAX_LEN];
+        size_t len = fp_result_encode(r, payload, sizeof(payload));
+        bulk_send_frame(STREAM_FRAME_LOCATION, 0, payload, len);
+        return;
+    }
+
+    // Nearest first; matches that would not fit one notification are left off
+    char msg[NOTIFY_MSG_MAX];
+    int len = snprintf(msg, sizeof(msg), "LOC%s", r->k ? "" : " none");
+    for (uint8_t i = 0; i < r->k && len < (int)sizeof(msg) - 20; i++) {
+        len += snprintf(msg + len, sizeof(msg) - len, " %u:%lu", r->match[i].loc,
+                        (unsigned long)r->match[i].dist);
+    }
+    snprintf(msg + len, sizeof(msg) - len, "\n");
+    notify_msg(msg);
+}
+#endif
+
 /* ===================== WIFI SCAN TASK ===================== */
+#if CONFIG_SCANNER_ALERT_ENABLE
+// Every sub-scan sighting, so alerts don't wait for the fused report
+static void fusion_record_cb(const scan_record_t *rec, void *arg)
+{
+    alert_check(rec, portMAX_DELAY);
+}
+#endif
+
 void wifi_scan_task(void *arg)
 {
+    static scan_fusion_entry_t fusion_storage[FUSION_MAX_APS];
+    static scan_fusion_ap_t fused[FUSION_MAX_APS];
+    static scan_record_t recs[FUSION_MAX_APS];
     wifi_ap_record_t ap[20];
     uint16_t ap_num;
     char msg[100];
+    scan_fusion_t fusion;
+    const scan_fusion_wifi_config_t fusion_cfg = {
+        .scans = CONFIG_SCANNER_FUSION_SCANS,
+        .dwell_ms = CONFIG_SCANNER_FUSION_DWELL_MS,
+        .gap_ms = CONFIG_SCANNER_FUSION_GAP_MS,
+#if CONFIG_SCANNER_ALERT_ENABLE
+        .on_record = fusion_record_cb,
+#endif
+    };
+    scan_interval_t interval_ctl;
+    channel_stats_t channels;
+    const scan_interval_config_t interval_cfg = {
+        .min_ms = CONFIG_SCANNER_INTERVAL_MIN_MS,
+        .max_ms = CONFIG_SCANNER_INTERVAL_MAX_MS,
+        .rssi_delta_db = CONFIG_SCANNER_INTERVAL_RSSI_DELTA_DB,
+        .churn_threshold_permille = CONFIG_SCANNER_INTERVAL_CHURN_PERMILLE,
+    };
+    int64_t scan_us = 0;
+
+    scan_interval_init(&interval_ctl, &interval_cfg);
+    scan_fusion_init(&fusion, fusion_storage, FUSION_MAX_APS);
+
+    // Fast start: short scans of last boot's busiest channels before the first sweep
+    if (boot_cache_valid) {
+        uint8_t order[SCAN_CACHE_CHANNELS];
+        size_t n_busy = scan_cache_busy_channels(&boot_cache, order, sizeof(order));
+
+        for (size_t c = 0; c < n_busy; c++) {
+            wifi_scan_config_t quick = {
+                .channel = order[c],
+                .show_hidden = true,
+                .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+                .scan_time.active.min = 30,
+                .scan_time.active.max = 60,
+            };
+            if (esp_wifi_scan_start(&quick, true) != ESP_OK) {
+                break;
+            }
+            ap_num = 20;
+            esp_wifi_scan_get_ap_records(&ap_num, ap);
+            live_data_ready = live_data_ready || ap_num > 0;
 
+            for (int i = 0; i < ap_num; i++) {
+                snprintf(msg, sizeof(msg), "%s | RSSI: %d\n", ap[i].ssid, ap[i].rssi);
+                notify_msg(msg);
+            }
+        }
+    }
+
+#if CONFIG_SCANNER_ALERT_ENABLE
+    alert_set_sighting_period(CONFIG_SCANNER_INTERVAL_MIN_MS);
+#endif
+    // Sweeps start on absolute deadlines; the interval is start to start
+    scan_sched_job_t *job = scan_sched_add("sweep", CONFIG_SCANNER_INTERVAL_MIN_MS * 1000, NULL,
+                                           NULL);
     while (1) {
-        esp_wifi_scan_start(NULL, true);
-        esp_wifi_scan_get_ap_num(&ap_num);
-        esp_wifi_scan_get_ap_records(&ap_num, ap);
+        int64_t cycle_start_us = esp_timer_get_time();
+        // The radio is only up for the sub-scans; a started STA holds the
+        // PHY on and keeps the chip out of light sleep. Starting an
+        // already started driver (the first pass) is a no-op.
+        power_stage_begin(DUTY_STAGE_SCAN);
+        esp_wifi_start();
+        esp_err_t ret = scan_fusion_wifi_run(&fusion, &fusion_cfg, &scan_us);
+        esp_wifi_stop();
+        power_stage_end(DUTY_STAGE_SCAN);
+        if (ret != ESP_OK) {
+            scan_sched_set_period(job, CONFIG_SCANNER_INTERVAL_MIN_MS * 1000);
+            scan_sched_wait(job);
+            continue;
+        }
+
+        power_stage_begin(DUTY_STAGE_ENCODE);
+        int64_t now = esp_timer_get_time();
+        ap_num = scan_fusion_report(&fusion, now, fused, FUSION_MAX_APS);
+
+        live_data_ready = true;
 
+        int always = 0;
+        channel_stats_reset(&channels);
         for (int i = 0; i < ap_num; i++) {
-            snprintf(msg, sizeof(msg), "%s | RSSI: %d\n",
-                     ap[i].ssid, ap[i].rssi);
+            recs[i] = fused[i].rec;
+            always += fused[i].seen == fused[i].scans;
+            channel_stats_add(&channels, &recs[i]);
+        }
+        DLOG(FUSED, fusion.scans, ap_num, always);
+        publish_channel_stats(&channels);
+        scan_cache_store(recs, ap_num, CONFIG_SCANNER_CACHE_NVS_PERIOD_S);
+
+        uint32_t interval_ms = scan_interval_update(&interval_ctl, recs, ap_num);
 
-            struct os_mbuf *om = ble_hs_mbuf_from_flat(msg, strlen(msg));
-            ble_gatts_notify_custom(conn_handle, notify_handle, om);
+        // Keep entries across a couple of (possibly long) intervals
+        int64_t max_age_us = 2LL * interval_ms * 1000;
+        xSemaphoreTake(ap_table_lock, portMAX_DELAY);
+        for (int i = 0; i < ap_num; i++) {
+            recs[i].distance_cm = ap_table_update(&ap_table, &recs[i], now)->rec.distance_cm;
         }
+        ap_table_expire(&ap_table, now, max_age_us > AP_MAX_AGE_US ? max_age_us : AP_MAX_AGE_US);
+        ap_snapshot_publish(&ap_snapshot, &ap_table, now);
+        xSemaphoreGive(ap_table_lock);
 
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        bool send_records = true;
+#if CONFIG_SCANNER_FP_ENABLE
+        if (fp_acc) {
+            fp_result_t where;
+            int64_t t0 = esp_timer_get_time();
+            fp_db_locate(&fp_db_builtin, recs, ap_num, fp_acc, CONFIG_SCANNER_FP_K, &where);
+            DLOG(LOCATED, where.k ? where.match[0].loc : 0, where.k ? where.match[0].dist : 0,
+                 where.heard, where.unknown, (uint32_t)(esp_timer_get_time() - t0));
+            publish_location(&where);
+#if CONFIG_SCANNER_FP_ONLY
+            send_records = false;
+#endif
+        }
+#endif
+        // With locations only, records still feed the table and snapshot above
+        if (send_records && bulk_open()) {
+            bulk_send_records(recs, ap_num, 0);
+        } else if (send_records) {
+            for (int i = 0; i < ap_num; i++) {
+                notify_record(&recs[i]);
+            }
+        }
+        power_stage_end(DUTY_STAGE_ENCODE);
+        power_mgr_report_done();
+        // Start to start, leaving at least the minimum idle after this cycle
+        interval_ms = scan_interval_period(&interval_ctl,
+                                           (esp_timer_get_time() - cycle_start_us) / 1000);
+        int64_t total_us = interval_ctl.elapsed_ms * 1000LL;
+        uint32_t duty = 1000 * scan_us / (total_us > scan_us ? total_us : scan_us);
+        int64_t fixed_idle_us = (int64_t)interval_ctl.scans * 5000 * 1000;
+        uint32_t fixed_duty = 1000 * scan_us / (scan_us + fixed_idle_us);
+        DLOG(SCAN_INTERVAL, interval_ctl.last_churn_permille, interval_ms, duty / 10, duty % 10,
+             fixed_duty / 10, fixed_duty % 10);
+
+        scan_sched_set_period(job, interval_ms * 1000);
+#if CONFIG_SCANNER_ALERT_ENABLE
+        alert_set_sighting_period(interval_ms);
+#endif
+        scan_sched_wait(job);
+    }
+}
+
+#if CONFIG_SCANNER_CLIENT_COUNT
+/* ===================== CLIENT COUNTING ===================== */
+static void probe_req_cb(const ieee80211_mgmt_t *mgmt, int8_t rssi, void *arg)
+{
+    // Wi-Fi task context: skip the sample rather than wait for the reporter
+    if (xSemaphoreTake(client_lock, 0) != pdTRUE) {
+        return;
+    }
+    client_counter_add(&client_counter, mgmt, esp_timer_get_time());
+    xSemaphoreGive(client_lock);
+}
+
+static void notify_client_counts(void)
+{
+    client_counts_t counts;
+    char msg[100];
+
+    xSemaphoreTake(client_lock, portMAX_DELAY);
+    client_counter_get(&client_counter, esp_timer_get_time(), &counts);
+    xSemaphoreGive(client_lock);
+
+    snprintf(msg, sizeof(msg), "Clients %ds: %lu (+%lu rand) | %ds: %lu (+%lu rand)\n",
+             CONFIG_SCANNER_CLIENT_WINDOW_SHORT_S,
+             (unsigned long)counts.global[CLIENT_WINDOW_SHORT],
+             (unsigned long)counts.randomized[CLIENT_WINDOW_SHORT],
+             CONFIG_SCANNER_CLIENT_WINDOW_LONG_S,
+             (unsigned long)counts.global[CLIENT_WINDOW_LONG],
+             (unsigned long)counts.randomized[CLIENT_WINDOW_LONG]);
+    notify_msg(msg);
+}
+#endif
+
+#if CONFIG_SCANNER_MODE_PASSIVE_CAPTURE && CONFIG_SCANNER_ALERT_ENABLE
+// Wi-Fi task context, every beacon: the alert path must not block
+static void capture_bss_cb(const scan_record_t *rec, void *arg)
+{
+    alert_check(rec, 0);
+}
+#endif
+
+#if CONFIG_SCANNER_MODE_PASSIVE_CAPTURE
+/* ===================== CAPTURE REPORT TASK ===================== */
+void capture_report_task(void *arg)
+{
+    static scan_record_t updates[AP_TABLE_MAX];
+    channel_stats_t channels;
+    int64_t next_channel_report_us = esp_timer_get_time();
+#if CONFIG_SCANNER_CLIENT_COUNT
+    int64_t next_client_report_us = esp_timer_get_time();
+#endif
+    scan_sched_job_t *job = scan_sched_add("capture", CONFIG_SCANNER_CAPTURE_REPORT_MS * 1000,
+                                           NULL, NULL);
+
+    while (1) {
+        scan_sched_wait(job);
+
+#if CONFIG_SCANNER_CLIENT_COUNT
+        if (esp_timer_get_time() >= next_client_report_us) {
+            notify_client_counts();
+            next_client_report_us += CONFIG_SCANNER_CLIENT_REPORT_S * 1000000LL;
+        }
+#endif
+
+        // Copy out under the lock, notify without it so capture keeps flowing
+        int n = 0;
+        int64_t now = esp_timer_get_time();
+        bool channel_report = now >= next_channel_report_us;
+        channel_stats_reset(&channels);
+        xSemaphoreTake(ap_table_lock, portMAX_DELAY);
+        ap_table_expire(&ap_table, now, AP_MAX_AGE_US);
+        ap_snapshot_publish(&ap_snapshot, &ap_table, now);
+        for (int i = 0; i < ap_table.count; i++) {
+            if (ap_table.entries[i].dirty) {
+                updates[n++] = ap_table.entries[i].rec;
+            }
+            if (channel_report) {
+                channel_stats_add(&channels, &ap_table.entries[i].rec);
+            }
+        }
+        ap_table_clear_dirty(&ap_table);
+        xSemaphoreGive(ap_table_lock);
+
+        if (channel_report) {
+            publish_channel_stats(&channels);
+            next_channel_report_us = now + CHANNEL_REPORT_US;
+        }
+
+        live_data_ready = live_data_ready || n > 0;
+        if (bulk_open()) {
+            bulk_send_records(updates, n, 0);
+        } else {
+            for (int i = 0; i < n; i++) {
+                notify_record(&updates[i]);
+            }
+        }
+    }
+}
+#endif
+
+#if CONFIG_SCANNER_MODE_TRACKING
+/* ===================== TRACKING ===================== */
+static void tracker_update_cb(const scan_record_t *rec, void *arg)
+{
+    live_data_ready = true;
+
+    // The tracker updated the entry just before calling back
+    xSemaphoreTake(ap_table_lock, portMAX_DELAY);
+    const ap_entry_t *e = ap_table_find(&ap_table, rec->bssid);
+    scan_record_t update = e ? e->rec : *rec;
+    ap_snapshot_publish(&ap_snapshot, &ap_table, esp_timer_get_time());
+    xSemaphoreGive(ap_table_lock);
+
+    if (bulk_open()) {
+        bulk_send_records(&update, 1, 0);
+    } else {
+        notify_record(&update);
+    }
+}
+
+#if CONFIG_SCANNER_ALERT_ENABLE
+static void tracker_record_cb(const scan_record_t *rec, void *arg)
+{
+    alert_check(rec, portMAX_DELAY);
+}
+#endif
+#endif
+
+#if CONFIG_SCANNER_MODE_SYNTHETIC_LOAD
+/* ===================== SYNTHETIC LOAD ===================== */
+void synth_task(void *arg)
+{
+    static scan_record_t recs[CONFIG_SCANNER_SYNTH_BATCH];
+    const synth_load_config_t cfg = {
+        .rate = CONFIG_SCANNER_SYNTH_RATE,
+        .batch = CONFIG_SCANNER_SYNTH_BATCH,
+        .count = CONFIG_SCANNER_SYNTH_COUNT,
+    };
+    synth_load_t gen;
+    char msg[100];
+
+    // Start counting from seq 0 only once someone is listening
+    while (!list_subscribed && !bulk_open()) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    synth_load_init(&gen, &cfg, esp_timer_get_time());
+    ESP_LOGI(TAG, "Synthetic load: %d records/s in batches of %d",
+             CONFIG_SCANNER_SYNTH_RATE, CONFIG_SCANNER_SYNTH_BATCH);
+
+    while (!synth_load_done(&gen)) {
+        while (!synth_load_done(&gen) && synth_load_due_us(&gen) <= esp_timer_get_time()) {
+            size_t n = synth_load_next(&gen, recs, esp_timer_get_time());
+            if (bulk_open()) {
+                bulk_send_records(recs, n, STREAM_FLAG_SYNTHETIC);
+                continue;
+            }
+            for (size_t i = 0; i < n; i++) {
+                snprintf(msg, sizeof(msg), "%s | RSSI: %d\n", recs[i].ssid, recs[i].rssi);
+                notify_msg(msg);
+            }
+        }
+
+        int64_t wait_ms = (synth_load_due_us(&gen) - esp_timer_get_time()) / 1000;
+        TickType_t ticks = pdMS_TO_TICKS(wait_ms);
+        vTaskDelay(ticks > 0 ? ticks : 1);
+    }
+
+    ESP_LOGI(TAG, "Synthetic load done: %lu records, %lu sent, %lu dropped",
+             (unsigned long)gen.next_seq, (unsigned long)link_tuner.stats.msgs,
+             (unsigned long)link_tuner.stats.drops);
+    vTaskDelete(NULL);
+}
+#endif
+
+/* ===================== POWER ===================== */
+static void duty_report_cb(const stage_duty_summary_t *s, void *arg)
+{
+    uint8_t payload[STAGE_DUTY_WIRE_LEN];
+    size_t len = stage_duty_encode(s, payload, sizeof(payload));
+
+    if (bulk_open()) {
+        bulk_send_frame(STREAM_FRAME_DUTY, 0, payload, len);
+    }
+}
+
+static void power_init(void)
+{
+    power_mgr_config_t cfg = {
+        .report_s = CONFIG_SCANNER_PM_REPORT_S,
+        .on_report = duty_report_cb,
+    };
+#if CONFIG_SCANNER_PM_ENABLE
+    cfg.max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    cfg.min_freq_mhz = CONFIG_SCANNER_PM_MIN_FREQ_MHZ;
+#if CONFIG_SCANNER_PM_LIGHT_SLEEP
+    cfg.light_sleep = true;
+#endif
+#endif
+
+    if (power_mgr_init(&cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Power management unavailable");
+    }
+}
+
+/* ===================== DEFERRED LOG ===================== */
+static bool dlog_sink(const uint8_t *payload, size_t len, void *arg)
+{
+    if (!bulk_open()) {
+        return false;
+    }
+    bulk_send_frame(STREAM_FRAME_LOG, 0, payload, len);
+    return true;
+}
+
+static void dlog_init(void)
+{
+    const dlog_config_t cfg = {
+        .sink = dlog_sink,
+    };
+
+    if (dlog_start(&cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Deferred log unavailable");
     }
 }
 
@@ -120,8 +1572,107 @@ void wifi_scan_task(void *arg)
 void app_main(void)
 {
     nvs_flash_init();
+    power_init();
+    dlog_init();
+    const scan_sched_config_t sched_cfg = {
+        .report_s = CONFIG_SCANNER_SCHED_REPORT_S,
+    };
+    ESP_ERROR_CHECK(scan_sched_init(&sched_cfg));
+#if CONFIG_SCANNER_FP_ENABLE
+    fp_init();
+#endif
+
+    // Load before BLE starts so an early subscriber already gets the snapshot
+    boot_cache_valid = scan_cache_load(&boot_cache) == ESP_OK;
+
+    ap_table_init(&ap_table);
+    ap_table_lock = xSemaphoreCreateMutex();
+#if CONFIG_SCANNER_DISTANCE_ENABLE
+    rssi_distance_model_t distance_dflt;
+    rssi_distance_model_init(&distance_dflt, CONFIG_SCANNER_DISTANCE_TX_DBM * 16,
+                             (CONFIG_SCANNER_DISTANCE_EXPONENT_X10 * 256 + 5) / 10);
+    rssi_distance_cal_init(&distance_cal, distance_cal_storage, CONFIG_SCANNER_DISTANCE_CAL_MAX,
+                           &distance_dflt);
+    size_t n_cal = rssi_distance_cal_add_list(&distance_cal, CONFIG_SCANNER_DISTANCE_CAL);
+    ap_table.distance_cal = &distance_cal;
+    ESP_LOGI(TAG, "Distance model: %d dBm at 1 m, n %d.%d, %u calibrated APs",
+             CONFIG_SCANNER_DISTANCE_TX_DBM, CONFIG_SCANNER_DISTANCE_EXPONENT_X10 / 10,
+             CONFIG_SCANNER_DISTANCE_EXPONENT_X10 % 10, (unsigned)n_cal);
+#endif
+#if CONFIG_SCANNER_OUI_ENABLE
+    // Captured and tracked records only pass through the table
+    ap_table.oui_db = &oui_db_builtin;
+    ESP_LOGI(TAG, "OUI index: %u vendors, %u bytes of flash, version %08lx",
+             oui_db_builtin.n_vendors, (unsigned)oui_db_footprint(&oui_db_builtin),
+             (unsigned long)oui_db_builtin.version);
+#endif
+    ap_snapshot_init(&ap_snapshot);
+
+    const link_tuner_config_t link_cfg = {
+        .fast_itvl = CONFIG_SCANNER_BLE_CONN_ITVL_FAST,
+        .idle_itvl = CONFIG_SCANNER_BLE_CONN_ITVL_IDLE,
+        .high_water = CONFIG_SCANNER_BLE_BACKLOG_HIGH,
+        .idle_hold_ms = CONFIG_SCANNER_BLE_IDLE_HOLD_MS,
+        .min_request_gap_ms = LINK_REQUEST_GAP_MS,
+    };
+    link_tuner_init(&link_tuner, &link_cfg, esp_timer_get_time());
+    notify_queue = xQueueCreate(CONFIG_SCANNER_BLE_TX_QUEUE_LEN, sizeof(notify_item_t));
+    alert_queue = xQueueCreate(NOTIFY_ALERT_QUEUE_LEN, sizeof(notify_item_t));
+    notify_set = xQueueCreateSet(CONFIG_SCANNER_BLE_TX_QUEUE_LEN + NOTIFY_ALERT_QUEUE_LEN);
+    xQueueAddToSet(notify_queue, notify_set);
+    xQueueAddToSet(alert_queue, notify_set);
+    xTaskCreate(notify_tx_task, "notify_tx", 3072, NULL, 6, NULL);
+#if CONFIG_SCANNER_ALERT_ENABLE
+    alert_init();
+#endif
+#if CONFIG_SCANNER_BLE_L2CAP
+    bulk_init();
+#endif
+
     wifi_init();
     ble_init();
 
+#if CONFIG_SCANNER_MODE_PASSIVE_CAPTURE
+    wifi_capture_config_t capture_cfg = {
+        .table = &ap_table,
+        .table_lock = ap_table_lock,
+        .dwell_ms = CONFIG_SCANNER_CAPTURE_DWELL_MS,
+    };
+#if CONFIG_SCANNER_CLIENT_COUNT
+    client_lock = xSemaphoreCreateMutex();
+    client_counter_init(&client_counter, CONFIG_SCANNER_CLIENT_WINDOW_SHORT_S * 1000000LL,
+                        CONFIG_SCANNER_CLIENT_WINDOW_LONG_S * 1000000LL, esp_timer_get_time());
+    capture_cfg.probe_req_cb = probe_req_cb;
+#endif
+#if CONFIG_SCANNER_ALERT_ENABLE
+    capture_cfg.bss_cb = capture_bss_cb;
+#endif
+    ESP_ERROR_CHECK(wifi_capture_start(&capture_cfg));
+    xTaskCreate(capture_report_task, "capture_report", 4096, NULL, 5, NULL);
+#elif CONFIG_SCANNER_MODE_TRACKING
+    watchlist_init(&track_list, track_storage, TRACK_MAX_BSSIDS);
+    if (watchlist_add_list(&track_list, CONFIG_SCANNER_TRACK_BSSIDS) == 0) {
+        ESP_LOGE(TAG, "No valid BSSIDs in CONFIG_SCANNER_TRACK_BSSIDS");
+        return;
+    }
+    wifi_tracker_config_t tracker_cfg = {
+        .watchlist = &track_list,
+        .table = &ap_table,
+        .table_lock = ap_table_lock,
+        .dwell_ms = CONFIG_SCANNER_TRACK_DWELL_MS,
+        .rate_hz = CONFIG_SCANNER_TRACK_RATE_HZ,
+        .sweep_period_ms = CONFIG_SCANNER_TRACK_SWEEP_S * 1000,
+        .on_update = tracker_update_cb,
+    };
+#if CONFIG_SCANNER_ALERT_ENABLE
+    tracker_cfg.on_record = tracker_record_cb;
+    // Watched APs that are not targets are only heard on sweeps
+    alert_set_sighting_period(CONFIG_SCANNER_TRACK_SWEEP_S * 1000);
+#endif
+    ESP_ERROR_CHECK(wifi_tracker_start(&tracker_cfg));
+#elif CONFIG_SCANNER_MODE_SYNTHETIC_LOAD
+    xTaskCreate(synth_task, "synth", 4096, NULL, 5, NULL);
+#else
     xTaskCreate(wifi_scan_task, "wifi_scan", 4096, NULL, 5, NULL);
+#endif
 }
@@ -0,0 +1,189 @@
+/* ===================== DEFERRED LOG BENCHMARK =====================
+ * Host check and speed test of the deferred log ring (dlog_ring.h):
+ *   - several producer threads against one consumer; every entry must
+ *     arrive exactly once and in order per producer (producers retry
+ *     while the ring is full; each refusal counts as a drop)
+ *   - wire encode/decode and offline formatting must reproduce printf
+ *   - cost of one push against formatting the same line with snprintf
+ *
+ * Build:
+ *   cc -O2 -pthread -Icomponents/scanner/include -o dlog_bench \
+ *      tools/dlog_bench.c components/scanner/dlog_ring.c
+ *
+ * Usage:
+ *   dlog_bench [entries per producer]
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dlog_ring.h"
+
+#define PRODUCERS       4
+#define RING_SLOTS      256
+
+static dlog_slot_t slots[RING_SLOTS];
+static dlog_ring_t ring;
+static unsigned long per_producer = 200000;
+static atomic_int producers_done;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *producer(void *arg)
+{
+    uint32_t p = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t seq = 0; seq < per_producer; seq++) {
+        uint32_t args[2] = { p, seq };
+        while (!dlog_ring_push(&ring, seq, DLOG_EV_SCAN_CYCLE, args, 2)) {
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(&producers_done, 1);
+    return NULL;
+}
+
+static int check_concurrent(void)
+{
+    pthread_t threads[PRODUCERS];
+    int64_t last[PRODUCERS];
+    unsigned long popped = 0, bad = 0;
+
+    dlog_ring_init(&ring, slots, RING_SLOTS);
+    atomic_init(&producers_done, 0);
+    for (int p = 0; p < PRODUCERS; p++) {
+        last[p] = -1;
+        pthread_create(&threads[p], NULL, producer, (void *)(uintptr_t)p);
+    }
+
+    dlog_entry_t e;
+    while (1) {
+        // Read done before popping, so nothing published earlier is missed
+        int done = atomic_load(&producers_done) == PRODUCERS;
+        int got = 0;
+        while (dlog_ring_pop(&ring, &e)) {
+            got = 1;
+            popped++;
+            uint32_t p = e.args[0];
+            if (e.nargs != 2 || p >= PRODUCERS || (int64_t)e.args[1] <= last[p] ||
+                e.timestamp_us != e.args[1]) {
+                bad++;
+                continue;
+            }
+            if (e.args[1] != last[p] + 1) {
+                bad++;
+            }
+            last[p] = e.args[1];
+        }
+        if (done && !got) {
+            break;
+        }
+    }
+    for (int p = 0; p < PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+
+    unsigned long dropped = atomic_load(&ring.dropped);
+    printf("concurrent: %d producers x %lu, %lu popped, %lu refused while full, %lu bad\n",
+           PRODUCERS, per_producer, popped, dropped, bad);
+    return bad == 0 && popped == PRODUCERS * per_producer ? 0 : 1;
+}
+
+static int check_format(void)
+{
+    dlog_entry_t e = {
+        .timestamp_us = 123456789,
+        .id = DLOG_EV_SCAN_INTERVAL,
+        .nargs = 6,
+        .args = { (uint32_t)-7, 4000, 12, 3, 0, 9 },
+    };
+    uint8_t wire[DLOG_WIRE_HDR_LEN + DLOG_WIRE_ENTRY_MAX];
+    size_t len = DLOG_WIRE_HDR_LEN + dlog_encode_entry(&e, wire + DLOG_WIRE_HDR_LEN,
+                                                       sizeof(wire) - DLOG_WIRE_HDR_LEN);
+    dlog_encode_finish(wire, 5, 1);
+
+    uint32_t dropped;
+    uint8_t n;
+    dlog_entry_t d;
+    size_t off = dlog_decode_header(wire, len, &dropped, &n);
+    if (off == 0 || n != 1 || dropped != 5 || dlog_decode_entry(wire + off, len - off, &d) == 0 ||
+        memcmp(&d, &e, sizeof(d)) != 0) {
+        printf("format: wire round trip failed\n");
+        return 1;
+    }
+
+    char got[160], want[160];
+    dlog_format(&d, got, sizeof(got));
+    snprintf(want, sizeof(want),
+             "Churn %d/1000, next scan in %u ms, radio duty %u.%u%% (fixed 5 s: %u.%u%%)",
+             -7, 4000, 12, 3, 0, 9);
+    printf("format: \"%s\"\n", got);
+
+    // Short buffers truncate like snprintf and report the full length
+    char small[8];
+    int full = dlog_format(&d, small, sizeof(small));
+    return strcmp(got, want) != 0 || full != (int)strlen(want) || strlen(small) != 7;
+}
+
+static void bench(void)
+{
+    const unsigned long iters = per_producer;
+    static const char ssid[] = "Some network name";
+    static char sink[128];
+    volatile size_t keep = 0;
+    dlog_entry_t e;
+
+    dlog_ring_init(&ring, slots, RING_SLOTS);
+    double t0 = now_s();
+    for (unsigned long i = 0; i < iters; i++) {
+        const uint32_t args[] = { 0xa4b1c2, (uint32_t)i, (uint32_t)-60, 6, 2, 3 };
+        dlog_ring_push(&ring, (uint32_t)i, DLOG_EV_SCAN_AP, args, 6);
+        // Popping in line keeps the ring from filling, so the figure is
+        // push plus pop, an upper bound for the producer side
+        if ((i & (RING_SLOTS / 2 - 1)) == 0) {
+            while (dlog_ring_pop(&ring, &e)) {
+                keep += e.nargs;
+            }
+        }
+    }
+    double t_push = now_s() - t0;
+
+    t0 = now_s();
+    for (unsigned long i = 0; i < iters; i++) {
+        keep += snprintf(sink, sizeof(sink), "%2d: %-32s (%3d dBm) Ch:%2d %u/%u\n",
+                         (int)(i % 20), ssid, -60, 6, 2u, 3u);
+    }
+    double t_fmt = now_s() - t0;
+
+    t0 = now_s();
+    for (unsigned long i = 0; i < iters; i++) {
+        keep += dlog_format(&e, sink, sizeof(sink));
+    }
+    double t_offline = now_s() - t0;
+
+    printf("push+pop %.1f ns, snprintf %.1f ns, offline format %.1f ns per line\n",
+           t_push * 1e9 / iters, t_fmt * 1e9 / iters, t_offline * 1e9 / iters);
+    (void)keep;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        per_producer = strtoul(argv[1], NULL, 10);
+    }
+
+    int fail = check_concurrent();
+    fail |= check_format();
+    bench();
+
+    printf("%s\n", fail ? "FAIL" : "OK");
+    return fail;
+}
@@ -0,0 +1,401 @@
+/* ===================== FINGERPRINT MATCH BENCHMARK =====================
+ * Host check and speed test of on-device fingerprint matching (fp_db.h)
+ * over synthetic surveys of 1k-10k fingerprints:
+ *   - a building with randomly placed APs, survey locations on a grid,
+ *     log-distance path loss with fixed per-link shadowing plus per-sample
+ *     noise; each location is sampled several times
+ *   - tables packed exactly as tools/fp_gen.py lays them out, plus a
+ *     per-fingerprint (forward) copy of the same survey
+ *   - queries are fresh samples near random survey locations (partly
+ *     decorrelated shadowing, a per-device gain offset, noise) plus a
+ *     few APs missing from the survey; -r keeps only the strongest
+ *     records, as a scan report would
+ *   - fp_db_match over the posting lists must return exactly what a
+ *     plain scan of the forward copy returns, distances summed term by
+ *     term; reports time per query for both, the share of postings read,
+ *     top-1 hit rate and position error
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o fp_bench tools/fp_bench.c \
+ *      components/scanner/fp_db.c -lm
+ *
+ * Usage:
+ *   fp_bench [-n fps,fps,...] [-a aps] [-s samples] [-r records] [-q queries] [-k k]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fp_db.h"
+
+#define BUILDING_M          120.0
+#define FLOOR_DBM           -95
+#define STEP_DB             2
+#define MAX_APS_PER_FP      48      // fp_gen.py --max-aps default
+#define SHADOW_DB           5.0
+#define NOISE_DB            3.0
+#define UNKNOWN_PER_QUERY   2
+#define QUERY_RHO           0.8     // shadowing correlation with the survey point
+#define DEVICE_BIAS_DB      3.0
+
+typedef struct {
+    double x, y;
+} point_t;
+
+typedef struct {
+    size_t n_aps;
+    point_t *ap;
+    uint8_t (*bssid)[6];            // sorted
+    size_t n_locs;
+    point_t *loc;
+    float *shadow;                  // n_locs x n_aps
+
+    // Packed database, as generated
+    uint32_t *post;
+    uint16_t *post_fp;
+    uint8_t *post_q;
+    uint16_t *loc_id;
+    uint32_t *norm2;
+    fp_db_t db;
+
+    // Forward copy: per fingerprint, its entries
+    uint32_t *offset;
+    uint16_t *idx;
+    uint8_t *q;
+} site_t;
+
+static uint64_t rng_state = 0x853c49e6748fea9bULL;
+
+static uint64_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static double uniform(void)
+{
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double gauss(void)
+{
+    double u = uniform(), v = uniform();
+    return sqrt(-2 * log(u + 1e-300)) * cos(2 * M_PI * v);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_bssid(const void *a, const void *b)
+{
+    return memcmp(a, b, 6);
+}
+
+// One sighting set at location l: records above the floor, strongest
+// first. rho < 1 decorrelates the shadowing (a spot near the survey
+// point); bias_db is the receiving device's gain offset.
+static size_t sample(const site_t *s, size_t l, double rho, double bias_db, scan_record_t *out,
+                     size_t cap)
+{
+    size_t n = 0;
+
+    for (size_t a = 0; a < s->n_aps; a++) {
+        double d = hypot(s->ap[a].x - s->loc[l].x, s->ap[a].y - s->loc[l].y);
+        double shadow = s->shadow[l * s->n_aps + a];
+        if (rho < 1) {
+            shadow = rho * shadow + sqrt(1 - rho * rho) * SHADOW_DB * gauss();
+        }
+        double rssi = -38 - 30 * log10(d < 1 ? 1 : d) + shadow + bias_db + NOISE_DB * gauss();
+        if (rssi <= FLOOR_DBM) {
+            continue;
+        }
+
+        // Insertion into a strongest-first list of at most cap
+        int8_t r = (int8_t)lround(rssi > -20 ? -20 : rssi);
+        size_t i = n < cap ? n++ : cap;
+        while (i > 0 && out[i - 1].rssi < r) {
+            if (i < cap) {
+                out[i] = out[i - 1];
+            }
+            i--;
+        }
+        if (i < cap) {
+            memset(&out[i], 0, sizeof(out[i]));
+            memcpy(out[i].bssid, s->bssid[a], 6);
+            out[i].rssi = r;
+        }
+    }
+    return n;
+}
+
+static void site_build(site_t *s, size_t n_fps, size_t n_aps, size_t samples)
+{
+    memset(s, 0, sizeof(*s));
+    s->n_aps = n_aps;
+    s->ap = malloc(n_aps * sizeof(point_t));
+    s->bssid = malloc(n_aps * 6);
+    for (size_t a = 0; a < n_aps; a++) {
+        s->ap[a] = (point_t){ uniform() * BUILDING_M, uniform() * BUILDING_M };
+        uint64_t r = rng();
+        memcpy(s->bssid[a], &r, 6);
+        s->bssid[a][0] &= 0xFC;
+    }
+    qsort(s->bssid, n_aps, 6, cmp_bssid);
+
+    s->n_locs = (n_fps + samples - 1) / samples;
+    int grid = (int)ceil(sqrt((double)s->n_locs));
+    s->loc = malloc(s->n_locs * sizeof(point_t));
+    s->shadow = malloc(s->n_locs * n_aps * sizeof(float));
+    for (size_t l = 0; l < s->n_locs; l++) {
+        s->loc[l] = (point_t){ (l % grid + 0.5) * BUILDING_M / grid,
+                               (l / grid + 0.5) * BUILDING_M / grid };
+        for (size_t a = 0; a < n_aps; a++) {
+            s->shadow[l * n_aps + a] = (float)(SHADOW_DB * gauss());
+        }
+    }
+
+    s->db = (fp_db_t){ .n_bssids = (uint16_t)n_aps, .n_fps = (uint16_t)n_fps,
+                       .floor_dbm = FLOOR_DBM, .step_db = STEP_DB, .bssids = &s->bssid[0][0] };
+
+    // Survey, forward: fingerprints in location order, as the generator numbers them
+    scan_record_t recs[MAX_APS_PER_FP];
+    s->offset = malloc((n_fps + 1) * sizeof(uint32_t));
+    s->idx = malloc(n_fps * MAX_APS_PER_FP * sizeof(uint16_t));
+    s->q = malloc(n_fps * MAX_APS_PER_FP);
+    s->loc_id = malloc(n_fps * sizeof(uint16_t));
+    s->norm2 = calloc(n_fps, sizeof(uint32_t));
+    s->post = calloc(n_aps + 1, sizeof(uint32_t));
+    uint32_t off = 0;
+    for (size_t f = 0; f < n_fps; f++) {
+        size_t n = sample(s, f / samples, 1, 0, recs, MAX_APS_PER_FP);
+        s->offset[f] = off;
+        s->loc_id[f] = (uint16_t)(f / samples);
+        for (size_t i = 0; i < n; i++) {
+            uint16_t d = (uint16_t)fp_db_find(&s->db, recs[i].bssid);
+            uint8_t v = fp_db_quantize(&s->db, recs[i].rssi);
+            s->idx[off] = d;
+            s->q[off++] = v;
+            s->norm2[f] += (uint32_t)v * v;
+            s->post[d + 1]++;
+        }
+    }
+    s->offset[n_fps] = off;
+
+    // Inverted: counts to starts, then fill; lists come out in fingerprint order
+    for (size_t a = 0; a < n_aps; a++) {
+        s->post[a + 1] += s->post[a];
+    }
+    uint32_t *fill = malloc(n_aps * sizeof(uint32_t));
+    memcpy(fill, s->post, n_aps * sizeof(uint32_t));
+    s->post_fp = malloc(off * sizeof(uint16_t));
+    s->post_q = malloc(off);
+    for (size_t f = 0; f < n_fps; f++) {
+        for (uint32_t e = s->offset[f]; e < s->offset[f + 1]; e++) {
+            uint32_t p = fill[s->idx[e]]++;
+            s->post_fp[p] = (uint16_t)f;
+            s->post_q[p] = s->q[e];
+        }
+    }
+    free(fill);
+
+    s->db.n_postings = off;
+    s->db.post = s->post;
+    s->db.fp = s->post_fp;
+    s->db.q = s->post_q;
+    s->db.loc = s->loc_id;
+    s->db.norm2 = s->norm2;
+}
+
+static void site_free(site_t *s)
+{
+    free(s->ap);
+    free(s->bssid);
+    free(s->loc);
+    free(s->shadow);
+    free(s->post);
+    free(s->post_fp);
+    free(s->post_q);
+    free(s->loc_id);
+    free(s->norm2);
+    free(s->offset);
+    free(s->idx);
+    free(s->q);
+}
+
+// Reference and baseline: every fingerprint, term by term over the union
+// of APs, then the k nearest distinct locations (ties to the lower index)
+static size_t match_forward(const site_t *s, const fp_query_t *q, uint8_t *dense,
+                            uint32_t *dist, fp_match_t *out, size_t k)
+{
+    for (uint8_t i = 0; i < q->n; i++) {
+        dense[q->idx[i]] = q->q[i];
+    }
+    for (uint32_t f = 0; f < s->db.n_fps; f++) {
+        uint32_t sum = 0, heard2 = 0;
+        for (uint32_t e = s->offset[f]; e < s->offset[f + 1]; e++) {
+            int32_t v = dense[s->idx[e]];
+            int32_t d = (int32_t)s->q[e] - v;
+            sum += (uint32_t)(d * d);
+            heard2 += (uint32_t)(v * v);
+        }
+        dist[f] = sum + q->norm2 - heard2;
+    }
+    for (uint8_t i = 0; i < q->n; i++) {
+        dense[q->idx[i]] = 0;
+    }
+
+    size_t n = 0;
+    for (; n < k; n++) {
+        uint32_t best = UINT32_MAX;
+        for (uint32_t f = 0; f < s->db.n_fps; f++) {
+            if (dist[f] == UINT32_MAX) {
+                continue;
+            }
+            int taken = 0;
+            for (size_t j = 0; j < n; j++) {
+                taken |= out[j].loc == s->loc_id[f];
+            }
+            if (!taken && (best == UINT32_MAX || dist[f] < dist[best])) {
+                best = f;
+            }
+        }
+        if (best == UINT32_MAX) {
+            break;
+        }
+        out[n] = (fp_match_t){ .loc = s->loc_id[best], .dist = dist[best] };
+    }
+    return n;
+}
+
+static int run(size_t n_fps, size_t n_aps, size_t samples, size_t records, size_t queries,
+               size_t k)
+{
+    site_t s;
+    site_build(&s, n_fps, n_aps, samples);
+
+    fp_query_t *qs = calloc(queries, sizeof(fp_query_t));
+    size_t *truth = malloc(queries * sizeof(size_t));
+    scan_record_t recs[FP_QUERY_MAX];
+
+    // Queries are built up front so the timing covers matching only
+    for (size_t i = 0; i < queries; i++) {
+        truth[i] = rng() % s.n_locs;
+        size_t n = sample(&s, truth[i], QUERY_RHO, DEVICE_BIAS_DB * gauss(), recs, records);
+        for (size_t u = 0; u < UNKNOWN_PER_QUERY && n < FP_QUERY_MAX; u++) {
+            memset(&recs[n], 0, sizeof(recs[n]));
+            recs[n].bssid[0] = 0x02;        // locally administered: never surveyed
+            recs[n].bssid[5] = (uint8_t)u;
+            recs[n++].rssi = -70;
+        }
+        fp_query_load(&s.db, &qs[i], recs, n);
+    }
+
+    uint32_t *acc = malloc(n_fps * sizeof(uint32_t));
+    uint32_t *dist = malloc(n_fps * sizeof(uint32_t));
+    uint8_t *dense = calloc(n_aps, 1);
+    fp_match_t got[FP_MATCH_MAX], want[FP_MATCH_MAX];
+    fp_match_stats_t st = { 0 };
+    size_t mismatches = 0, hits = 0;
+    double err_m = 0;
+
+    double t0 = now_s();
+    for (size_t i = 0; i < queries; i++) {
+        fp_db_match(&s.db, &qs[i], acc, got, k, &st);
+    }
+    double t_inv = now_s() - t0;
+
+    t0 = now_s();
+    for (size_t i = 0; i < queries; i++) {
+        match_forward(&s, &qs[i], dense, dist, want, k);
+    }
+    double t_fwd = now_s() - t0;
+
+    for (size_t i = 0; i < queries; i++) {
+        size_t n = fp_db_match(&s.db, &qs[i], acc, got, k, NULL);
+        size_t m = match_forward(&s, &qs[i], dense, dist, want, k);
+        int same = n == m;
+        for (size_t j = 0; same && j < n; j++) {
+            same = got[j].loc == want[j].loc && got[j].dist == want[j].dist;
+        }
+        mismatches += !same;
+        if (n > 0) {
+            hits += got[0].loc == truth[i];
+            err_m += hypot(s.loc[got[0].loc].x - s.loc[truth[i]].x,
+                           s.loc[got[0].loc].y - s.loc[truth[i]].y);
+        }
+    }
+
+    printf("%6zu %6zu %6.1f %9zu %10.2f %10.2f %7.1fx %8.1f%% %8.1f%% %6.1f%% %7.2f %6zu\n",
+           n_fps, s.n_locs, BUILDING_M / ceil(sqrt((double)s.n_locs)),
+           fp_db_footprint(&s.db), t_inv * 1e6 / queries, t_fwd * 1e6 / queries,
+           t_fwd / t_inv, 100.0 * st.postings / ((double)queries * s.db.n_postings),
+           100.0 * st.touched / ((double)queries * n_fps), 100.0 * hits / queries,
+           err_m / queries, mismatches);
+
+    free(acc);
+    free(dist);
+    free(dense);
+    free(qs);
+    free(truth);
+    site_free(&s);
+    return mismatches != 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *sizes = "1000,2000,5000,10000";
+    size_t n_aps = 600, samples = 4, records = MAX_APS_PER_FP, queries = 2000, k = 3;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:a:s:r:q:k:")) != -1) {
+        switch (opt) {
+        case 'n': sizes = optarg; break;
+        case 'a': n_aps = strtoul(optarg, NULL, 10); break;
+        case 's': samples = strtoul(optarg, NULL, 10); break;
+        case 'r': records = strtoul(optarg, NULL, 10); break;
+        case 'q': queries = strtoul(optarg, NULL, 10); break;
+        case 'k': k = strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: %s [-n fps,...] [-a aps] [-s samples] [-r records] "
+                    "[-q queries] [-k k]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n_aps == 0 || n_aps > UINT16_MAX || samples == 0 || records == 0 ||
+        records > FP_QUERY_MAX - UNKNOWN_PER_QUERY || queries == 0 || k == 0 ||
+        k > FP_MATCH_MAX) {
+        fprintf(stderr, "bad arguments\n");
+        return 2;
+    }
+
+    printf("%zu APs over %.0f m, %zu samples per location, %zu strongest records per query, "
+           "top %zu\n", n_aps, BUILDING_M, samples, records, k);
+    printf("%6s %6s %6s %9s %10s %10s %8s %9s %9s %7s %7s %6s\n", "fps", "locs", "grid m",
+           "flash B", "us match", "us scan", "speedup", "postings", "touched", "top-1",
+           "err m", "diffs");
+
+    int fail = 0;
+    char *list = strdup(sizes);
+    for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        size_t n = strtoul(tok, NULL, 10);
+        if (n == 0 || n > FP_DB_MAX_FPS) {
+            fprintf(stderr, "bad size %s\n", tok);
+            fail = 1;
+            continue;
+        }
+        fail |= run(n, n_aps, samples, records, queries, k);
+    }
+    free(list);
+
+    printf("%s\n", fail ? "FAIL" : "OK");
+    return fail;
+}
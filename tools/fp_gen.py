@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Fingerprint database generator (see components/scanner/include/fp_db.h).
+
+Reads a site survey CSV with columns location,sample,bssid,rssi: one row
+per AP heard, where location is a numeric location ID (0-65535) and sample
+names one scan taken there. Each (location, sample) becomes a fingerprint
+over its strongest APs; readings at or below the floor are dropped. Writes
+a C file defining `fp_db_builtin`: the sorted BSSID dictionary, one
+posting list per AP, and per-fingerprint location IDs and norms.
+
+Run by the scanner component's CMake build; by hand for host tools:
+  python3 tools/fp_gen.py components/scanner/data/fingerprints.csv -o fp_db_data.c
+
+Options:
+  --floor DBM       weakest reading kept, also the quantisation origin (default -95)
+  --step DB         quantisation step in dB (default 2)
+  --max-aps N       strongest APs kept per fingerprint (default 48)
+"""
+import argparse
+import csv
+import sys
+import zlib
+
+MAX_FPS = 0xFFFF        # FP_DB_MAX_FPS: posting entries hold a u16 index
+
+
+# Must match fp_db_quantize in fp_db.h
+def quantize(rssi, floor, step):
+    q = (rssi - floor + step // 2) // step
+    return max(1, min(255, q))
+
+
+def parse_bssid(text):
+    parts = text.strip().replace("-", ":").split(":")
+    if len(parts) != 6:
+        raise ValueError(text)
+    return bytes(int(p, 16) for p in parts)
+
+
+def read_survey(path, floor):
+    samples = {}
+    rows = []
+    with open(path, newline="", encoding="utf-8") as f:
+        for line, row in enumerate(csv.reader(f), 1):
+            if len(row) < 4 or row[0].strip().startswith("#") or row[0].strip() == "location":
+                continue
+            try:
+                loc = int(row[0])
+                bssid = parse_bssid(row[2])
+                rssi = int(row[3])
+            except ValueError:
+                sys.exit("fp_gen: %s:%d: bad row" % (path, line))
+            if not 0 <= loc <= 0xFFFF:
+                sys.exit("fp_gen: %s:%d: location out of range" % (path, line))
+            if rssi <= floor:
+                continue
+            key = (loc, row[1].strip())
+            aps = samples.setdefault(key, {})
+            aps[bssid] = max(rssi, aps.get(bssid, rssi))
+            rows.append((loc, row[1].strip(), bssid.hex(), rssi))
+    return samples, rows
+
+
+def c_bytes(data, indent="    ", per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join("0x%02x" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def c_words(values, indent="    ", per_line=12):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ", ".join(str(v) for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("csv")
+    ap.add_argument("-o", "--output", required=True)
+    ap.add_argument("--floor", type=int, default=-95)
+    ap.add_argument("--step", type=int, default=2)
+    ap.add_argument("--max-aps", type=int, default=48)
+    args = ap.parse_args()
+    if not -128 <= args.floor <= 0 or not 1 <= args.step <= 255 or args.max_aps < 1:
+        sys.exit("fp_gen: bad --floor, --step or --max-aps")
+
+    samples, rows = read_survey(args.csv, args.floor)
+    if not samples:
+        sys.exit("fp_gen: no fingerprints in %s" % args.csv)
+    if len(samples) > MAX_FPS:
+        sys.exit("fp_gen: more than %d fingerprints" % MAX_FPS)
+
+    # Fingerprints in (location, sample) order; strongest APs only
+    fps = []
+    for key in sorted(samples):
+        aps = sorted(samples[key].items(), key=lambda kv: (-kv[1], kv[0]))[:args.max_aps]
+        fps.append((key[0], [(b, quantize(r, args.floor, args.step)) for b, r in aps]))
+
+    bssids = sorted({b for _, entries in fps for b, _ in entries})
+    if len(bssids) > 0xFFFF:
+        sys.exit("fp_gen: more than 65535 BSSIDs")
+    index = {b: i for i, b in enumerate(bssids)}
+
+    lists = [[] for _ in bssids]
+    norm2 = []
+    for f, (_, entries) in enumerate(fps):
+        norm2.append(sum(q * q for _, q in entries))
+        for b, q in entries:
+            lists[index[b]].append((f, q))
+    post = [0]
+    for lst in lists:
+        post.append(post[-1] + len(lst))
+
+    crc = 0
+    for row in sorted(rows):
+        crc = zlib.crc32(b"%d,%s,%s,%d\n" % (row[0], row[1].encode(), row[2].encode(), row[3]), crc)
+
+    out = []
+    out.append("// Generated by tools/fp_gen.py from %s; do not edit" % args.csv.replace("\\", "/").split("/")[-1])
+    out.append("// %d fingerprints, %d locations, %d BSSIDs, %d postings"
+               % (len(fps), len({loc for loc, _ in fps}), len(bssids), post[-1]))
+    out.append('#include "fp_db.h"')
+    out.append("")
+    out.append("static const uint8_t bssids[%d] = {" % (len(bssids) * 6))
+    out.append(c_bytes(b"".join(bssids), per_line=12))
+    out.append("};")
+    out.append("")
+    out.append("static const uint32_t post[%d] = {" % len(post))
+    out.append(c_words(post))
+    out.append("};")
+    out.append("")
+    out.append("static const uint16_t post_fp[%d] = {" % post[-1])
+    out.append(c_words([f for lst in lists for f, _ in lst]))
+    out.append("};")
+    out.append("")
+    out.append("static const uint8_t post_q[%d] = {" % post[-1])
+    out.append(c_bytes(bytes(q for lst in lists for _, q in lst)))
+    out.append("};")
+    out.append("")
+    out.append("static const uint16_t loc[%d] = {" % len(fps))
+    out.append(c_words([loc for loc, _ in fps]))
+    out.append("};")
+    out.append("")
+    out.append("static const uint32_t norm2[%d] = {" % len(fps))
+    out.append(c_words(norm2))
+    out.append("};")
+    out.append("")
+    out.append("const fp_db_t fp_db_builtin = {")
+    out.append("    .n_bssids = %d," % len(bssids))
+    out.append("    .n_fps = %d," % len(fps))
+    out.append("    .n_postings = %d," % post[-1])
+    out.append("    .floor_dbm = %d," % args.floor)
+    out.append("    .step_db = %d," % args.step)
+    out.append("    .bssids = bssids,")
+    out.append("    .post = post,")
+    out.append("    .fp = post_fp,")
+    out.append("    .q = post_q,")
+    out.append("    .loc = loc,")
+    out.append("    .norm2 = norm2,")
+    out.append("    .version = 0x%08Xu," % crc)
+    out.append("};")
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,329 @@
+/* ===================== HLL CHECK =====================
+ * Host check of the HyperLogLog sketch (hll.h) and the probe-request
+ * client counter built on it (client_counter.h), over synthetic MAC
+ * streams:
+ *   - known cardinalities from 1 to 100k, every MAC sent one to three
+ *     times in shuffled order; at most 1% of the estimates may fall
+ *     outside 3 standard errors (3 x 1.04 / sqrt(m)), none outside 4, and
+ *     the RMS error per cardinality must be within 1.5
+ *   - duplicates leave the registers unchanged; merge gives exactly the
+ *     sketch of the union, is commutative and has the empty sketch as
+ *     identity; clear resets to zero
+ *   - the sliding windows keep clients for the whole window and forget
+ *     them once they age out, including after a long idle gap
+ *   - randomized (locally administered) MACs are counted per probe
+ *     fingerprint, apart from global ones; multicast sources are ignored
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o hll_check tools/hll_check.c \
+ *      components/scanner/hll.c components/scanner/client_counter.c \
+ *      components/scanner/ieee80211_parse.c -lm
+ *
+ * Usage:
+ *   hll_check [trials]
+ * Exits non-zero if any check fails.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "client_counter.h"
+#include "hll.h"
+
+#define MAX_CARD        100000
+#define SLOT_US         1000000LL
+
+static const double std_err = 1.04 / 16.0;     // 1.04 / sqrt(HLL_REGISTERS)
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static int failures;
+
+static uint64_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void check(int ok, const char *what, double detail)
+{
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s (%g)\n", what, detail);
+        failures++;
+    }
+}
+
+// Globally administered unicast, or locally administered (randomized)
+static void random_mac(uint8_t mac[6], int randomized)
+{
+    uint64_t r = rng();
+    memcpy(mac, &r, 6);
+    mac[0] = (mac[0] & ~0x03) | (randomized ? 0x02 : 0x00);
+}
+
+static uint32_t mac_hash(const uint8_t mac[6])
+{
+    return hll_hash_bytes(mac, 6);
+}
+
+/* ===================== ACCURACY ===================== */
+static void check_accuracy(int trials)
+{
+    static const uint32_t cards[] = { 1, 2, 5, 10, 50, 100, 250, 500, 1000, 2000,
+                                      5000, 10000, 50000, 100000 };
+    static uint8_t macs[MAX_CARD][6];
+    static uint32_t order[3 * MAX_CARD];
+
+    int draws = 0, outside = 0;
+
+    printf("%8s %10s %10s %10s\n", "n", "mean est", "rms err", "max err");
+    for (size_t c = 0; c < sizeof(cards) / sizeof(cards[0]); c++) {
+        uint32_t n = cards[c];
+        double sq = 0, sum = 0, worst = 0;
+
+        for (int t = 0; t < trials; t++) {
+            // Each MAC one to three times, shuffled
+            size_t len = 0;
+            for (uint32_t i = 0; i < n; i++) {
+                random_mac(macs[i], 0);
+                for (uint64_t k = 1 + rng() % 3; k > 0; k--) {
+                    order[len++] = i;
+                }
+            }
+            for (size_t i = len; i > 1; i--) {
+                size_t j = rng() % i;
+                uint32_t tmp = order[i - 1];
+                order[i - 1] = order[j];
+                order[j] = tmp;
+            }
+
+            hll_t h;
+            hll_clear(&h);
+            for (size_t i = 0; i < len; i++) {
+                hll_add(&h, mac_hash(macs[order[i]]));
+            }
+            uint32_t est = hll_estimate(&h);
+            double err = ((double)est - n) / n;
+
+            // Below one count the relative bound is meaningless; allow one
+            double dev = fabs(est - (double)n);
+            check(dev <= fmax(4 * std_err * n, 1), "estimate within 4 sigma", err);
+            outside += dev > fmax(3 * std_err * n, 1);
+            draws++;
+            sq += err * err;
+            sum += est;
+            worst = fmax(worst, fabs(err));
+        }
+
+        double rms = sqrt(sq / trials);
+        check(n < 10 || rms <= 1.5 * std_err, "rms error within 1.5 sigma", rms);
+        printf("%8u %10.1f %9.2f%% %9.2f%%\n", n, sum / trials, 100 * rms, 100 * worst);
+    }
+    check(outside * 100 <= draws, "at most 1% of estimates outside 3 sigma", outside);
+}
+
+/* ===================== SKETCH OPERATIONS ===================== */
+static void check_operations(void)
+{
+    hll_t a, b, u, m, empty;
+    uint8_t mac[6];
+
+    hll_clear(&empty);
+    check(hll_estimate(&empty) == 0, "empty sketch estimates 0", hll_estimate(&empty));
+
+    // a: 3000 MACs, b: 2000 of them plus 2000 others, u: the union
+    hll_clear(&a);
+    hll_clear(&b);
+    hll_clear(&u);
+    uint64_t seed = rng_state;
+    for (int i = 0; i < 5000; i++) {
+        random_mac(mac, 0);
+        if (i < 3000) {
+            hll_add(&a, mac_hash(mac));
+        }
+        if (i >= 1000) {
+            hll_add(&b, mac_hash(mac));
+        }
+        hll_add(&u, mac_hash(mac));
+    }
+
+    // The same stream again changes nothing
+    hll_t again = a;
+    rng_state = seed;
+    for (int i = 0; i < 3000; i++) {
+        random_mac(mac, 0);
+        hll_add(&again, mac_hash(mac));
+    }
+    check(memcmp(&again, &a, sizeof(a)) == 0, "duplicates leave registers unchanged", 0);
+
+    m = a;
+    hll_merge(&m, &b);
+    check(memcmp(&m, &u, sizeof(u)) == 0, "merge equals the union's sketch", 0);
+    check(fabs(hll_estimate(&m) - 5000.0) <= 3 * std_err * 5000, "merged estimate",
+          hll_estimate(&m));
+
+    hll_t m2 = b;
+    hll_merge(&m2, &a);
+    check(memcmp(&m, &m2, sizeof(m)) == 0, "merge is commutative", 0);
+
+    hll_t m3 = a;
+    hll_merge(&m3, &empty);
+    check(memcmp(&m3, &a, sizeof(a)) == 0, "merging the empty sketch is identity", 0);
+    hll_merge(&m3, &a);
+    check(memcmp(&m3, &a, sizeof(a)) == 0, "merging a sketch into itself is identity", 0);
+
+    hll_clear(&m);
+    check(memcmp(&m, &empty, sizeof(m)) == 0 && hll_estimate(&m) == 0, "clear resets", 0);
+}
+
+/* ===================== SLIDING WINDOW ===================== */
+static void check_window(void)
+{
+    hll_window_t w;
+    uint8_t mac[6];
+
+    // 1000 clients, all in the first slot
+    hll_window_init(&w, SLOT_US, 0);
+    for (int i = 0; i < 1000; i++) {
+        random_mac(mac, 0);
+        hll_window_add(&w, mac_hash(mac), i * (SLOT_US / 1000));
+    }
+    uint32_t e = hll_window_estimate(&w, SLOT_US / 2);
+    check(fabs(e - 1000.0) <= 3 * std_err * 1000, "window estimate", e);
+
+    // Kept until the slot they landed in rotates out
+    e = hll_window_estimate(&w, HLL_WINDOW_SLOTS * SLOT_US - 1);
+    check(fabs(e - 1000.0) <= 3 * std_err * 1000, "kept for the whole window", e);
+    e = hll_window_estimate(&w, HLL_WINDOW_SLOTS * SLOT_US);
+    check(e == 0, "forgotten once aged out", e);
+
+    // New clients after that count alone
+    for (int i = 0; i < 300; i++) {
+        random_mac(mac, 0);
+        hll_window_add(&w, mac_hash(mac), HLL_WINDOW_SLOTS * SLOT_US + i);
+    }
+    e = hll_window_estimate(&w, (HLL_WINDOW_SLOTS + 1) * SLOT_US);
+    check(fabs(e - 300.0) <= 3 * std_err * 300, "only new clients after ageing", e);
+
+    // A long idle gap clears everything at once, and adding works after it
+    e = hll_window_estimate(&w, 1000 * SLOT_US);
+    check(e == 0, "cleared after a long gap", e);
+    random_mac(mac, 0);
+    hll_window_add(&w, mac_hash(mac), 1000 * SLOT_US + 1);
+    e = hll_window_estimate(&w, 1000 * SLOT_US + 2);
+    check(e == 1, "counting resumes after a gap", e);
+
+    // Re-initialising resets
+    hll_window_init(&w, SLOT_US, 0);
+    check(hll_window_estimate(&w, 0) == 0, "window init resets", 0);
+}
+
+/* ===================== CLIENT COUNTER ===================== */
+typedef struct {
+    uint8_t frame[IEEE80211_MGMT_HDR_LEN + 64];
+    ieee80211_mgmt_t mgmt;
+} probe_t;
+
+// A probe request from sa; device picks the stable IEs, ssid varies
+static void probe_build(probe_t *p, const uint8_t sa[6], uint32_t device, uint8_t ssid)
+{
+    uint8_t *b = p->frame + IEEE80211_MGMT_HDR_LEN;
+    size_t len = 0;
+
+    memset(p->frame, 0, sizeof(p->frame));
+    p->frame[0] = IEEE80211_STYPE_PROBE_REQ << 4;
+    memset(p->frame + 4, 0xFF, 6);
+    memcpy(p->frame + 10, sa, 6);
+    memset(p->frame + 16, 0xFF, 6);
+
+    b[len++] = IEEE80211_IE_SSID;                   // volatile: ignored
+    b[len++] = 1;
+    b[len++] = ssid;
+    b[len++] = 1;                                   // supported rates
+    b[len++] = 4;
+    memcpy(b + len, "\x82\x84\x8b\x96", 4);
+    len += 4;
+    b[len++] = 45;                                  // HT capabilities, per device
+    b[len++] = 4;
+    memcpy(b + len, &device, 4);
+    len += 4;
+
+    ieee80211_parse_mgmt(p->frame, IEEE80211_MGMT_HDR_LEN + len, false, &p->mgmt);
+}
+
+static void check_client_counter(void)
+{
+    const int64_t short_us = 4 * SLOT_US, long_us = 40 * SLOT_US;
+    client_counter_t cc;
+    client_counts_t n;
+    probe_t p;
+    uint8_t mac[6];
+
+    client_counter_init(&cc, short_us, long_us, 0);
+    client_counter_get(&cc, 0, &n);
+    check(n.global[CLIENT_WINDOW_SHORT] == 0 && n.randomized[CLIENT_WINDOW_LONG] == 0 &&
+          n.probes == 0, "counter starts empty", 0);
+
+    // 800 global clients, several probes each
+    for (int i = 0; i < 800; i++) {
+        random_mac(mac, 0);
+        for (int k = 0; k < 3; k++) {
+            probe_build(&p, mac, (uint32_t)i, (uint8_t)k);
+            client_counter_add(&cc, &p.mgmt, i * 100 + k);
+        }
+    }
+    // 60 randomized devices, a fresh MAC and SSID on every probe
+    for (int i = 0; i < 60 * 20; i++) {
+        random_mac(mac, 1);
+        probe_build(&p, mac, 0x10000u + i % 60, (uint8_t)rng());
+        client_counter_add(&cc, &p.mgmt, 100000 + i);
+    }
+    // Multicast sources are not clients
+    memset(mac, 0xFF, 6);
+    probe_build(&p, mac, 1, 0);
+    client_counter_add(&cc, &p.mgmt, 300000);
+
+    client_counter_get(&cc, SLOT_US / 2, &n);
+    check(n.probes == 800 * 3 + 60 * 20, "probes counted, multicast skipped", n.probes);
+    check(fabs(n.global[CLIENT_WINDOW_SHORT] - 800.0) <= 3 * std_err * 800, "global, short",
+          n.global[CLIENT_WINDOW_SHORT]);
+    check(n.global[CLIENT_WINDOW_LONG] == n.global[CLIENT_WINDOW_SHORT], "global, long",
+          n.global[CLIENT_WINDOW_LONG]);
+    check(fabs(n.randomized[CLIENT_WINDOW_SHORT] - 60.0) <= 3 * std_err * 60,
+          "randomized counted per device", n.randomized[CLIENT_WINDOW_SHORT]);
+
+    // Past the short window: short forgets, long remembers
+    client_counter_get(&cc, short_us + SLOT_US, &n);
+    check(n.global[CLIENT_WINDOW_SHORT] == 0 && n.randomized[CLIENT_WINDOW_SHORT] == 0,
+          "short window forgets", n.global[CLIENT_WINDOW_SHORT]);
+    check(fabs(n.global[CLIENT_WINDOW_LONG] - 800.0) <= 3 * std_err * 800,
+          "long window remembers", n.global[CLIENT_WINDOW_LONG]);
+
+    // Past the long window too
+    client_counter_get(&cc, long_us + 10 * SLOT_US, &n);
+    check(n.global[CLIENT_WINDOW_LONG] == 0 && n.randomized[CLIENT_WINDOW_LONG] == 0,
+          "long window forgets", n.global[CLIENT_WINDOW_LONG]);
+
+    client_counter_init(&cc, short_us, long_us, 0);
+    client_counter_get(&cc, 0, &n);
+    check(n.probes == 0 && n.global[CLIENT_WINDOW_LONG] == 0, "init resets", n.probes);
+}
+
+int main(int argc, char **argv)
+{
+    int trials = argc > 1 ? atoi(argv[1]) : 20;
+    if (trials < 1) {
+        fprintf(stderr, "usage: %s [trials]\n", argv[0]);
+        return 2;
+    }
+
+    check_accuracy(trials);
+    check_operations();
+    check_window();
+    check_client_counter();
+
+    printf("%s\n", failures ? "FAIL" : "OK");
+    return failures != 0;
+}
@@ -0,0 +1,354 @@
+/* ===================== IE PARSER CHECK =====================
+ * Host check of the 802.11 management parser (ieee80211_parse.h) over
+ * hand-built frames:
+ *   - header and frame type checks: short frames, non-management frames,
+ *     and subtypes other than beacon / probe response rejected by the BSS
+ *     parser
+ *   - FCS handling: the trailer is stripped only when has_fcs is set, and
+ *     never read as an element
+ *   - element walking: zero-length elements, a lone ID byte, and a length
+ *     running past the frame end, which stops the walk but keeps what
+ *     came before
+ *   - SSID: first element wins, empty (hidden) kept, longer than 32 dropped
+ *   - security: open, WEP (privacy bit only), WPA (vendor IE), WPA2 (RSN)
+ *     and both, with look-alike vendor elements ignored
+ *   - channel: DS params over the channel the radio was on
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o ie_parser_check \
+ *      tools/ie_parser_check.c components/scanner/ieee80211_parse.c
+ *
+ * Usage:
+ *   ie_parser_check
+ * Exits non-zero if any check fails.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ieee80211_parse.h"
+
+#define FRAME_MAX       512
+
+#define FC_MGMT(st)     ((uint16_t)((st) << 4))
+#define FC_CTRL_ACK     0x00D4      // type 1, subtype 13
+#define FC_DATA         0x0008      // type 2, subtype 0
+#define STYPE_AUTH      0xB
+#define CAP_ESS         0x0001
+#define CAP_PRIVACY     0x0010
+
+typedef struct {
+    uint8_t data[FRAME_MAX];
+    size_t len;
+} frame_t;
+
+static const uint8_t bssid[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+static const uint8_t wpa_ie[] = { 0x00, 0x50, 0xF2, 0x01, 0x01, 0x00 };
+static const uint8_t wmm_ie[] = { 0x00, 0x50, 0xF2, 0x02, 0x01, 0x01 };
+static const uint8_t rsn_ie[] = { 0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04 };
+
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/* ===================== FRAME BUILDING ===================== */
+// Header, plus the beacon fixed fields when cap is not negative
+static void frame_start(frame_t *f, uint16_t fc, int cap)
+{
+    memset(f, 0, sizeof(*f));
+    f->data[0] = (uint8_t)fc;
+    f->data[1] = (uint8_t)(fc >> 8);
+    memset(f->data + 4, 0xFF, 6);               // DA: broadcast
+    memcpy(f->data + 10, bssid, 6);             // SA
+    memcpy(f->data + 16, bssid, 6);             // BSSID
+    f->len = IEEE80211_MGMT_HDR_LEN;
+    if (cap >= 0) {
+        uint8_t *b = f->data + f->len;
+        b[8] = 100;                             // beacon interval, TUs
+        b[10] = (uint8_t)cap;
+        b[11] = (uint8_t)(cap >> 8);
+        f->len += 12;
+    }
+}
+
+static void put_ie(frame_t *f, uint8_t id, const void *data, uint8_t len)
+{
+    f->data[f->len++] = id;
+    f->data[f->len++] = len;
+    memcpy(f->data + f->len, data, len);
+    f->len += len;
+}
+
+static void put_raw(frame_t *f, const void *data, size_t len)
+{
+    memcpy(f->data + f->len, data, len);
+    f->len += len;
+}
+
+static void beacon(frame_t *f, int cap, const char *ssid, uint8_t channel)
+{
+    frame_start(f, FC_MGMT(IEEE80211_STYPE_BEACON), cap);
+    put_ie(f, IEEE80211_IE_SSID, ssid, (uint8_t)strlen(ssid));
+    if (channel) {
+        put_ie(f, IEEE80211_IE_DS_PARAMS, &channel, 1);
+    }
+}
+
+static int parse(const frame_t *f, bool has_fcs, ieee80211_mgmt_t *mgmt,
+                 ieee80211_bss_info_t *info)
+{
+    return ieee80211_parse_mgmt(f->data, f->len, has_fcs, mgmt) &&
+           ieee80211_parse_bss(mgmt, info);
+}
+
+static int ssid_is(const ieee80211_bss_info_t *info, const char *s)
+{
+    return info->ssid && info->ssid_len == strlen(s) && memcmp(info->ssid, s, info->ssid_len) == 0;
+}
+
+/* ===================== CHECKS ===================== */
+static void check_header(void)
+{
+    frame_t f;
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t info;
+
+    beacon(&f, CAP_ESS, "lab", 6);
+    check(parse(&f, false, &mgmt, &info), "beacon parses");
+    check(mgmt.subtype == IEEE80211_STYPE_BEACON, "beacon subtype");
+    check(memcmp(mgmt.bssid, bssid, 6) == 0 && memcmp(mgmt.sa, bssid, 6) == 0, "addresses");
+    check(mgmt.body == f.data + IEEE80211_MGMT_HDR_LEN, "body points into the frame");
+    check(mgmt.body_len == f.len - IEEE80211_MGMT_HDR_LEN, "body length");
+    check(info.beacon_interval == 100 && info.capability == CAP_ESS, "fixed fields");
+
+    check(!ieee80211_parse_mgmt(f.data, IEEE80211_MGMT_HDR_LEN - 1, false, &mgmt),
+          "short header rejected");
+    check(ieee80211_parse_mgmt(f.data, IEEE80211_MGMT_HDR_LEN, false, &mgmt) &&
+          mgmt.body_len == 0, "header-only frame");
+    check(!ieee80211_parse_bss(&mgmt, &info), "no fixed fields rejected");
+    check(ieee80211_parse_mgmt(f.data, IEEE80211_MGMT_HDR_LEN + 12, false, &mgmt) &&
+          ieee80211_parse_bss(&mgmt, &info) && !info.ssid && info.channel == 0,
+          "fixed fields without elements");
+    check(!ieee80211_parse_mgmt(f.data, IEEE80211_MGMT_HDR_LEN + 11, false, &mgmt) ||
+          !ieee80211_parse_bss(&mgmt, &info), "truncated fixed fields rejected");
+
+    frame_start(&f, FC_MGMT(IEEE80211_STYPE_PROBE_RESP), CAP_ESS);
+    put_ie(&f, IEEE80211_IE_SSID, "lab", 3);
+    check(parse(&f, false, &mgmt, &info) && ssid_is(&info, "lab"), "probe response parses");
+
+    // Management, but not a BSS description
+    const uint8_t others[] = { IEEE80211_STYPE_PROBE_REQ, STYPE_AUTH, 0x0 /* assoc req */ };
+    for (size_t i = 0; i < sizeof(others); i++) {
+        frame_start(&f, FC_MGMT(others[i]), CAP_ESS);
+        put_ie(&f, IEEE80211_IE_SSID, "lab", 3);
+        check(ieee80211_parse_mgmt(f.data, f.len, false, &mgmt) && mgmt.subtype == others[i],
+              "other management subtype parses as management");
+        check(!ieee80211_parse_bss(&mgmt, &info), "other management subtype not a BSS");
+    }
+
+    // Not management at all, even when long enough
+    frame_start(&f, FC_DATA, CAP_ESS);
+    put_ie(&f, IEEE80211_IE_SSID, "lab", 3);
+    check(!ieee80211_parse_mgmt(f.data, f.len, false, &mgmt), "data frame rejected");
+    frame_start(&f, FC_CTRL_ACK, CAP_ESS);
+    check(!ieee80211_parse_mgmt(f.data, f.len, false, &mgmt), "control frame rejected");
+}
+
+static void check_fcs(void)
+{
+    frame_t f;
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t info;
+
+    // The FCS bytes happen to read as a DS params element on channel 11
+    beacon(&f, CAP_ESS, "lab", 0);
+    size_t body_len = f.len - IEEE80211_MGMT_HDR_LEN;
+    const uint8_t fcs[IEEE80211_FCS_LEN] = { IEEE80211_IE_DS_PARAMS, 1, 11, 0xA5 };
+    put_raw(&f, fcs, sizeof(fcs));
+
+    check(parse(&f, true, &mgmt, &info), "beacon with FCS parses");
+    check(mgmt.body_len == body_len, "FCS excluded from the body");
+    check(info.channel == 0, "FCS not read as an element");
+    check(ssid_is(&info, "lab"), "SSID with FCS");
+
+    // Without the flag the same bytes are elements (and a truncated one)
+    check(parse(&f, false, &mgmt, &info) && mgmt.body_len == body_len + IEEE80211_FCS_LEN,
+          "no FCS: whole frame is body");
+    check(info.channel == 11, "no FCS: trailing bytes are elements");
+
+    check(!ieee80211_parse_mgmt(f.data, 3, true, &mgmt), "shorter than an FCS rejected");
+    check(!ieee80211_parse_mgmt(f.data, IEEE80211_MGMT_HDR_LEN + IEEE80211_FCS_LEN - 1, true,
+                                &mgmt), "short header with FCS rejected");
+    check(ieee80211_parse_mgmt(f.data, IEEE80211_MGMT_HDR_LEN + IEEE80211_FCS_LEN, true, &mgmt) &&
+          mgmt.body_len == 0, "header plus FCS only");
+}
+
+static void check_elements(void)
+{
+    frame_t f;
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t info;
+    ieee80211_ie_iter_t it;
+    uint8_t id, len;
+    const uint8_t *data;
+
+    // Iterator on its own
+    const uint8_t ies[] = { 7, 0, 3, 1, 6, 50, 2, 0x82 };
+    ieee80211_ie_iter_init(&it, ies, sizeof(ies));
+    check(ieee80211_ie_next(&it, &id, &data, &len) && id == 7 && len == 0 && data == ies + 2,
+          "zero-length element");
+    check(ieee80211_ie_next(&it, &id, &data, &len) && id == 3 && len == 1 && data[0] == 6,
+          "element after a zero-length one");
+    check(!ieee80211_ie_next(&it, &id, &data, &len), "length past the end stops");
+    check(!ieee80211_ie_next(&it, &id, &data, &len), "stays stopped");
+
+    ieee80211_ie_iter_init(&it, ies, 1);
+    check(!ieee80211_ie_next(&it, &id, &data, &len), "lone ID byte stops");
+    ieee80211_ie_iter_init(&it, ies, 0);
+    check(!ieee80211_ie_next(&it, &id, &data, &len), "empty element list");
+    ieee80211_ie_iter_init(&it, ies, 2);
+    check(ieee80211_ie_next(&it, &id, &data, &len) && len == 0 &&
+          !ieee80211_ie_next(&it, &id, &data, &len), "zero-length element at the very end");
+
+    // In a beacon: zero-length elements are skipped over
+    beacon(&f, CAP_ESS, "lab", 0);
+    put_ie(&f, 50, NULL, 0);
+    put_ie(&f, IEEE80211_IE_DS_PARAMS, "\x06", 1);
+    check(parse(&f, false, &mgmt, &info) && info.channel == 6,
+          "zero-length element in a beacon");
+
+    // An empty DS params carries no channel
+    beacon(&f, CAP_ESS, "lab", 0);
+    put_ie(&f, IEEE80211_IE_DS_PARAMS, NULL, 0);
+    check(parse(&f, false, &mgmt, &info) && info.channel == 0, "empty DS params");
+
+    // A length running past the frame end: earlier elements kept, later ones
+    // never reached
+    beacon(&f, CAP_ESS, "lab", 0);
+    put_raw(&f, "\x30\x40\x01\x00", 4);          // RSN claiming 64 bytes
+    check(parse(&f, false, &mgmt, &info), "overlong element still parses");
+    check(ssid_is(&info, "lab"), "elements before an overlong one kept");
+    check(info.security == IEEE80211_SEC_OPEN, "overlong RSN not counted");
+
+    beacon(&f, CAP_ESS, "lab", 0);
+    put_raw(&f, "\xdd", 1);                     // truncated: ID only
+    check(parse(&f, false, &mgmt, &info) && ssid_is(&info, "lab"), "truncated element at the end");
+
+    // Truncated SSID as the first element: nothing at all
+    frame_start(&f, FC_MGMT(IEEE80211_STYPE_BEACON), CAP_ESS);
+    put_raw(&f, "\x00\x05la", 4);
+    check(parse(&f, false, &mgmt, &info) && !info.ssid && info.ssid_len == 0,
+          "truncated SSID ignored");
+}
+
+static void check_ssid(void)
+{
+    frame_t f;
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t info;
+    char name[40];
+
+    memset(name, 'x', sizeof(name));
+    name[32] = '\0';
+    beacon(&f, CAP_ESS, name, 1);
+    check(parse(&f, false, &mgmt, &info) && ssid_is(&info, name), "32-byte SSID kept");
+
+    name[32] = 'x';
+    name[33] = '\0';
+    beacon(&f, CAP_ESS, name, 1);
+    check(parse(&f, false, &mgmt, &info) && !info.ssid && info.ssid_len == 0,
+          "33-byte SSID dropped");
+    check(info.channel == 1, "elements after a long SSID still read");
+
+    // A too-long SSID does not block a later valid one
+    frame_start(&f, FC_MGMT(IEEE80211_STYPE_BEACON), CAP_ESS);
+    put_ie(&f, IEEE80211_IE_SSID, name, 33);
+    put_ie(&f, IEEE80211_IE_SSID, "lab", 3);
+    check(parse(&f, false, &mgmt, &info) && ssid_is(&info, "lab"), "valid SSID after a long one");
+
+    beacon(&f, CAP_ESS, "first", 0);
+    put_ie(&f, IEEE80211_IE_SSID, "second", 6);
+    check(parse(&f, false, &mgmt, &info) && ssid_is(&info, "first"), "first SSID wins");
+
+    beacon(&f, CAP_ESS, "", 0);
+    check(parse(&f, false, &mgmt, &info) && info.ssid && info.ssid_len == 0, "hidden SSID");
+}
+
+static void check_security(void)
+{
+    static const struct {
+        const char *what;
+        int cap;
+        int rsn;
+        const uint8_t *vendor;
+        uint8_t vendor_len;
+        ieee80211_sec_t want;
+    } cases[] = {
+        { "open", CAP_ESS, 0, NULL, 0, IEEE80211_SEC_OPEN },
+        { "WEP: privacy bit only", CAP_ESS | CAP_PRIVACY, 0, NULL, 0, IEEE80211_SEC_WEP },
+        { "WPA: vendor IE", CAP_ESS | CAP_PRIVACY, 0, wpa_ie, sizeof(wpa_ie), IEEE80211_SEC_WPA },
+        { "WPA2: RSN", CAP_ESS | CAP_PRIVACY, 1, NULL, 0, IEEE80211_SEC_WPA2 },
+        { "WPA/WPA2: both", CAP_ESS | CAP_PRIVACY, 1, wpa_ie, sizeof(wpa_ie),
+          IEEE80211_SEC_WPA_WPA2 },
+        { "WMM is not WPA", CAP_ESS, 0, wmm_ie, sizeof(wmm_ie), IEEE80211_SEC_OPEN },
+        { "WMM with privacy is WEP", CAP_ESS | CAP_PRIVACY, 0, wmm_ie, sizeof(wmm_ie),
+          IEEE80211_SEC_WEP },
+        { "short vendor IE is not WPA", CAP_ESS, 0, wpa_ie, 3, IEEE80211_SEC_OPEN },
+        { "RSN without privacy bit", CAP_ESS, 1, NULL, 0, IEEE80211_SEC_WPA2 },
+    };
+    frame_t f;
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t info;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        beacon(&f, cases[i].cap, "lab", 6);
+        if (cases[i].vendor) {
+            put_ie(&f, IEEE80211_IE_VENDOR, cases[i].vendor, cases[i].vendor_len);
+        }
+        if (cases[i].rsn) {
+            put_ie(&f, IEEE80211_IE_RSN, rsn_ie, sizeof(rsn_ie));
+        }
+        check(parse(&f, false, &mgmt, &info) && info.security == cases[i].want, cases[i].what);
+    }
+}
+
+static void check_channel(void)
+{
+    frame_t f;
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t info;
+
+    // Heard on channel 5 through adjacent-channel leakage: DS params wins
+    beacon(&f, CAP_ESS, "lab", 6);
+    check(parse(&f, false, &mgmt, &info) && info.channel == 6, "DS params channel");
+    check(ieee80211_bss_channel(&info, 5) == 6, "DS params over hop channel");
+
+    beacon(&f, CAP_ESS, "lab", 0);
+    check(parse(&f, false, &mgmt, &info) && info.channel == 0, "no DS params");
+    check(ieee80211_bss_channel(&info, 5) == 5, "hop channel without DS params");
+
+    // The last DS params element counts
+    beacon(&f, CAP_ESS, "lab", 1);
+    put_ie(&f, IEEE80211_IE_DS_PARAMS, "\x0b", 1);
+    check(parse(&f, false, &mgmt, &info) && ieee80211_bss_channel(&info, 3) == 11,
+          "repeated DS params");
+}
+
+int main(void)
+{
+    check_header();
+    check_fcs();
+    check_elements();
+    check_ssid();
+    check_security();
+    check_channel();
+
+    printf("%s\n", failures ? "FAIL" : "OK");
+    return failures != 0;
+}
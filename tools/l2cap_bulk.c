@@ -0,0 +1,243 @@
+/* ===================== L2CAP BULK CLIENT =====================
+ * Linux client for the BLE firmware's bulk channel (CONFIG_SCANNER_BLE_L2CAP).
+ * Opens an LE credit-based L2CAP channel to the scanner and copies the
+ * binary stream it carries to stdout, so the serial tools read it as is:
+ *
+ *   l2cap_bulk AA:BB:CC:DD:EE:FF | scan_stream_reader -
+ *   l2cap_bulk -t 10 AA:BB:CC:DD:EE:FF | synth_load analyze -
+ *
+ * Throughput goes to stderr once a second. Needs the kernel's Bluetooth
+ * stack (BlueZ) and CAP_NET_RAW or root; no libbluetooth.
+ *
+ * Build:
+ *   cc -O2 -o l2cap_bulk tools/l2cap_bulk.c
+ *
+ * Options:
+ *   -p psm      L2CAP PSM, default 0x81 (CONFIG_SCANNER_BLE_L2CAP_PSM)
+ *   -m mtu      receive MTU announced to the scanner, default 2048
+ *   -r          peer uses a random address (default public)
+ *   -d          request a fresh table dump every second
+ *   -t seconds  stop after this long, 0 = until interrupted
+ */
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// From <bluetooth/bluetooth.h> and <bluetooth/l2cap.h>, kernel ABI
+#ifndef AF_BLUETOOTH
+#define AF_BLUETOOTH        31
+#endif
+#define BTPROTO_L2CAP       0
+#define SOL_BLUETOOTH       274
+#define BT_RCVMTU           13
+#define BDADDR_LE_PUBLIC    0x01
+#define BDADDR_LE_RANDOM    0x02
+
+typedef struct {
+    uint8_t b[6];                   // little endian
+} __attribute__((packed)) bt_addr_t;
+
+struct sockaddr_l2 {
+    sa_family_t l2_family;
+    uint16_t l2_psm;
+    bt_addr_t l2_bdaddr;
+    uint16_t l2_cid;
+    uint8_t l2_bdaddr_type;
+};
+
+#define BULK_CMD_DUMP       0x01
+#define DEFAULT_PSM         0x81
+#define DEFAULT_MTU         2048
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop_requested = 1;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int parse_addr(const char *s, bt_addr_t *addr)
+{
+    unsigned v[6];
+    if (sscanf(s, "%x:%x:%x:%x:%x:%x", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6) {
+        return -1;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (v[i] > 0xFF) {
+            return -1;
+        }
+        addr->b[5 - i] = (uint8_t)v[i];
+    }
+    return 0;
+}
+
+static int write_all(int fd, const uint8_t *p, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-p psm] [-m mtu] [-r] [-d] [-t seconds] AA:BB:CC:DD:EE:FF\n",
+            argv0);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long psm = DEFAULT_PSM;
+    int mtu = DEFAULT_MTU;
+    int random_addr = 0;
+    int redump = 0;
+    double duration = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:m:rdt:")) != -1) {
+        switch (opt) {
+        case 'p': psm = strtoul(optarg, NULL, 0); break;
+        case 'm': mtu = atoi(optarg); break;
+        case 'r': random_addr = 1; break;
+        case 'd': redump = 1; break;
+        case 't': duration = atof(optarg); break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind != argc - 1 || psm == 0 || psm > 0xFF || mtu < 23 || mtu > 65535) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    struct sockaddr_l2 peer = {
+        .l2_family = AF_BLUETOOTH,
+        .l2_psm = (uint16_t)psm,        // little endian on the hosts this runs on
+        .l2_bdaddr_type = random_addr ? BDADDR_LE_RANDOM : BDADDR_LE_PUBLIC,
+    };
+    if (parse_addr(argv[optind], &peer.l2_bdaddr) != 0) {
+        fprintf(stderr, "bad address: %s\n", argv[optind]);
+        return 2;
+    }
+
+    int fd = socket(AF_BLUETOOTH, SOCK_SEQPACKET, BTPROTO_L2CAP);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    // Any local adapter, LE
+    struct sockaddr_l2 local = {
+        .l2_family = AF_BLUETOOTH,
+        .l2_bdaddr_type = BDADDR_LE_PUBLIC,
+    };
+    if (bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    // The scanner caps its SDUs at this
+    uint16_t rcvmtu = (uint16_t)mtu;
+    if (setsockopt(fd, SOL_BLUETOOTH, BT_RCVMTU, &rcvmtu, sizeof(rcvmtu)) < 0) {
+        perror("setsockopt BT_RCVMTU");
+    }
+
+    if (connect(fd, (struct sockaddr *)&peer, sizeof(peer)) < 0) {
+        perror("connect");
+        return 1;
+    }
+    fprintf(stderr, "Connected to %s PSM 0x%02lx\n", argv[optind], psm);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    uint8_t *buf = malloc((size_t)mtu);
+    if (!buf) {
+        return 1;
+    }
+
+    double start = now_s();
+    double last_report = start;
+    uint64_t total_bytes = 0, total_sdus = 0, period_bytes = 0;
+
+    while (!stop_requested) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int pr = poll(&pfd, 1, 200);
+        if (pr < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+
+        if (pr > 0) {
+            // SEQPACKET: one read is one SDU
+            ssize_t n = read(fd, buf, (size_t)mtu);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                fprintf(stderr, "Channel closed%s%s\n", n < 0 ? ": " : "",
+                        n < 0 ? strerror(errno) : "");
+                break;
+            }
+            if (write_all(STDOUT_FILENO, buf, (size_t)n) != 0) {
+                break;
+            }
+            total_bytes += (uint64_t)n;
+            period_bytes += (uint64_t)n;
+            total_sdus++;
+        }
+
+        double t = now_s();
+        if (t - last_report >= 1.0) {
+            fprintf(stderr, "%.1f s: %.1f kB/s, %llu SDUs, %llu bytes\n", t - start,
+                    period_bytes / (t - last_report) / 1000.0, (unsigned long long)total_sdus,
+                    (unsigned long long)total_bytes);
+            period_bytes = 0;
+            last_report = t;
+
+            if (redump) {
+                uint8_t cmd = BULK_CMD_DUMP;
+                if (write(fd, &cmd, 1) != 1) {
+                    perror("write");
+                }
+            }
+        }
+        if (duration > 0 && t - start >= duration) {
+            break;
+        }
+    }
+
+    double elapsed = now_s() - start;
+    fprintf(stderr, "Total: %llu bytes in %llu SDUs, %.1f s, %.1f kB/s\n",
+            (unsigned long long)total_bytes, (unsigned long long)total_sdus, elapsed,
+            elapsed > 0 ? total_bytes / elapsed / 1000.0 : 0.0);
+
+    free(buf);
+    close(fd);
+    return 0;
+}
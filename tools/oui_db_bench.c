@@ -0,0 +1,177 @@
+/* ===================== OUI INDEX BENCHMARK =====================
+ * Host check and speed test of the OUI vendor index (oui_db.h): every
+ * registered OUI must come back with its vendor, unlisted and randomized
+ * BSSIDs must miss, and lookups per second are compared against a binary
+ * search over the same entries. Also prints the flash footprint.
+ *
+ * Build (the table is generated exactly as in the firmware build; point
+ * it at the full IEEE oui.csv for realistic numbers):
+ *   python3 tools/oui_gen.py components/scanner/data/oui.csv -o oui_db_data.c
+ *   cc -O2 -Icomponents/scanner/include -o oui_db_bench \
+ *      tools/oui_db_bench.c components/scanner/oui_db.c oui_db_data.c
+ *
+ * Usage:
+ *   oui_db_bench [iterations]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "oui_db.h"
+
+#define SAMPLE_COUNT    4096
+
+typedef struct {
+    uint32_t key;
+    uint16_t vendor;
+} sorted_entry_t;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int cmp_entry(const void *a, const void *b)
+{
+    uint32_t ka = ((const sorted_entry_t *)a)->key;
+    uint32_t kb = ((const sorted_entry_t *)b)->key;
+    return ka < kb ? -1 : ka > kb;
+}
+
+// Baseline: what a plain sorted table would cost
+static uint16_t sorted_lookup(const sorted_entry_t *tab, size_t n, const uint8_t bssid[6])
+{
+    if (bssid[0] & 0x03) {
+        return OUI_DB_UNKNOWN;
+    }
+    uint32_t key = ((uint32_t)bssid[0] << 16) | ((uint32_t)bssid[1] << 8) | bssid[2];
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (tab[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < n && tab[lo].key == key ? tab[lo].vendor : OUI_DB_UNKNOWN;
+}
+
+static void key_to_bssid(uint32_t key, uint8_t bssid[6])
+{
+    bssid[0] = key >> 16;
+    bssid[1] = key >> 8;
+    bssid[2] = key;
+    bssid[3] = rng();
+    bssid[4] = rng();
+    bssid[5] = rng();
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 2000;
+    const oui_db_t *db = &oui_db_builtin;
+
+    // Recover the entries from the slots
+    sorted_entry_t *tab = malloc(db->n_slots * sizeof(*tab));
+    size_t n = 0;
+    for (uint32_t s = 0; s < db->n_slots; s++) {
+        const uint8_t *p = db->slots + (size_t)s * OUI_DB_SLOT_LEN;
+        uint32_t key = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+        if (key != OUI_DB_EMPTY) {
+            tab[n].key = key;
+            tab[n].vendor = p[3] | (p[4] << 8);
+            n++;
+        }
+    }
+    qsort(tab, n, sizeof(*tab), cmp_entry);
+
+    // Correctness: every entry hits, with its own vendor
+    size_t bad = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t bssid[6];
+        key_to_bssid(tab[i].key, bssid);
+        uint16_t v = oui_db_lookup(db, bssid);
+        if (v != tab[i].vendor || v == OUI_DB_UNKNOWN || v > db->n_vendors) {
+            bad++;
+        }
+    }
+
+    // Samples: registered, unregistered universal, locally administered
+    static uint8_t hits[SAMPLE_COUNT][6], misses[SAMPLE_COUNT][6], local[SAMPLE_COUNT][6];
+    size_t false_hits = 0;
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        key_to_bssid(tab[rng() % n].key, hits[i]);
+
+        uint32_t key;
+        sorted_entry_t probe;
+        do {
+            key = rng() & 0xFCFFFF;
+            probe.key = key;
+        } while (bsearch(&probe, tab, n, sizeof(*tab), cmp_entry));
+        key_to_bssid(key, misses[i]);
+        false_hits += oui_db_lookup(db, misses[i]) != OUI_DB_UNKNOWN;
+
+        key_to_bssid(rng(), local[i]);
+        local[i][0] |= 0x02;
+        false_hits += oui_db_lookup(db, local[i]) != OUI_DB_UNKNOWN;
+    }
+
+    printf("%zu OUIs, %u vendors, %u slots (load %.2f), %u buckets, version %08X\n", n,
+           db->n_vendors, db->n_slots, (double)n / db->n_slots, db->n_buckets, db->version);
+    printf("Flash: %zu bytes total, %.2f bytes/OUI without names\n", oui_db_footprint(db),
+           (double)(db->n_buckets * 2 + db->n_slots * OUI_DB_SLOT_LEN) / n);
+    printf("Check: %zu wrong lookups, %zu false hits in %d probes\n", bad, false_hits,
+           2 * SAMPLE_COUNT);
+    if (n > 0) {
+        const char *name = oui_db_vendor_name(db, tab[0].vendor);
+        printf("Example: %06X -> %u %s\n", tab[0].key, tab[0].vendor, name ? name : "(no names)");
+    }
+
+    const struct {
+        const char *label;
+        uint8_t (*samples)[6];
+    } sets[] = {
+        { "registered", hits },
+        { "unregistered", misses },
+        { "randomized", local },
+    };
+
+    volatile uint32_t sink = 0;
+    for (size_t k = 0; k < sizeof(sets) / sizeof(sets[0]); k++) {
+        double t0 = now_s();
+        for (long it = 0; it < iterations; it++) {
+            for (int i = 0; i < SAMPLE_COUNT; i++) {
+                sink += oui_db_lookup(db, sets[k].samples[i]);
+            }
+        }
+        double t1 = now_s();
+        for (long it = 0; it < iterations; it++) {
+            for (int i = 0; i < SAMPLE_COUNT; i++) {
+                sink += sorted_lookup(tab, n, sets[k].samples[i]);
+            }
+        }
+        double t2 = now_s();
+
+        double count = (double)iterations * SAMPLE_COUNT;
+        printf("%-13s perfect hash %6.1f M/s (%5.1f ns), binary search %6.1f M/s (%5.1f ns)\n",
+               sets[k].label, count / (t1 - t0) / 1e6, (t1 - t0) / count * 1e9,
+               count / (t2 - t1) / 1e6, (t2 - t1) / count * 1e9);
+    }
+
+    free(tab);
+    return bad != 0 || false_hits != 0;
+}
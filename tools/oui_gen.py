@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""OUI vendor index generator (see components/scanner/include/oui_db.h).
+
+Reads an IEEE MA-L registry CSV (https://standards-oui.ieee.org/oui/oui.csv,
+columns Registry,Assignment,Organization Name,...) and writes a C file
+defining `oui_db_builtin`: a hash-and-displace perfect hash over the OUIs
+plus the deduplicated vendor names. Vendor IDs are assigned in sorted name
+order, so the same registry always yields the same IDs.
+
+Run by the scanner component's CMake build; by hand for host tools:
+  python3 tools/oui_gen.py components/scanner/data/oui.csv -o oui_db_data.c \
+      --vendors oui_vendors.csv
+
+Options:
+  --no-names        leave the names out of the table (IDs only)
+  --max-name N      truncate names to N characters (default 32)
+  --vendors FILE    also write "id,name" for clients resolving IDs
+"""
+import argparse
+import csv
+import sys
+import zlib
+
+M32 = 0xFFFFFFFF
+BUCKET_SIZE = 4         # average keys per bucket: 0.5 bytes of displacement per key
+LOAD = 0.95             # slots filled; the rest keep the last buckets cheap to place
+DISP_MAX = 0xFFFF
+EMPTY = b"\xff\xff\xff\x00\x00"
+
+
+# Must match oui_db_hash / oui_db_reduce / oui_db_slot_seed in oui_db.h
+def oui_hash(key, seed):
+    h = (key ^ seed) & M32
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & M32
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & M32
+    h ^= h >> 16
+    return h
+
+
+def reduce(h, n):
+    return (h * n) >> 32
+
+
+def slot_seed(seed, disp):
+    return (seed + 0x9E3779B9 * (disp + 1)) & M32
+
+
+def read_registry(path, max_name):
+    entries = {}
+    with open(path, newline="", encoding="utf-8", errors="replace") as f:
+        for row in csv.reader(f):
+            if len(row) < 3 or row[0].strip() != "MA-L":
+                continue
+            try:
+                key = int(row[1].strip(), 16)
+            except ValueError:
+                continue
+            if key > 0xFFFFFF or key >> 16 & 0x03:
+                continue
+            name = " ".join(row[2].split())[:max_name].rstrip()
+            entries[key] = name or "?"
+    return entries
+
+
+def build(keys, seed):
+    n_slots = max(1, int(len(keys) / LOAD) + 1)
+    n_buckets = max(1, (len(keys) + BUCKET_SIZE - 1) // BUCKET_SIZE)
+
+    buckets = [[] for _ in range(n_buckets)]
+    for k in keys:
+        buckets[reduce(oui_hash(k, seed), n_buckets)].append(k)
+
+    disp = [0] * n_buckets
+    slots = [None] * n_slots
+    # Largest buckets first, while the table is still empty
+    for b in sorted(range(n_buckets), key=lambda i: -len(buckets[i])):
+        bucket = buckets[b]
+        if not bucket:
+            break
+        for d in range(DISP_MAX + 1):
+            ss = slot_seed(seed, d)
+            pos = [reduce(oui_hash(k, ss), n_slots) for k in bucket]
+            if len(set(pos)) == len(pos) and all(slots[p] is None for p in pos):
+                break
+        else:
+            return None
+        disp[b] = d
+        for k, p in zip(bucket, pos):
+            slots[p] = k
+    return n_buckets, n_slots, disp, slots
+
+
+def c_bytes(data, indent="    ", per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join("0x%02x" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def c_words(values, indent="    ", per_line=12):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ", ".join(str(v) for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def c_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"').replace("?", "\\?") + '\\0"'
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("csv")
+    ap.add_argument("-o", "--output", required=True)
+    ap.add_argument("--vendors")
+    ap.add_argument("--no-names", action="store_true")
+    ap.add_argument("--max-name", type=int, default=32)
+    args = ap.parse_args()
+
+    entries = read_registry(args.csv, args.max_name)
+    vendors = sorted(set(entries.values()))
+    if len(vendors) > 0xFFFF:
+        sys.exit("oui_gen: more than 65535 vendors")
+    vendor_id = {name: i + 1 for i, name in enumerate(vendors)}
+    keys = sorted(entries)
+
+    crc = 0
+    for k in keys:
+        crc = zlib.crc32(b"%06X,%s\n" % (k, entries[k].encode()), crc)
+
+    seed = 0
+    for attempt in range(64):
+        seed = oui_hash(attempt, 0x4F554944)
+        table = build(keys, seed)
+        if table:
+            break
+    else:
+        sys.exit("oui_gen: no perfect hash found")
+    n_buckets, n_slots, disp, slots = table
+
+    blob = bytearray()
+    for k in slots:
+        if k is None:
+            blob += EMPTY
+        else:
+            v = vendor_id[entries[k]]
+            blob += bytes((k >> 16, (k >> 8) & 0xFF, k & 0xFF, v & 0xFF, v >> 8))
+
+    out = []
+    out.append("// Generated by tools/oui_gen.py from %s; do not edit" % args.csv.replace("\\", "/").split("/")[-1])
+    out.append("// %d OUIs, %d vendors" % (len(keys), len(vendors)))
+    out.append('#include "oui_db.h"')
+    out.append("")
+    out.append("static const uint16_t disp[%d] = {" % n_buckets)
+    out.append(c_words(disp))
+    out.append("};")
+    out.append("")
+    out.append("static const uint8_t slots[%d] = {" % len(blob))
+    out.append(c_bytes(blob))
+    out.append("};")
+    if not args.no_names and vendors:
+        offs = []
+        pos = 0
+        for name in vendors:
+            offs.append(pos)
+            pos += len(name.encode()) + 1
+        out.append("")
+        out.append("static const uint32_t name_off[%d] = {" % len(vendors))
+        out.append(c_words(offs))
+        out.append("};")
+        out.append("")
+        out.append("static const char names[] =")
+        out.append("\n".join("    " + c_string(n) for n in vendors) + ";")
+    out.append("")
+    out.append("const oui_db_t oui_db_builtin = {")
+    out.append("    .seed = 0x%08Xu," % seed)
+    out.append("    .n_buckets = %d," % n_buckets)
+    out.append("    .n_slots = %d," % n_slots)
+    out.append("    .disp = disp,")
+    out.append("    .slots = slots,")
+    out.append("    .n_vendors = %d," % len(vendors))
+    if not args.no_names and vendors:
+        out.append("    .name_off = name_off,")
+        out.append("    .names = names,")
+    out.append("    .version = 0x%08Xu," % crc)
+    out.append("};")
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+    if args.vendors:
+        with open(args.vendors, "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(["id", "name"])
+            for name in vendors:
+                w.writerow([vendor_id[name], name])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,513 @@
+/* ===================== PCAP REPLAY =====================
+ * Host-side input source that pushes recorded captures through the same
+ * parse -> AP table -> encode -> transmit pipeline as the firmware capture
+ * mode, and reports throughput and per-stage latency.
+ *
+ * Inputs:
+ *   - pcap with 802.11 (linktype 105) or radiotap (linktype 127) frames
+ *   - scan traces: raw bytes of the binary stream (see stream_frame.h),
+ *     e.g. saved with `cat /dev/ttyUSB0 > trace.bin`
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o pcap_replay tools/pcap_replay.c \
+ *      components/scanner/ieee80211_parse.c components/scanner/ap_table.c \
+ *      components/scanner/scan_record.c components/scanner/stream_frame.c \
+ *      components/scanner/cobs.c components/scanner/crc32.c \
+ *      components/scanner/rssi_distance.c components/scanner/oui_db.c
+ *
+ * Add -DAP_TABLE_MAX=<n> to match a firmware built with a larger
+ * CONFIG_SCANNER_AP_TABLE_SIZE; dense captures thrash the default 64.
+ *
+ * Usage:
+ *   pcap_replay [-r] [-n loops] [-p report_ms] [-o out] file
+ *     -r   real-time replay using capture timestamps (default: as fast as possible)
+ *     -n   replay the file this many times (default 1)
+ *     -p   report period in capture time, like CONFIG_SCANNER_CAPTURE_REPORT_MS
+ *     -o   write encoded stream frames here (default: discarded)
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ap_table.h"
+#include "ieee80211_parse.h"
+#include "scan_record.h"
+#include "stream_frame.h"
+
+#define PCAP_MAGIC_US       0xA1B2C3D4
+#define PCAP_MAGIC_NS       0xA1B23C4D
+#define LINKTYPE_80211      105
+#define LINKTYPE_RADIOTAP   127
+
+#define RADIOTAP_F_FCS      0x10
+#define LAT_BUCKETS         4096    // 100 ns buckets, 409.6 us range
+
+typedef enum {
+    STAGE_PARSE,
+    STAGE_TABLE,
+    STAGE_ENCODE,
+    STAGE_TRANSMIT,
+    STAGE_COUNT,
+} stage_t;
+
+static const char *stage_names[STAGE_COUNT] = { "parse", "table", "encode", "transmit" };
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t hist[LAT_BUCKETS];
+} stage_stats_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    int realtime;
+    int loops;
+    int64_t report_us;
+    int out_fd;
+
+    ap_table_t table;
+    int64_t next_report_us;
+    uint16_t seq;
+
+    uint64_t frames;
+    uint64_t bss_frames;
+    uint64_t dropped;
+    uint64_t stream_frames;
+    uint64_t stream_bytes;
+    uint64_t wall_start_ns;     // start of the current pass, for pacing
+    int64_t capture_start_us;
+    stage_stats_t stages[STAGE_COUNT];
+} replay_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void stage_record(replay_t *r, stage_t stage, uint64_t ns)
+{
+    stage_stats_t *s = &r->stages[stage];
+    uint64_t bucket = ns / 100;
+
+    s->count++;
+    s->total_ns += ns;
+    if (ns > s->max_ns) {
+        s->max_ns = ns;
+    }
+    s->hist[bucket < LAT_BUCKETS ? bucket : LAT_BUCKETS - 1]++;
+}
+
+static uint64_t stage_percentile(const stage_stats_t *s, double pct)
+{
+    uint64_t target = (uint64_t)(s->count * pct / 100.0);
+    uint64_t seen = 0;
+
+    for (int i = 0; i < LAT_BUCKETS; i++) {
+        seen += s->hist[i];
+        if (seen > target) {
+            return (uint64_t)i * 100;
+        }
+    }
+    return s->max_ns;
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t freq_to_channel(uint16_t mhz)
+{
+    if (mhz == 2484) {
+        return 14;
+    }
+    if (mhz >= 2412 && mhz <= 2472) {
+        return (mhz - 2407) / 5;
+    }
+    if (mhz >= 5000 && mhz <= 5900) {
+        return (mhz - 5000) / 5;
+    }
+    return 0;
+}
+
+/* ===================== RADIOTAP ===================== */
+typedef struct {
+    int8_t rssi;
+    uint8_t channel;
+    int has_fcs;
+} radiotap_info_t;
+
+// Walks the fields up to antenna signal; later fields are not needed
+static int radiotap_parse(const uint8_t *p, size_t len, radiotap_info_t *info, size_t *hdr_len)
+{
+    static const uint8_t align[6] = { 8, 1, 1, 2, 2, 1 };
+    static const uint8_t size[6] = { 8, 1, 1, 4, 2, 1 };
+
+    if (len < 8 || p[0] != 0) {
+        return -1;
+    }
+    *hdr_len = get_le16(p + 2);
+    if (*hdr_len > len) {
+        return -1;
+    }
+
+    uint32_t present = get_le32(p + 4);
+    size_t off = 8;
+    uint32_t word = present;
+    while (word & 0x80000000u) {
+        if (off + 4 > *hdr_len) {
+            return -1;
+        }
+        word = get_le32(p + off);
+        off += 4;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->rssi = -100;
+
+    for (int bit = 0; bit < 6; bit++) {
+        if (!(present & (1u << bit))) {
+            continue;
+        }
+        off = (off + align[bit] - 1) & ~(size_t)(align[bit] - 1);
+        if (off + size[bit] > *hdr_len) {
+            return -1;
+        }
+        switch (bit) {
+        case 1:
+            info->has_fcs = (p[off] & RADIOTAP_F_FCS) != 0;
+            break;
+        case 3:
+            info->channel = freq_to_channel(get_le16(p + off));
+            break;
+        case 5:
+            info->rssi = (int8_t)p[off];
+            break;
+        default:
+            break;
+        }
+        off += size[bit];
+    }
+
+    return 0;
+}
+
+/* ===================== PIPELINE ===================== */
+static void transmit(replay_t *r, const uint8_t *wire, size_t len)
+{
+    if (r->out_fd >= 0 && write(r->out_fd, wire, len) < 0) {
+        perror("write");
+        r->out_fd = -1;
+    }
+    r->stream_frames++;
+    r->stream_bytes += len;
+}
+
+static void flush_batch(replay_t *r, const uint8_t *payload, size_t len, int64_t ts_us,
+                        uint64_t encode_ns)
+{
+    static uint8_t wire[STREAM_FRAME_MAX_WIRE];
+    stream_frame_hdr_t hdr = {
+        .type = STREAM_FRAME_AP_BATCH,
+        .seq = r->seq++,
+        .timestamp_us = ts_us,
+    };
+
+    uint64_t t0 = now_ns();
+    size_t wl = stream_frame_encode(&hdr, payload, len, wire, sizeof(wire));
+    uint64_t t1 = now_ns();
+    stage_record(r, STAGE_ENCODE, encode_ns + (t1 - t0));
+
+    transmit(r, wire, wl);
+    stage_record(r, STAGE_TRANSMIT, now_ns() - t1);
+}
+
+// Same shape as the firmware report task: dirty entries, batched per frame
+static void report(replay_t *r, int64_t ts_us)
+{
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    size_t len = 2;
+    uint8_t count = 0;
+    uint64_t encode_ns = 0;
+
+    payload[1] = SCAN_RECORD_WIRE_MASK;
+
+    for (int i = 0; i < r->table.count; i++) {
+        if (!r->table.entries[i].dirty) {
+            continue;
+        }
+        if (count == 255 || sizeof(payload) - len < SCAN_RECORD_MAX_LEN) {
+            payload[0] = count;
+            flush_batch(r, payload, len, ts_us, encode_ns);
+            len = 2;
+            count = 0;
+            encode_ns = 0;
+        }
+
+        uint64_t t0 = now_ns();
+        len += scan_record_encode(&r->table.entries[i].rec, payload + len, sizeof(payload) - len);
+        encode_ns += now_ns() - t0;
+        count++;
+    }
+
+    if (count > 0) {
+        payload[0] = count;
+        flush_batch(r, payload, len, ts_us, encode_ns);
+    }
+    ap_table_clear_dirty(&r->table);
+}
+
+static void pace(replay_t *r, int64_t ts_us)
+{
+    if (r->capture_start_us < 0) {
+        r->capture_start_us = ts_us;
+        r->next_report_us = ts_us + r->report_us;
+    }
+
+    if (r->realtime) {
+        uint64_t due_ns = r->wall_start_ns + (uint64_t)(ts_us - r->capture_start_us) * 1000;
+        uint64_t now = now_ns();
+        if (due_ns > now) {
+            struct timespec ts = {
+                .tv_sec = (due_ns - now) / 1000000000ULL,
+                .tv_nsec = (due_ns - now) % 1000000000ULL,
+            };
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    while (ts_us >= r->next_report_us) {
+        report(r, r->next_report_us);
+        r->next_report_us += r->report_us;
+    }
+}
+
+static void ingest_80211(replay_t *r, const uint8_t *frame, size_t len, int has_fcs,
+                         int8_t rssi, uint8_t channel, int64_t ts_us)
+{
+    pace(r, ts_us);
+    r->frames++;
+
+    uint64_t t0 = now_ns();
+    ieee80211_mgmt_t mgmt;
+    ieee80211_bss_info_t bss;
+    int ok = ieee80211_parse_mgmt(frame, len, has_fcs, &mgmt) && ieee80211_parse_bss(&mgmt, &bss);
+    uint64_t t1 = now_ns();
+    stage_record(r, STAGE_PARSE, t1 - t0);
+    if (!ok) {
+        r->dropped++;
+        return;
+    }
+    r->bss_frames++;
+
+    scan_record_t rec = {
+        .rssi = rssi,
+        .channel = ieee80211_bss_channel(&bss, channel),
+        .authmode = bss.security,
+        .ssid_len = bss.ssid_len,
+    };
+    memcpy(rec.bssid, mgmt.bssid, sizeof(rec.bssid));
+    memcpy(rec.ssid, bss.ssid, bss.ssid_len);
+    rec.ssid[bss.ssid_len] = '\0';
+
+    ap_table_update(&r->table, &rec, ts_us);
+    stage_record(r, STAGE_TABLE, now_ns() - t1);
+}
+
+/* ===================== INPUT FORMATS ===================== */
+static int replay_pcap(replay_t *r)
+{
+    const uint8_t *p = r->data;
+    uint32_t magic = get_le32(p);
+    int ns_res = (magic == PCAP_MAGIC_NS);
+    uint32_t linktype = get_le32(p + 20);
+
+    if (linktype != LINKTYPE_80211 && linktype != LINKTYPE_RADIOTAP) {
+        fprintf(stderr, "unsupported linktype %u\n", linktype);
+        return -1;
+    }
+
+    size_t off = 24;
+    while (off + 16 <= r->len) {
+        int64_t ts_us = (int64_t)get_le32(p + off) * 1000000 +
+                        (ns_res ? get_le32(p + off + 4) / 1000 : get_le32(p + off + 4));
+        uint32_t caplen = get_le32(p + off + 8);
+        off += 16;
+        if (off + caplen > r->len) {
+            break;
+        }
+
+        const uint8_t *pkt = p + off;
+        off += caplen;
+
+        if (linktype == LINKTYPE_80211) {
+            ingest_80211(r, pkt, caplen, 0, -100, 0, ts_us);
+            continue;
+        }
+
+        radiotap_info_t rt;
+        size_t rt_len;
+        if (radiotap_parse(pkt, caplen, &rt, &rt_len) != 0) {
+            r->dropped++;
+            continue;
+        }
+        ingest_80211(r, pkt + rt_len, caplen - rt_len, rt.has_fcs, rt.rssi, rt.channel, ts_us);
+    }
+
+    return 0;
+}
+
+static int replay_trace(replay_t *r)
+{
+    static stream_deframer_t deframer;
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+
+    for (size_t i = 0; i < r->len; i++) {
+        size_t wl = stream_deframer_push(&deframer, r->data[i]);
+        if (wl == 0) {
+            continue;
+        }
+
+        uint64_t t0 = now_ns();
+        stream_frame_hdr_t hdr;
+        size_t plen;
+        int ret = stream_frame_decode(deframer.buf, wl, &hdr, payload, sizeof(payload), &plen);
+        if (ret != STREAM_FRAME_OK || hdr.type != STREAM_FRAME_AP_BATCH || plen < 2) {
+            r->dropped++;
+            continue;
+        }
+        pace(r, (int64_t)hdr.timestamp_us);
+
+        size_t off = 2;
+        for (unsigned k = 0; k < payload[0]; k++) {
+            scan_record_t rec;
+            size_t n = scan_record_decode(payload + off, plen - off, payload[1], &rec);
+            if (n == 0) {
+                r->dropped++;
+                break;
+            }
+            off += n;
+            r->frames++;
+            r->bss_frames++;
+
+            uint64_t t1 = now_ns();
+            stage_record(r, STAGE_PARSE, t1 - t0);
+            ap_table_update(&r->table, &rec, (int64_t)hdr.timestamp_us);
+            t0 = now_ns();
+            stage_record(r, STAGE_TABLE, t0 - t1);
+        }
+    }
+
+    return 0;
+}
+
+static int load_file(const char *path, replay_t *r)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    r->data = malloc(size > 0 ? size : 1);
+    r->len = size > 0 ? fread(r->data, 1, size, f) : 0;
+    fclose(f);
+
+    return 0;
+}
+
+static void print_report(const replay_t *r, double wall_s)
+{
+    printf("input frames:   %" PRIu64 " (%" PRIu64 " beacon/probe-resp, %" PRIu64 " dropped)\n",
+           r->frames, r->bss_frames, r->dropped);
+    printf("aps in table:   %u (%u evictions)\n", r->table.count, r->table.evictions);
+    printf("stream output:  %" PRIu64 " frames, %" PRIu64 " bytes\n", r->stream_frames, r->stream_bytes);
+    printf("wall time:      %.3f s\n", wall_s);
+    printf("throughput:     %.0f frames/s\n", wall_s > 0 ? r->frames / wall_s : 0.0);
+    printf("\n%-10s %10s %10s %10s %10s %10s\n", "stage", "count", "avg ns", "p50 ns", "p99 ns", "max ns");
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        const stage_stats_t *st = &r->stages[s];
+        printf("%-10s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+               stage_names[s], st->count, st->count ? st->total_ns / st->count : 0,
+               stage_percentile(st, 50), stage_percentile(st, 99), st->max_ns);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static replay_t r;
+    const char *out_path = NULL;
+    int opt;
+
+    r.loops = 1;
+    r.report_us = 100 * 1000;
+    r.out_fd = -1;
+
+    while ((opt = getopt(argc, argv, "rn:p:o:")) != -1) {
+        switch (opt) {
+        case 'r': r.realtime = 1; break;
+        case 'n': r.loops = atoi(optarg); break;
+        case 'p': r.report_us = atol(optarg) * 1000; break;
+        case 'o': out_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-r] [-n loops] [-p report_ms] [-o out] file\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc || r.report_us <= 0) {
+        fprintf(stderr, "usage: %s [-r] [-n loops] [-p report_ms] [-o out] file\n", argv[0]);
+        return 2;
+    }
+    if (load_file(argv[optind], &r) != 0) {
+        return 1;
+    }
+    if (out_path) {
+        r.out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (r.out_fd < 0) {
+            fprintf(stderr, "open %s: %s\n", out_path, strerror(errno));
+            return 1;
+        }
+    }
+
+    int is_pcap = r.len >= 24 && (get_le32(r.data) == PCAP_MAGIC_US || get_le32(r.data) == PCAP_MAGIC_NS);
+    ap_table_init(&r.table);
+    uint64_t start_ns = now_ns();
+
+    for (int loop = 0; loop < r.loops; loop++) {
+        // Each pass restarts capture time so real-time pacing stays correct
+        r.capture_start_us = -1;
+        r.wall_start_ns = now_ns();
+
+        if ((is_pcap ? replay_pcap(&r) : replay_trace(&r)) != 0) {
+            return 1;
+        }
+        report(&r, r.next_report_us);
+    }
+
+    print_report(&r, (now_ns() - start_ns) / 1e9);
+
+    if (r.out_fd >= 0) {
+        close(r.out_fd);
+    }
+    free(r.data);
+
+    return 0;
+}
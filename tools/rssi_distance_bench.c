@@ -0,0 +1,169 @@
+/* ===================== RSSI DISTANCE BENCHMARK =====================
+ * Host accuracy and speed check of the fixed-point distance estimator
+ * (rssi_distance.h) against a float pow() reference, over a grid of
+ * calibrations and every RSSI step of 1/16 dB.
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o rssi_distance_bench \
+ *      tools/rssi_distance_bench.c components/scanner/rssi_distance.c -lm
+ *
+ * Usage:
+ *   rssi_distance_bench [iterations]
+ * Exits non-zero if an error bound is exceeded: the distance beyond the
+ * 1 cm rounding by more than 0.01% (the figure rssi_distance.h promises),
+ * log2 by more than 2^-13, or the fitted exponent by more than one Q8
+ * step.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "rssi_distance.h"
+
+#define SAMPLE_COUNT    4096
+
+#define MAX_REL_ERR     1e-4
+#define MAX_LOG2_ERR    (1.0 / 8192)
+#define MAX_FIT_ERR     (1.0 / 256)
+
+static int failures;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void check(int ok, const char *what, double err, double bound)
+{
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s error %g above %g\n", what, err, bound);
+        failures++;
+    }
+}
+
+static double ref_cm(int tx_q4, int n_q8, int rssi_q4)
+{
+    return 100.0 * pow(10.0, (tx_q4 - rssi_q4) / 16.0 / (10.0 * n_q8 / 256.0));
+}
+
+static void check_accuracy(void)
+{
+    double max_rel = 0, sum_rel = 0;
+    long count = 0;
+    int worst_tx = 0, worst_n = 0, worst_rssi = 0;
+
+    for (int tx = -60; tx <= -20; tx += 5) {
+        for (int n10 = 16; n10 <= 45; n10++) {
+            rssi_distance_model_t m;
+            rssi_distance_model_init(&m, tx * 16, (n10 * 256 + 5) / 10);
+
+            for (int rssi_q4 = -100 * 16; rssi_q4 <= -10 * 16; rssi_q4++) {
+                double ref = ref_cm(m.tx_q4, m.n_q8, rssi_q4);
+                if (ref < 1.0 || ref > RSSI_DISTANCE_MAX_CM) {
+                    continue;
+                }
+                // Error beyond the 1 cm output resolution
+                double err = fabs(rssi_distance_cm(&m, rssi_q4) - ref) - 0.5;
+                double rel = err > 0 ? err / ref : 0;
+                sum_rel += rel;
+                count++;
+                if (rel > max_rel) {
+                    max_rel = rel;
+                    worst_tx = tx;
+                    worst_n = n10;
+                    worst_rssi = rssi_q4;
+                }
+            }
+        }
+    }
+
+    printf("distance: %ld points, error beyond rounding mean %.5f%%, max %.5f%% "
+           "(tx %d n %.1f rssi %.2f)\n",
+           count, 100 * sum_rel / count, 100 * max_rel, worst_tx, worst_n / 10.0,
+           worst_rssi / 16.0);
+    check(max_rel <= MAX_REL_ERR, "distance", max_rel, MAX_REL_ERR);
+}
+
+static void check_log2(void)
+{
+    double max_abs = 0;
+
+    for (uint32_t x = 1; x < 4000000000u; x += x / 997 + 1) {
+        double err = fabs(rssi_distance_log2_q16(x) / 65536.0 - log2(x));
+        if (err > max_abs) {
+            max_abs = err;
+        }
+    }
+    printf("log2: max error %.6f\n", max_abs);
+    check(max_abs <= MAX_LOG2_ERR, "log2", max_abs, MAX_LOG2_ERR);
+}
+
+static void check_fit(void)
+{
+    double max_abs = 0;
+
+    for (int n10 = 16; n10 <= 45; n10++) {
+        for (uint32_t d = 200; d <= 5000; d += 100) {
+            double n = n10 / 10.0;
+            int rssi_q4 = (int)lround((-40.0 - 10 * n * log10(d / 100.0)) * 16);
+            // Reference fit on the same quantized RSSI
+            double ref = (-40.0 - rssi_q4 / 16.0) / (10 * log10(d / 100.0));
+            double err = fabs(rssi_distance_fit_exponent(-40 * 16, rssi_q4, d) / 256.0 - ref);
+            if (err > max_abs) {
+                max_abs = err;
+            }
+        }
+    }
+    printf("exponent fit: max error %.4f\n", max_abs);
+    check(max_abs <= MAX_FIT_ERR, "exponent fit", max_abs, MAX_FIT_ERR);
+}
+
+static void bench(long iterations)
+{
+    static int16_t samples[SAMPLE_COUNT];
+    rssi_distance_model_t m;
+    volatile uint64_t sink = 0;
+    volatile double fsink = 0;
+
+    rssi_distance_model_init(&m, -40 * 16, 691);
+    srand(1);
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        samples[i] = (int16_t)(-(30 * 16) - rand() % (60 * 16));
+    }
+
+    double t0 = now_s();
+    for (long i = 0; i < iterations; i++) {
+        sink += rssi_distance_cm(&m, samples[i & (SAMPLE_COUNT - 1)]);
+    }
+    double t1 = now_s();
+    for (long i = 0; i < iterations; i++) {
+        fsink += ref_cm(m.tx_q4, m.n_q8, samples[i & (SAMPLE_COUNT - 1)]);
+    }
+    double t2 = now_s();
+    for (long i = 0; i < iterations; i++) {
+        int d = m.tx_q4 - samples[i & (SAMPLE_COUNT - 1)];
+        fsink += 100.0f * powf(10.0f, d / (16.0f * 10.0f * m.n_q8 / 256.0f));
+    }
+    double t3 = now_s();
+
+    printf("speed: fixed %.2f ns, pow() %.2f ns, powf() %.2f ns per estimate\n",
+           (t1 - t0) * 1e9 / iterations, (t2 - t1) * 1e9 / iterations,
+           (t3 - t2) * 1e9 / iterations);
+    printf("(host FPU; on a core without one the float paths are soft-float calls)\n");
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 20000000;
+
+    check_accuracy();
+    check_log2();
+    check_fit();
+    bench(iterations);
+
+    printf("%s\n", failures ? "FAIL" : "OK");
+    return failures != 0;
+}
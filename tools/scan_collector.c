@@ -0,0 +1,1353 @@
+/* ===================== SCAN COLLECTOR =====================
+ * Site-wide collector for many scanners. Ingests the binary stream (see
+ * stream_frame.h) from any number of sources at once, decodes on a pool
+ * of worker threads, puts every node's device timestamps on the host
+ * clock and merges all AP records into one site view.
+ *
+ * Pipeline: one poll() thread reads raw bytes and hands each chunk to
+ * the worker that owns the node (node index modulo workers), so a node's
+ * frames stay in order and its deframer and clock estimate need no lock.
+ * Workers deframe, check CRCs, decode records and merge them into a
+ * sharded hash table keyed by BSSID; only the shard lock is shared.
+ *
+ * Clock alignment: for each frame, rx - tx = offset + delay with delay
+ * >= 0. The minimum over each 10 s of device time is the sample with the
+ * least queueing; a least-squares line through the last 30 minima gives
+ * offset and drift (crystal ppm), so aligned time = tx + offset(tx). A
+ * device timestamp going back more than 1 s restarts the estimate
+ * (reboot). The fixed part of the link delay is indistinguishable from
+ * offset, so aligned times run late by that floor (about 1 ms on USB
+ * serial, a connection interval over BLE). Boot-cache frames (STREAM_FLAG_STALE) carry old data and are
+ * counted but not merged. Trace files are read as fast as possible, so
+ * their receive times, and the alignment, only mean something on live
+ * sources.
+ *
+ * Load test (-L): simulated nodes with known clock offset, drift and
+ * delay jitter feed the worker queues directly with virtual receive
+ * times. It reports throughput and the alignment error against the
+ * truth; -S repeats it for 1, 2, 4 ... up to the core count workers.
+ * Feeder threads (one per worker) encode frames and share the cores.
+ *
+ * Build:
+ *   cc -O2 -pthread -Icomponents/scanner/include -o scan_collector \
+ *      tools/scan_collector.c components/scanner/scan_record.c \
+ *      components/scanner/stream_frame.c components/scanner/cobs.c \
+ *      components/scanner/crc32.c -lm
+ *
+ * Usage:
+ *   scan_collector [-w workers] [-p report_s] [-o site.csv] [-v] source...
+ *     source:  /dev/ttyUSB0[@baud]  tty (default 921600 baud)
+ *              path                 pty, fifo or trace file
+ *              tcp:host:port        connect, e.g. to a BLE gateway
+ *              listen:port          accept any number of gateways
+ *   scan_collector -L nodes [-a aps] [-d seconds] [-w workers | -S]
+ *
+ *   -o  rewrite the merged view as CSV at every report
+ *   -v  per-node table even with many nodes
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scan_record.h"
+#include "stream_frame.h"
+
+#define MAX_NODES           256
+#define MAX_WORKERS         64
+#define CHUNK_MAX           16384
+#define QUEUE_DEPTH         64
+
+#define CLOCK_BUCKET_US     10000000LL
+#define CLOCK_BUCKETS       30
+#define CLOCK_REBOOT_US     1000000LL
+
+#define SITE_SHARDS         64
+#define SITE_MAX_OBS        8
+#define SITE_TOP            10
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop_requested = 1;
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static double thread_cpu_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ===================== CLOCK ALIGNMENT ===================== */
+typedef struct {
+    int have;
+    int64_t origin_dev;         // first device time, keeps the fit well conditioned
+    int64_t last_dev;
+    int64_t bucket_end;
+    int64_t cur_dev, cur_d;     // minimum of the open bucket
+    int64_t dev[CLOCK_BUCKETS], d[CLOCK_BUCKETS];
+    int n, head;
+    double a, b;                // offset(dev) = a + b * (dev - origin_dev)
+    uint32_t reboots;
+} clock_est_t;
+
+static void clock_fit(clock_est_t *c)
+{
+    // The open bucket's minimum counts too, so a fresh node aligns at once
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int n = c->n + 1;
+    double x0 = (double)(c->cur_dev - c->origin_dev);
+    double y0 = (double)c->cur_d;
+    double lo = x0, hi = x0;
+
+    sx = x0;
+    sy = y0;
+    sxx = x0 * x0;
+    sxy = x0 * y0;
+    for (int i = 0; i < c->n; i++) {
+        double x = (double)(c->dev[i] - c->origin_dev);
+        double y = (double)c->d[i];
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        lo = x < lo ? x : lo;
+        hi = x > hi ? x : hi;
+    }
+
+    // Drift needs a couple of buckets of baseline; until then, offset only
+    double den = n * sxx - sx * sx;
+    if (n < 3 || hi - lo < 2 * CLOCK_BUCKET_US || den <= 0) {
+        int64_t m = c->cur_d;
+        for (int i = 0; i < c->n; i++) {
+            m = c->d[i] < m ? c->d[i] : m;
+        }
+        c->a = (double)m;
+        c->b = 0;
+        return;
+    }
+    c->b = (n * sxy - sx * sy) / den;
+    c->a = (sy - c->b * sx) / n;
+}
+
+static void clock_add(clock_est_t *c, int64_t dev, int64_t rx)
+{
+    int64_t d = rx - dev;
+
+    if (c->have && dev < c->last_dev - CLOCK_REBOOT_US) {
+        c->reboots++;
+        c->have = 0;
+    }
+    if (!c->have) {
+        c->have = 1;
+        c->origin_dev = dev;
+        c->last_dev = dev;
+        c->bucket_end = dev + CLOCK_BUCKET_US;
+        c->cur_dev = dev;
+        c->cur_d = d;
+        c->n = 0;
+        c->head = 0;
+        clock_fit(c);
+        return;
+    }
+
+    if (dev > c->last_dev) {
+        c->last_dev = dev;
+    }
+    if (dev >= c->bucket_end) {
+        c->dev[c->head] = c->cur_dev;
+        c->d[c->head] = c->cur_d;
+        c->head = (c->head + 1) % CLOCK_BUCKETS;
+        c->n += c->n < CLOCK_BUCKETS;
+        c->bucket_end += (dev - c->bucket_end) / CLOCK_BUCKET_US * CLOCK_BUCKET_US + CLOCK_BUCKET_US;
+        c->cur_dev = dev;
+        c->cur_d = d;
+        clock_fit(c);
+    } else if (d < c->cur_d) {
+        c->cur_dev = dev;
+        c->cur_d = d;
+        clock_fit(c);
+    }
+}
+
+static int64_t clock_offset_at(const clock_est_t *c, int64_t dev)
+{
+    return (int64_t)llround(c->a + c->b * (double)(dev - c->origin_dev));
+}
+
+/* ===================== NODES ===================== */
+typedef struct {
+    uint64_t bytes;
+    uint64_t frames;
+    uint64_t records;
+    uint64_t bad_frames;
+    uint64_t seq_gaps;
+    uint64_t stale;
+    uint32_t reboots;
+    int aligned;
+    int64_t offset_us;          // host - device at last_dev_us
+    double drift_ppm;           // device clock rate error
+    int64_t last_dev_us;
+    int64_t last_rx_us;
+} node_stats_t;
+
+typedef struct {
+    char name[64];
+    int fd;                     // -1 once closed, or simulated
+
+    // Owned by the node's worker
+    uint8_t frame[STREAM_FRAME_MAX_WIRE];
+    size_t frame_len;
+    int have_seq;
+    uint16_t last_seq;
+    clock_est_t clock;
+    node_stats_t work;
+
+    // Copy of work for the reporter
+    pthread_mutex_t lock;
+    node_stats_t pub;
+} node_t;
+
+/* ===================== CHUNK QUEUES ===================== */
+typedef struct chunk {
+    struct chunk *next;
+    uint16_t node;
+    int64_t rx_us;
+    size_t len;
+    uint8_t data[CHUNK_MAX];
+} chunk_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t nonempty;
+    pthread_cond_t nonfull;
+    chunk_t *head, *tail;
+    size_t depth;
+    int closed;
+} chunk_queue_t;
+
+static void queue_init(chunk_queue_t *q)
+{
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->nonempty, NULL);
+    pthread_cond_init(&q->nonfull, NULL);
+    q->head = q->tail = NULL;
+    q->depth = 0;
+    q->closed = 0;
+}
+
+// Blocks while full: back-pressure into the kernel buffers
+static void queue_push(chunk_queue_t *q, chunk_t *c)
+{
+    c->next = NULL;
+    pthread_mutex_lock(&q->lock);
+    while (q->depth >= QUEUE_DEPTH) {
+        pthread_cond_wait(&q->nonfull, &q->lock);
+    }
+    if (q->tail) {
+        q->tail->next = c;
+    } else {
+        q->head = c;
+    }
+    q->tail = c;
+    q->depth++;
+    pthread_cond_signal(&q->nonempty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// NULL once closed and drained
+static chunk_t *queue_pop(chunk_queue_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    while (!q->head && !q->closed) {
+        pthread_cond_wait(&q->nonempty, &q->lock);
+    }
+    chunk_t *c = q->head;
+    if (c) {
+        q->head = c->next;
+        if (!q->head) {
+            q->tail = NULL;
+        }
+        q->depth--;
+        pthread_cond_signal(&q->nonfull);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return c;
+}
+
+static void queue_close(chunk_queue_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->nonempty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/* ===================== SITE VIEW ===================== */
+typedef struct {
+    uint16_t node;
+    int8_t rssi;
+    int64_t t_us;
+} site_obs_t;
+
+typedef struct {
+    uint64_t key;               // 0 = empty slot
+    scan_record_t rec;          // latest sighting from any node
+    int64_t first_us;           // aligned host time
+    int64_t last_us;
+    uint32_t sightings;
+    uint8_t n_obs;
+    site_obs_t obs[SITE_MAX_OBS];   // latest per node, oldest evicted
+} site_ap_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    site_ap_t *slots;
+    size_t cap;
+    size_t count;
+} site_shard_t;
+
+static uint64_t bssid_key(const uint8_t bssid[6])
+{
+    uint64_t k = 1ULL << 48;    // never 0
+    for (int i = 0; i < 6; i++) {
+        k |= (uint64_t)bssid[i] << (8 * i);
+    }
+    return k;
+}
+
+static uint64_t key_hash(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+static site_ap_t *shard_slot(site_shard_t *s, uint64_t key, uint64_t h)
+{
+    size_t i = (h >> 8) & (s->cap - 1);
+    while (s->slots[i].key != 0 && s->slots[i].key != key) {
+        i = (i + 1) & (s->cap - 1);
+    }
+    return &s->slots[i];
+}
+
+static void shard_grow(site_shard_t *s)
+{
+    site_ap_t *old = s->slots;
+    size_t old_cap = s->cap;
+
+    s->cap = old_cap ? old_cap * 2 : 64;
+    s->slots = calloc(s->cap, sizeof(site_ap_t));
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i].key) {
+            *shard_slot(s, old[i].key, key_hash(old[i].key)) = old[i];
+        }
+    }
+    free(old);
+}
+
+static void site_init(site_shard_t *site)
+{
+    for (int i = 0; i < SITE_SHARDS; i++) {
+        pthread_mutex_init(&site[i].lock, NULL);
+        site[i].slots = NULL;
+        site[i].cap = 0;
+        site[i].count = 0;
+        shard_grow(&site[i]);
+    }
+}
+
+static void site_free(site_shard_t *site)
+{
+    for (int i = 0; i < SITE_SHARDS; i++) {
+        free(site[i].slots);
+        pthread_mutex_destroy(&site[i].lock);
+    }
+}
+
+static void site_merge(site_shard_t *site, const scan_record_t *rec, uint16_t node, int64_t t_us)
+{
+    uint64_t key = bssid_key(rec->bssid);
+    uint64_t h = key_hash(key);
+    site_shard_t *s = &site[h & (SITE_SHARDS - 1)];
+
+    pthread_mutex_lock(&s->lock);
+    if ((s->count + 1) * 10 > s->cap * 7) {
+        shard_grow(s);
+    }
+    site_ap_t *ap = shard_slot(s, key, h);
+    if (ap->key == 0) {
+        ap->key = key;
+        ap->rec = *rec;
+        ap->first_us = ap->last_us = t_us;
+        s->count++;
+    } else if (t_us >= ap->last_us) {
+        // Nodes arrive out of step; only a newer sighting replaces the record
+        ap->rec = *rec;
+        ap->last_us = t_us;
+    }
+    ap->first_us = t_us < ap->first_us ? t_us : ap->first_us;
+    ap->sightings++;
+
+    site_obs_t *o = NULL;
+    for (uint8_t i = 0; i < ap->n_obs; i++) {
+        if (ap->obs[i].node == node) {
+            o = &ap->obs[i];
+            break;
+        }
+    }
+    if (!o && ap->n_obs < SITE_MAX_OBS) {
+        o = &ap->obs[ap->n_obs++];
+        o->t_us = INT64_MIN;
+    } else if (!o) {
+        o = &ap->obs[0];
+        for (uint8_t i = 1; i < ap->n_obs; i++) {
+            o = ap->obs[i].t_us < o->t_us ? &ap->obs[i] : o;
+        }
+        o->t_us = INT64_MIN;
+    }
+    if (t_us >= o->t_us) {
+        o->node = node;
+        o->rssi = rec->rssi;
+        o->t_us = t_us;
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+/* ===================== COLLECTOR ===================== */
+typedef struct sim sim_t;
+
+typedef struct {
+    node_t *nodes;
+    size_t n_nodes;
+    int n_workers;
+    chunk_queue_t queues[MAX_WORKERS];
+    pthread_t workers[MAX_WORKERS];
+    double worker_cpu_s[MAX_WORKERS];
+    site_shard_t site[SITE_SHARDS];
+    sim_t *sim;
+} collector_t;
+
+typedef struct {
+    collector_t *col;
+    int index;
+} worker_arg_t;
+
+static void handle_frame(collector_t *col, uint16_t idx, const uint8_t *wire, size_t len,
+                         int64_t rx_us)
+{
+    static _Thread_local uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    node_t *node = &col->nodes[idx];
+    node_stats_t *st = &node->work;
+    stream_frame_hdr_t hdr;
+    size_t payload_len;
+
+    if (stream_frame_decode(wire, len, &hdr, payload, sizeof(payload), &payload_len) !=
+        STREAM_FRAME_OK) {
+        st->bad_frames++;
+        return;
+    }
+    st->frames++;
+    if (node->have_seq && hdr.seq != (uint16_t)(node->last_seq + 1)) {
+        st->seq_gaps += (uint16_t)(hdr.seq - node->last_seq - 1);
+    }
+    node->have_seq = 1;
+    node->last_seq = hdr.seq;
+
+    if (hdr.flags & STREAM_FLAG_STALE) {
+        st->stale++;
+        return;
+    }
+
+    int64_t dev = (int64_t)hdr.timestamp_us;
+    clock_add(&node->clock, dev, rx_us);
+    st->last_dev_us = dev;
+    st->last_rx_us = rx_us;
+
+    if (hdr.type != STREAM_FRAME_AP_BATCH || payload_len < 2) {
+        return;
+    }
+    int64_t t_us = dev + clock_offset_at(&node->clock, dev);
+    uint8_t count = payload[0];
+    uint8_t mask = payload[1];
+    size_t off = 2;
+    for (uint8_t i = 0; i < count; i++) {
+        scan_record_t rec;
+        size_t used = scan_record_decode(payload + off, payload_len - off, mask, &rec);
+        if (used == 0) {
+            st->bad_frames++;
+            break;
+        }
+        off += used;
+        st->records++;
+        site_merge(col->site, &rec, idx, t_us);
+    }
+}
+
+static void handle_chunk(collector_t *col, const chunk_t *c)
+{
+    node_t *node = &col->nodes[c->node];
+    const uint8_t *p = c->data;
+    const uint8_t *end = c->data + c->len;
+
+    node->work.bytes += c->len;
+    while (p < end) {
+        const uint8_t *z = memchr(p, 0x00, (size_t)(end - p));
+        size_t n = (size_t)((z ? z : end) - p);
+
+        if (node->frame_len + n > sizeof(node->frame)) {
+            // Oversized garbage: drop it and resync on the next delimiter
+            node->work.bad_frames++;
+            node->frame_len = sizeof(node->frame) + 1;
+        } else if (node->frame_len <= sizeof(node->frame)) {
+            memcpy(node->frame + node->frame_len, p, n);
+            node->frame_len += n;
+        }
+        if (!z) {
+            break;
+        }
+        if (node->frame_len > 0 && node->frame_len <= sizeof(node->frame)) {
+            handle_frame(col, c->node, node->frame, node->frame_len, c->rx_us);
+        }
+        node->frame_len = 0;
+        p = z + 1;
+    }
+
+    const clock_est_t *ck = &node->clock;
+    node->work.reboots = ck->reboots;
+    node->work.aligned = ck->have;
+    if (ck->have) {
+        node->work.offset_us = clock_offset_at(ck, node->work.last_dev_us);
+        node->work.drift_ppm = 0.0 - ck->b * 1e6;
+    }
+    pthread_mutex_lock(&node->lock);
+    node->pub = node->work;
+    pthread_mutex_unlock(&node->lock);
+}
+
+static void *worker_main(void *arg)
+{
+    worker_arg_t *wa = arg;
+    collector_t *col = wa->col;
+    chunk_t *c;
+
+    while ((c = queue_pop(&col->queues[wa->index])) != NULL) {
+        handle_chunk(col, c);
+        free(c);
+    }
+    col->worker_cpu_s[wa->index] = thread_cpu_s();
+    free(wa);
+    return NULL;
+}
+
+static void collector_start(collector_t *col, size_t n_nodes, int n_workers)
+{
+    col->nodes = calloc(n_nodes, sizeof(node_t));
+    col->n_nodes = 0;
+    col->n_workers = n_workers;
+    site_init(col->site);
+    for (int w = 0; w < n_workers; w++) {
+        queue_init(&col->queues[w]);
+        worker_arg_t *wa = malloc(sizeof(*wa));
+        wa->col = col;
+        wa->index = w;
+        pthread_create(&col->workers[w], NULL, worker_main, wa);
+    }
+}
+
+static int collector_add_node(collector_t *col, const char *name, int fd)
+{
+    if (col->n_nodes >= MAX_NODES) {
+        fprintf(stderr, "%s: more than %d nodes\n", name, MAX_NODES);
+        return -1;
+    }
+    node_t *node = &col->nodes[col->n_nodes];
+    snprintf(node->name, sizeof(node->name), "%s", name);
+    node->fd = fd;
+    pthread_mutex_init(&node->lock, NULL);
+    return (int)col->n_nodes++;
+}
+
+static void collector_submit(collector_t *col, chunk_t *c)
+{
+    queue_push(&col->queues[c->node % col->n_workers], c);
+}
+
+// Drains the queues and joins the workers
+static void collector_finish(collector_t *col)
+{
+    for (int w = 0; w < col->n_workers; w++) {
+        queue_close(&col->queues[w]);
+    }
+    for (int w = 0; w < col->n_workers; w++) {
+        pthread_join(col->workers[w], NULL);
+    }
+}
+
+static void collector_free(collector_t *col)
+{
+    for (size_t i = 0; i < col->n_nodes; i++) {
+        pthread_mutex_destroy(&col->nodes[i].lock);
+    }
+    free(col->nodes);
+    site_free(col->site);
+}
+
+/* ===================== REPORT ===================== */
+typedef struct {
+    site_ap_t ap;
+    int8_t best_rssi;
+    uint16_t best_node;
+} site_row_t;
+
+static int cmp_row_rssi(const void *a, const void *b)
+{
+    const site_row_t *x = a;
+    const site_row_t *y = b;
+    return y->best_rssi - x->best_rssi;
+}
+
+// Copies the view out shard by shard; workers stall one shard at a time
+static site_row_t *site_snapshot(collector_t *col, size_t *n_out)
+{
+    size_t cap = 0, n = 0;
+    site_row_t *rows = NULL;
+
+    for (int i = 0; i < SITE_SHARDS; i++) {
+        site_shard_t *s = &col->site[i];
+        pthread_mutex_lock(&s->lock);
+        if (n + s->count > cap) {
+            cap = (n + s->count) * 2;
+            rows = realloc(rows, cap * sizeof(*rows));
+        }
+        for (size_t k = 0; k < s->cap; k++) {
+            const site_ap_t *ap = &s->slots[k];
+            if (!ap->key) {
+                continue;
+            }
+            site_row_t *r = &rows[n++];
+            r->ap = *ap;
+            r->best_rssi = -128;
+            for (uint8_t o = 0; o < ap->n_obs; o++) {
+                if (ap->obs[o].rssi > r->best_rssi) {
+                    r->best_rssi = ap->obs[o].rssi;
+                    r->best_node = ap->obs[o].node;
+                }
+            }
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+
+    *n_out = n;
+    return rows;
+}
+
+static void write_csv(collector_t *col, const site_row_t *rows, size_t n, const char *path)
+{
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        fprintf(stderr, "open %s: %s\n", tmp, strerror(errno));
+        return;
+    }
+
+    fprintf(f, "bssid,ssid,channel,authmode,best_rssi,best_node,nodes,sightings,first_us,last_us\n");
+    for (size_t i = 0; i < n; i++) {
+        const site_ap_t *ap = &rows[i].ap;
+        const uint8_t *b = ap->rec.bssid;
+        fprintf(f, "%02x:%02x:%02x:%02x:%02x:%02x,\"", b[0], b[1], b[2], b[3], b[4], b[5]);
+        for (const char *c = ap->rec.ssid; *c; c++) {
+            fputs(*c == '"' ? "\"\"" : (char[]){ *c, 0 }, f);
+        }
+        fprintf(f, "\",%u,%u,%d,%s,%u,%" PRIu32 ",%" PRId64 ",%" PRId64 "\n", ap->rec.channel,
+                ap->rec.authmode, rows[i].best_rssi, col->nodes[rows[i].best_node].name,
+                ap->n_obs, ap->sightings, ap->first_us, ap->last_us);
+    }
+    fclose(f);
+    rename(tmp, path);
+}
+
+typedef struct {
+    uint64_t frames, records, bytes, bad, gaps;
+} totals_t;
+
+static totals_t collector_totals(collector_t *col)
+{
+    totals_t t = {0};
+    for (size_t i = 0; i < col->n_nodes; i++) {
+        node_t *node = &col->nodes[i];
+        pthread_mutex_lock(&node->lock);
+        t.frames += node->pub.frames;
+        t.records += node->pub.records;
+        t.bytes += node->pub.bytes;
+        t.bad += node->pub.bad_frames;
+        t.gaps += node->pub.seq_gaps;
+        pthread_mutex_unlock(&node->lock);
+    }
+    return t;
+}
+
+static void report(collector_t *col, const char *csv, int verbose, int64_t now, double dt_s,
+                   totals_t *prev)
+{
+    totals_t t = collector_totals(col);
+
+    printf("--- %zu nodes: %.0f frames/s, %.0f records/s, %.2f MB/s, %" PRIu64 " bad, "
+           "%" PRIu64 " lost\n", col->n_nodes, (t.frames - prev->frames) / dt_s,
+           (t.records - prev->records) / dt_s, (t.bytes - prev->bytes) / dt_s / 1e6, t.bad,
+           t.gaps);
+    *prev = t;
+
+    if (verbose || col->n_nodes <= 32) {
+        printf("  %-24s %10s %8s %6s %6s %5s %14s %9s %9s\n", "node", "frames", "records", "bad",
+               "lost", "boots", "offset s", "drift ppm", "lag ms");
+        for (size_t i = 0; i < col->n_nodes; i++) {
+            node_stats_t st;
+            pthread_mutex_lock(&col->nodes[i].lock);
+            st = col->nodes[i].pub;
+            pthread_mutex_unlock(&col->nodes[i].lock);
+
+            printf("  %-24s %10" PRIu64 " %8" PRIu64 " %6" PRIu64 " %6" PRIu64 " %5" PRIu32,
+                   col->nodes[i].name, st.frames, st.records, st.bad_frames, st.seq_gaps,
+                   st.reboots);
+            if (st.aligned) {
+                // Lag: how far the node's latest frame is behind now, on the host clock
+                printf(" %14.3f %9.1f %9.1f\n", st.offset_us / 1e6, st.drift_ppm,
+                       col->sim ? 0.0 : (now - (st.last_dev_us + st.offset_us)) / 1e3);
+            } else {
+                printf(" %14s %9s %9s\n", "-", "-", "-");
+            }
+        }
+    }
+
+    size_t n;
+    site_row_t *rows = site_snapshot(col, &n);
+    size_t multi = 0;
+    for (size_t i = 0; i < n; i++) {
+        multi += rows[i].ap.n_obs > 1;
+    }
+    qsort(rows, n, sizeof(*rows), cmp_row_rssi);
+    printf("  site: %zu APs, %zu heard by more than one node\n", n, multi);
+    for (size_t i = 0; i < n && i < SITE_TOP; i++) {
+        const site_ap_t *ap = &rows[i].ap;
+        const uint8_t *b = ap->rec.bssid;
+        printf("  %02x:%02x:%02x:%02x:%02x:%02x %-32s ch%-3u %4d dBm at %-16s %u nodes\n", b[0],
+               b[1], b[2], b[3], b[4], b[5], ap->rec.ssid, ap->rec.channel, rows[i].best_rssi,
+               col->nodes[rows[i].best_node].name, ap->n_obs);
+    }
+    if (csv) {
+        write_csv(col, rows, n, csv);
+    }
+    free(rows);
+    fflush(stdout);
+}
+
+/* ===================== SOURCES ===================== */
+static speed_t baud_to_speed(long baud)
+{
+    switch (baud) {
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 1500000: return B1500000;
+    case 2000000: return B2000000;
+    case 3000000: return B3000000;
+    default: return 0;
+    }
+}
+
+static int open_path(const char *spec)
+{
+    char path[256];
+    long baud = 921600;
+
+    snprintf(path, sizeof(path), "%s", spec);
+    char *at = strrchr(path, '@');
+    if (at) {
+        *at = '\0';
+        baud = strtol(at + 1, NULL, 10);
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        fprintf(stderr, "open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        speed_t speed = baud_to_speed(baud);
+        if (speed) {
+            cfsetispeed(&tio, speed);
+            cfsetospeed(&tio, speed);
+        } else {
+            fprintf(stderr, "%s: unsupported baud %ld, keeping port speed\n", path, baud);
+        }
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+static int open_tcp(const char *hostport)
+{
+    char host[256];
+    snprintf(host, sizeof(host), "%s", hostport);
+    char *colon = strrchr(host, ':');
+    if (!colon) {
+        fprintf(stderr, "tcp:%s: expected host:port\n", hostport);
+        return -1;
+    }
+    *colon = '\0';
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res;
+    int rc = getaddrinfo(host, colon + 1, &hints, &res);
+    if (rc != 0) {
+        fprintf(stderr, "tcp:%s: %s\n", hostport, gai_strerror(rc));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    if (fd < 0) {
+        fprintf(stderr, "tcp:%s: %s\n", hostport, strerror(errno));
+    }
+    return fd;
+}
+
+static int open_listener(const char *port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)atoi(port)),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+
+    if (s < 0) {
+        perror("socket");
+        return -1;
+    }
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(s, 16) != 0) {
+        fprintf(stderr, "listen:%s: %s\n", port, strerror(errno));
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static int run_live(char **sources, int n_sources, int n_workers, int report_s, const char *csv,
+                    int verbose)
+{
+    static collector_t col;
+    int listeners[16];
+    int n_listeners = 0;
+
+    collector_start(&col, MAX_NODES, n_workers);
+    for (int i = 0; i < n_sources; i++) {
+        const char *spec = sources[i];
+        if (strncmp(spec, "listen:", 7) == 0) {
+            int s = n_listeners < 16 ? open_listener(spec + 7) : -1;
+            if (s >= 0) {
+                listeners[n_listeners++] = s;
+            }
+            continue;
+        }
+        int fd = strncmp(spec, "tcp:", 4) == 0 ? open_tcp(spec + 4) : open_path(spec);
+        if (fd >= 0 && collector_add_node(&col, spec, fd) < 0) {
+            close(fd);
+        }
+    }
+    if (col.n_nodes == 0 && n_listeners == 0) {
+        collector_finish(&col);
+        collector_free(&col);
+        return 1;
+    }
+
+    struct pollfd pfds[MAX_NODES + 16];
+    int owner[MAX_NODES + 16];
+    totals_t prev = {0};
+    int64_t last_report = now_us();
+
+    while (!stop_requested) {
+        int n = 0;
+        for (int i = 0; i < n_listeners; i++) {
+            pfds[n] = (struct pollfd){ .fd = listeners[i], .events = POLLIN };
+            owner[n++] = -1 - i;
+        }
+        for (size_t i = 0; i < col.n_nodes; i++) {
+            if (col.nodes[i].fd >= 0) {
+                pfds[n] = (struct pollfd){ .fd = col.nodes[i].fd, .events = POLLIN };
+                owner[n++] = (int)i;
+            }
+        }
+        if (n == 0) {
+            break;      // every source ended
+        }
+
+        int64_t next_report = last_report + report_s * 1000000LL;
+        int64_t wait_ms = (next_report - now_us()) / 1000;
+        int rc = poll(pfds, n, wait_ms > 0 ? (int)(wait_ms < 200 ? wait_ms : 200) : 0);
+        if (rc < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+
+        for (int k = 0; k < n && rc > 0; k++) {
+            if (!pfds[k].revents) {
+                continue;
+            }
+            if (owner[k] < 0) {
+                struct sockaddr_in peer;
+                socklen_t plen = sizeof(peer);
+                int fd = accept(pfds[k].fd, (struct sockaddr *)&peer, &plen);
+                if (fd >= 0) {
+                    char name[64];
+                    snprintf(name, sizeof(name), "%s:%u", inet_ntoa(peer.sin_addr),
+                             ntohs(peer.sin_port));
+                    if (collector_add_node(&col, name, fd) < 0) {
+                        close(fd);
+                    }
+                }
+                continue;
+            }
+
+            node_t *node = &col.nodes[owner[k]];
+            chunk_t *c = malloc(sizeof(*c));
+            ssize_t got = read(node->fd, c->data, sizeof(c->data));
+            if (got < 0 && (errno == EINTR || errno == EAGAIN)) {
+                free(c);
+                continue;
+            }
+            if (got <= 0) {
+                free(c);
+                close(node->fd);
+                node->fd = -1;
+                fprintf(stderr, "%s: closed\n", node->name);
+                continue;
+            }
+            c->node = (uint16_t)owner[k];
+            c->rx_us = now_us();
+            c->len = (size_t)got;
+            collector_submit(&col, c);
+        }
+
+        int64_t now = now_us();
+        if (now >= next_report) {
+            report(&col, csv, verbose, now, (now - last_report) / 1e6, &prev);
+            last_report = now;
+        }
+    }
+
+    collector_finish(&col);
+    int64_t now = now_us();
+    report(&col, csv, verbose, now, (now - last_report) / 1e6, &prev);
+    for (int i = 0; i < n_listeners; i++) {
+        close(listeners[i]);
+    }
+    for (size_t i = 0; i < col.n_nodes; i++) {
+        if (col.nodes[i].fd >= 0) {
+            close(col.nodes[i].fd);
+        }
+    }
+    collector_free(&col);
+    return 0;
+}
+
+/* ===================== LOAD TEST ===================== */
+#define SIM_AREA_M          300.0
+#define SIM_RANGE_M         80.0
+#define SIM_FRAME_US        100000      // virtual time between a node's frames
+#define SIM_FRAMES_PER_CHUNK 4
+#define SIM_RECORDS         20
+
+typedef struct {
+    // Truth: device time = (host time - boot_us) * (1 + drift)
+    int64_t boot_us;
+    double drift;
+    int64_t t_us;               // virtual host time of the next frame
+    uint16_t seq;
+    uint32_t *aps;
+    int8_t *rssi;
+    size_t n_aps;
+    size_t next_ap;
+    uint64_t rng;
+} sim_node_t;
+
+struct sim {
+    sim_node_t *nodes;
+    size_t n_nodes;
+    size_t n_aps;
+    size_t visible;             // APs in range of at least one node
+    volatile int stop;
+};
+
+typedef struct {
+    collector_t *col;
+    int index;
+    int stride;
+} feeder_arg_t;
+
+static uint64_t sim_rand(uint64_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+static double sim_uniform(uint64_t *s)
+{
+    return (sim_rand(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void sim_ap_record(uint32_t ap, scan_record_t *rec)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->bssid[0] = 0x02;       // locally administered
+    rec->bssid[1] = 0x5c;
+    rec->bssid[2] = (uint8_t)(ap >> 24);
+    rec->bssid[3] = (uint8_t)(ap >> 16);
+    rec->bssid[4] = (uint8_t)(ap >> 8);
+    rec->bssid[5] = (uint8_t)ap;
+    rec->channel = (uint8_t)(1 + ap % 11);
+    rec->authmode = 3;
+    rec->ssid_len = (uint8_t)snprintf(rec->ssid, sizeof(rec->ssid), "site-ap-%u", ap);
+}
+
+static void sim_init(sim_t *sim, size_t n_nodes, size_t n_aps)
+{
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    double (*ap_pos)[2] = malloc(n_aps * sizeof(*ap_pos));
+    uint8_t *seen = calloc(n_aps, 1);
+    int grid = (int)ceil(sqrt((double)n_nodes));
+
+    sim->nodes = calloc(n_nodes, sizeof(sim_node_t));
+    sim->n_nodes = n_nodes;
+    sim->n_aps = n_aps;
+    sim->visible = 0;
+    sim->stop = 0;
+    for (size_t a = 0; a < n_aps; a++) {
+        ap_pos[a][0] = sim_uniform(&rng) * SIM_AREA_M;
+        ap_pos[a][1] = sim_uniform(&rng) * SIM_AREA_M;
+    }
+
+    const int64_t t0 = 1000000000000LL;    // arbitrary host epoch
+    for (size_t i = 0; i < n_nodes; i++) {
+        sim_node_t *n = &sim->nodes[i];
+        double x = ((double)(i % grid) + 0.5) * SIM_AREA_M / grid;
+        double y = ((double)(i / grid) + 0.5) * SIM_AREA_M / grid;
+
+        n->rng = rng ^ (i + 1) * 0x2545f4914f6cdd1dULL;
+        n->boot_us = t0 - (int64_t)(sim_uniform(&rng) * 3 * 86400e6);
+        n->drift = (sim_uniform(&rng) * 2 - 1) * 40e-6;
+        n->t_us = t0 + (int64_t)(sim_uniform(&rng) * SIM_FRAME_US);
+        n->aps = malloc(n_aps * sizeof(uint32_t));
+        n->rssi = malloc(n_aps);
+        for (size_t a = 0; a < n_aps; a++) {
+            double d = hypot(ap_pos[a][0] - x, ap_pos[a][1] - y);
+            if (d > SIM_RANGE_M) {
+                continue;
+            }
+            d = d < 1 ? 1 : d;
+            n->aps[n->n_aps] = (uint32_t)a;
+            n->rssi[n->n_aps++] = (int8_t)lround(-40 - 30 * log10(d));
+            sim->visible += !seen[a];
+            seen[a] = 1;
+        }
+    }
+    free(ap_pos);
+    free(seen);
+}
+
+static void sim_free(sim_t *sim)
+{
+    for (size_t i = 0; i < sim->n_nodes; i++) {
+        free(sim->nodes[i].aps);
+        free(sim->nodes[i].rssi);
+    }
+    free(sim->nodes);
+}
+
+static int64_t sim_dev_time(const sim_node_t *n, int64_t host_us)
+{
+    return (int64_t)llround((host_us - n->boot_us) * (1 + n->drift));
+}
+
+static int64_t sim_true_offset(const sim_node_t *n, int64_t dev_us)
+{
+    double host = n->boot_us + dev_us / (1 + n->drift);
+    return (int64_t)llround(host - dev_us);
+}
+
+// Queueing delay: a floor, an exponential tail and rare long stalls
+static int64_t sim_delay(sim_node_t *n)
+{
+    double u = sim_uniform(&n->rng);
+    int64_t d = 1000 + (int64_t)(-4000 * log(1 - u));
+    if (sim_rand(&n->rng) % 100 == 0) {
+        d += 200000;
+    }
+    return d;
+}
+
+static size_t sim_frame(sim_node_t *n, uint8_t *out, size_t cap)
+{
+    uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    size_t len = 2;
+    uint8_t count = 0;
+
+    for (int k = 0; k < SIM_RECORDS && (size_t)k < n->n_aps; k++) {
+        scan_record_t rec;
+        size_t a = n->next_ap++ % n->n_aps;
+        sim_ap_record(n->aps[a], &rec);
+        rec.rssi = (int8_t)(n->rssi[a] + (int)(sim_rand(&n->rng) % 7) - 3);
+        size_t used = scan_record_encode(&rec, payload + len, sizeof(payload) - len);
+        if (used == 0) {
+            break;
+        }
+        len += used;
+        count++;
+    }
+    payload[0] = count;
+    payload[1] = SCAN_RECORD_WIRE_MASK;
+
+    stream_frame_hdr_t hdr = {
+        .type = STREAM_FRAME_AP_BATCH,
+        .seq = n->seq++,
+        .timestamp_us = (uint64_t)sim_dev_time(n, n->t_us),
+    };
+    n->t_us += SIM_FRAME_US;
+    return stream_frame_encode(&hdr, payload, len, out, cap);
+}
+
+static void *feeder_main(void *arg)
+{
+    feeder_arg_t *fa = arg;
+    collector_t *col = fa->col;
+    sim_t *sim = col->sim;
+
+    while (!sim->stop && !stop_requested) {
+        for (size_t i = fa->index; i < sim->n_nodes; i += fa->stride) {
+            sim_node_t *n = &sim->nodes[i];
+            chunk_t *c = malloc(sizeof(*c));
+            c->len = 0;
+            for (int f = 0; f < SIM_FRAMES_PER_CHUNK; f++) {
+                c->len += sim_frame(n, c->data + c->len, sizeof(c->data) - c->len);
+            }
+            // Received once the last frame of the chunk is through
+            c->rx_us = n->t_us - SIM_FRAME_US + sim_delay(n);
+            c->node = (uint16_t)i;
+            collector_submit(col, c);
+        }
+    }
+    free(fa);
+    return NULL;
+}
+
+typedef struct {
+    double frames_per_s;
+    double records_per_s;
+    double mb_per_s;
+    double worker_cpu_s;
+    double max_err_ms;
+    double mean_err_ms;
+    size_t site_aps;
+} load_result_t;
+
+static load_result_t run_load(size_t n_nodes, size_t n_aps, int n_workers, double seconds,
+                              int report_s, int verbose, int quiet)
+{
+    static collector_t col;
+    static sim_t sim;
+    pthread_t feeders[MAX_WORKERS];
+    load_result_t res = {0};
+
+    sim_init(&sim, n_nodes, n_aps);
+    col.sim = &sim;
+    collector_start(&col, n_nodes, n_workers);
+    for (size_t i = 0; i < n_nodes; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "sim%zu", i);
+        collector_add_node(&col, name, -1);
+    }
+
+    int64_t start = now_us();
+    for (int f = 0; f < n_workers; f++) {
+        feeder_arg_t *fa = malloc(sizeof(*fa));
+        *fa = (feeder_arg_t){ .col = &col, .index = f, .stride = n_workers };
+        pthread_create(&feeders[f], NULL, feeder_main, fa);
+    }
+
+    totals_t prev = {0};
+    int64_t last_report = start;
+    int64_t end = start + (int64_t)(seconds * 1e6);
+    while (!stop_requested && now_us() < end) {
+        usleep(50000);
+        int64_t now = now_us();
+        if (!quiet && now - last_report >= report_s * 1000000LL) {
+            report(&col, NULL, verbose, now, (now - last_report) / 1e6, &prev);
+            last_report = now;
+        }
+    }
+    sim.stop = 1;
+    for (int f = 0; f < n_workers; f++) {
+        pthread_join(feeders[f], NULL);
+    }
+    collector_finish(&col);
+    double wall_s = (now_us() - start) / 1e6;
+
+    totals_t t = collector_totals(&col);
+    res.frames_per_s = t.frames / wall_s;
+    res.records_per_s = t.records / wall_s;
+    res.mb_per_s = t.bytes / wall_s / 1e6;
+    for (int w = 0; w < n_workers; w++) {
+        res.worker_cpu_s += col.worker_cpu_s[w];
+    }
+
+    // Alignment error at each node's last frame, against the simulated truth
+    double sum = 0;
+    for (size_t i = 0; i < n_nodes; i++) {
+        const node_stats_t *st = &col.nodes[i].work;
+        double err = fabs((double)(st->offset_us - sim_true_offset(&sim.nodes[i], st->last_dev_us)));
+        res.max_err_ms = err / 1e3 > res.max_err_ms ? err / 1e3 : res.max_err_ms;
+        sum += err / 1e3;
+    }
+    res.mean_err_ms = n_nodes ? sum / n_nodes : 0;
+    for (int i = 0; i < SITE_SHARDS; i++) {
+        res.site_aps += col.site[i].count;
+    }
+
+    if (!quiet) {
+        int64_t now = now_us();
+        report(&col, NULL, verbose, now, (now - last_report) / 1e6, &prev);
+        printf("load: %zu nodes, %d workers, %.1f s: %.0f frames/s, %.0f records/s, "
+               "%.1f MB/s, worker CPU %.1f s\n", n_nodes, n_workers, wall_s, res.frames_per_s,
+               res.records_per_s, res.mb_per_s, res.worker_cpu_s);
+        printf("load: alignment error mean %.3f ms, max %.3f ms; site %zu of %zu visible APs\n",
+               res.mean_err_ms, res.max_err_ms, res.site_aps, sim.visible);
+    }
+    res.site_aps = res.site_aps == sim.visible ? res.site_aps : 0;
+
+    collector_free(&col);
+    sim_free(&sim);
+    return res;
+}
+
+static int run_sweep(size_t n_nodes, size_t n_aps, double seconds)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    double base = 0;
+
+    printf("%zu simulated nodes, %zu APs, %ld cores, %.1f s per run\n", n_nodes, n_aps, cores,
+           seconds);
+    printf("%8s %12s %12s %9s %8s %12s %12s\n", "workers", "frames/s", "records/s", "MB/s",
+           "speedup", "cpu s", "max err ms");
+    for (long w = 1; w <= cores && w <= MAX_WORKERS && !stop_requested; w = w * 2 > cores &&
+         w < cores ? cores : w * 2) {
+        load_result_t r = run_load(n_nodes, n_aps, (int)w, seconds, 0, 0, 1);
+        base = base > 0 ? base : r.frames_per_s;
+        printf("%8ld %12.0f %12.0f %9.1f %8.2f %12.1f %12.3f%s\n", w, r.frames_per_s,
+               r.records_per_s, r.mb_per_s, r.frames_per_s / base, r.worker_cpu_s, r.max_err_ms,
+               r.site_aps ? "" : "  (site incomplete)");
+        fflush(stdout);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int n_workers = cores > 1 ? (int)(cores < MAX_WORKERS ? cores : MAX_WORKERS) : 1;
+    int report_s = 5;
+    const char *csv = NULL;
+    int verbose = 0;
+    long load_nodes = 0;
+    long n_aps = 2000;
+    double seconds = 10;
+    int sweep = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:p:o:vL:a:d:S")) != -1) {
+        switch (opt) {
+        case 'w': n_workers = atoi(optarg); break;
+        case 'p': report_s = atoi(optarg); break;
+        case 'o': csv = optarg; break;
+        case 'v': verbose = 1; break;
+        case 'L': load_nodes = atol(optarg); break;
+        case 'a': n_aps = atol(optarg); break;
+        case 'd': seconds = atof(optarg); break;
+        case 'S': sweep = 1; break;
+        default:
+            goto usage;
+        }
+    }
+    if (n_workers < 1 || n_workers > MAX_WORKERS || report_s < 1 || load_nodes < 0 ||
+        load_nodes > MAX_NODES || n_aps < 1 || (!load_nodes && optind >= argc)) {
+        goto usage;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (load_nodes && sweep) {
+        return run_sweep((size_t)load_nodes, (size_t)n_aps, seconds);
+    }
+    if (load_nodes) {
+        load_result_t r = run_load((size_t)load_nodes, (size_t)n_aps, n_workers, seconds,
+                                   report_s, verbose, 0);
+        return r.site_aps ? 0 : 1;
+    }
+    return run_live(argv + optind, argc - optind, n_workers, report_s, csv, verbose);
+
+usage:
+    fprintf(stderr,
+            "usage: %s [-w workers] [-p report_s] [-o site.csv] [-v] source...\n"
+            "       %s -L nodes [-a aps] [-d seconds] [-w workers | -S]\n"
+            "  source: /dev/ttyX[@baud] | path | tcp:host:port | listen:port\n",
+            argv[0], argv[0]);
+    return 2;
+}
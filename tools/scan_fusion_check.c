@@ -0,0 +1,454 @@
+/* ===================== SCAN FUSION CHECK =====================
+ * Host test of the multi-scan fusion stage (scan_fusion.h) against scan
+ * traces: the framed binary stream recorded from the firmware, where each
+ * AP_BATCH frame is one scan. Record with fusion off
+ * (CONFIG_SCANNER_FUSION_SCANS=1) so every frame is a single sub-scan:
+ *   cat /dev/ttyUSB0 > trace.bin
+ *
+ * Every N consecutive scans are fused and compared with the scans on
+ * their own: a fused report must contain every BSSID of its sub-scans
+ * with presence seen/N and the median of their RSSI samples. Detection is
+ * reported as the share of the trace's BSSIDs found per report.
+ *
+ * Without a trace, a simulated one is generated: APs with a true RSSI,
+ * per-frame reception falling off towards the noise floor, and a probe
+ * response plus the beacons that fall inside the dwell. It compares one
+ * long scan per cycle against N short ones over the same APs, and can be
+ * written out (-w) in the stream format to exercise the trace path.
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o scan_fusion_check \
+ *      tools/scan_fusion_check.c components/scanner/scan_fusion.c \
+ *      components/scanner/scan_record.c components/scanner/stream_frame.c \
+ *      components/scanner/cobs.c components/scanner/crc32.c
+ *
+ * Usage:
+ *   scan_fusion_check [-n scans] [trace.bin]
+ *   scan_fusion_check [-n scans] [-d short_ms] [-D long_ms] [-w trace.bin]
+ * Exits non-zero on the first failed check.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "scan_fusion.h"
+#include "scan_record.h"
+#include "stream_frame.h"
+
+#define MAX_SCANS       4096
+#define MAX_PER_SCAN    64
+#define MAX_APS         256
+#define SIM_APS         60
+#define SIM_CYCLES      400
+#define BEACON_MS       102.4
+
+typedef struct {
+    scan_record_t recs[MAX_PER_SCAN];
+    size_t n;
+    int64_t t_us;
+} trace_scan_t;
+
+static trace_scan_t scans[MAX_SCANS];
+static size_t n_scans;
+
+static int fail(const char *what, size_t scan)
+{
+    fprintf(stderr, "FAIL: %s (scan %zu)\n", what, scan);
+    return 1;
+}
+
+static double urand(void)
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+/* ===================== TRACE I/O ===================== */
+static int load_trace(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+
+    static stream_deframer_t deframer;
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    int c;
+    while ((c = fgetc(fp)) != EOF && n_scans < MAX_SCANS) {
+        size_t len = stream_deframer_push(&deframer, (uint8_t)c);
+        stream_frame_hdr_t hdr;
+        size_t plen;
+        if (len == 0 ||
+            stream_frame_decode(deframer.buf, len, &hdr, payload, sizeof(payload), &plen) !=
+                STREAM_FRAME_OK ||
+            hdr.type != STREAM_FRAME_AP_BATCH || plen < 2) {
+            continue;
+        }
+
+        trace_scan_t *s = &scans[n_scans];
+        size_t off = 2;
+        s->n = 0;
+        s->t_us = (int64_t)hdr.timestamp_us;
+        for (unsigned i = 0; i < payload[0] && s->n < MAX_PER_SCAN; i++) {
+            size_t n = scan_record_decode(payload + off, plen - off, payload[1], &s->recs[s->n]);
+            if (n == 0) {
+                break;
+            }
+            off += n;
+            s->n++;
+        }
+        n_scans++;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static int write_trace(const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    static uint8_t wire[STREAM_FRAME_MAX_WIRE];
+    for (size_t k = 0; k < n_scans; k++) {
+        size_t len = 2;
+        payload[0] = (uint8_t)scans[k].n;
+        payload[1] = SCAN_RECORD_WIRE_MASK;
+        for (size_t i = 0; i < scans[k].n; i++) {
+            len += scan_record_encode(&scans[k].recs[i], payload + len, sizeof(payload) - len);
+        }
+        stream_frame_hdr_t hdr = {
+            .type = STREAM_FRAME_AP_BATCH,
+            .seq = (uint16_t)k,
+            .timestamp_us = (uint64_t)scans[k].t_us,
+        };
+        size_t n = stream_frame_encode(&hdr, payload, len, wire, sizeof(wire));
+        fwrite(wire, 1, n, fp);
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/* ===================== SIMULATION ===================== */
+typedef struct {
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t channel;
+    double probe_answer;        // busy APs skip probe responses
+} sim_ap_t;
+
+static sim_ap_t sim_aps[SIM_APS];
+
+static void sim_init(void)
+{
+    for (int i = 0; i < SIM_APS; i++) {
+        sim_ap_t *ap = &sim_aps[i];
+        ap->bssid[0] = 0x24;
+        ap->bssid[1] = 0x0A;
+        ap->bssid[2] = 0xC4;
+        ap->bssid[3] = 0x10;
+        ap->bssid[4] = (uint8_t)(i >> 8);
+        ap->bssid[5] = (uint8_t)i;
+        ap->rssi = (int8_t)(-40 - rand() % 55);
+        ap->channel = 1 + rand() % 13;
+        ap->probe_answer = 0.3 + 0.6 * urand();
+    }
+}
+
+// Chance that one frame from the AP is received and decoded
+static double frame_reception(int rssi)
+{
+    double r = (rssi + 95) / 15.0;
+    return r < 0 ? 0 : r > 1 ? 1 : r;
+}
+
+// One active scan of every AP with the given per-channel dwell
+static void sim_scan(trace_scan_t *s, double dwell_ms, int64_t t_us)
+{
+    s->n = 0;
+    s->t_us = t_us;
+    for (int i = 0; i < SIM_APS && s->n < MAX_PER_SCAN; i++) {
+        const sim_ap_t *ap = &sim_aps[i];
+        double r = frame_reception(ap->rssi);
+
+        int heard = urand() < r * ap->probe_answer;
+        // Beacons falling inside the dwell, random phase
+        for (double t = urand() * BEACON_MS; t < dwell_ms && !heard; t += BEACON_MS) {
+            heard = urand() < r;
+        }
+        if (!heard) {
+            continue;
+        }
+
+        scan_record_t *rec = &s->recs[s->n++];
+        memset(rec, 0, sizeof(*rec));
+        memcpy(rec->bssid, ap->bssid, 6);
+        // Fading: +-6 dB triangular
+        rec->rssi = (int8_t)(ap->rssi + (rand() % 7) + (rand() % 7) - 6);
+        rec->channel = ap->channel;
+        rec->ssid_len = (uint8_t)snprintf(rec->ssid, sizeof(rec->ssid), "AP%02d", i);
+    }
+}
+
+/* ===================== CHECKS ===================== */
+static int unit_checks(void)
+{
+    const int8_t odd[] = { -70, -50, -90 };
+    const int8_t even[] = { -70, -71, -60, -80 };
+    if (scan_fusion_median(odd, 3) != -70 || scan_fusion_median(even, 4) != -71 ||
+        scan_fusion_median(even, 1) != -70) {
+        return fail("median", 0);
+    }
+
+    scan_fusion_entry_t storage[2];
+    scan_fusion_t f;
+    scan_fusion_ap_t out[2];
+    scan_record_t r[3] = {0};
+    r[0].bssid[5] = 1;
+    r[0].rssi = -60;
+    r[1] = r[0];                // duplicate within one scan
+    r[1].rssi = -20;
+    r[2].bssid[5] = 2;
+    r[2].rssi = -80;
+
+    scan_fusion_init(&f, storage, 2);
+    scan_fusion_add_scan(&f, r, 3, 1000);
+    if (f.count != 2 || storage[0].seen != 1) {
+        return fail("duplicate in one scan", 0);
+    }
+
+    scan_record_t r3 = r[0];
+    r3.bssid[5] = 3;
+    scan_fusion_add_scan(&f, &r3, 1, 2000);
+    if (f.dropped != 1) {
+        return fail("full storage", 0);
+    }
+
+    // Hidden SSID learned in the first scan survives a beacon-only sighting
+    scan_record_t named = r[2];
+    named.ssid_len = 4;
+    memcpy(named.ssid, "Lab2", 5);
+    scan_fusion_reset(&f);
+    scan_fusion_add_scan(&f, &named, 1, 0);
+    scan_fusion_add_scan(&f, &r[2], 1, 1000);
+    scan_fusion_add_scan(&f, &r[0], 1, 2000);
+    size_t n = scan_fusion_report(&f, 3000, out, 2);
+    if (n != 2 || out[0].rec.rssi != -60 || out[1].seen != 2 || out[1].scans != 3 ||
+        out[1].age_ms != 2 || strcmp(out[1].rec.ssid, "Lab2") != 0) {
+        return fail("report", 0);
+    }
+
+    // A report too small for the union keeps the strongest
+    n = scan_fusion_report(&f, 3000, out, 1);
+    if (n != 1 || out[0].rec.rssi != -60) {
+        return fail("report truncation", 0);
+    }
+    return 0;
+}
+
+typedef struct {
+    double found;               // BSSIDs per report, summed
+    double rssi_err;            // |reported - true| per BSSID, summed
+    size_t reports;
+    size_t samples;
+} detect_stats_t;
+
+static const sim_ap_t *sim_find(const uint8_t bssid[6])
+{
+    for (int i = 0; i < SIM_APS; i++) {
+        if (memcmp(sim_aps[i].bssid, bssid, 6) == 0) {
+            return &sim_aps[i];
+        }
+    }
+    return NULL;
+}
+
+// Fuses scans[first..first+n) and checks the report against them
+static int fuse_and_check(size_t first, size_t n, detect_stats_t *st, int simulated)
+{
+    static scan_fusion_entry_t storage[MAX_APS];
+    static scan_fusion_ap_t out[MAX_APS];
+    scan_fusion_t f;
+
+    scan_fusion_init(&f, storage, MAX_APS);
+    for (size_t k = first; k < first + n; k++) {
+        scan_fusion_add_scan(&f, scans[k].recs, scans[k].n, scans[k].t_us);
+    }
+    int64_t now = scans[first + n - 1].t_us;
+    size_t count = scan_fusion_report(&f, now, out, MAX_APS);
+
+    // Every sighting is in the report, with its presence and median
+    for (size_t k = first; k < first + n; k++) {
+        for (size_t i = 0; i < scans[k].n; i++) {
+            int8_t samples[SCAN_FUSION_MAX_SCANS];
+            uint8_t seen = 0;
+            int64_t last = 0;
+            for (size_t j = first; j < first + n; j++) {
+                for (size_t m = 0; m < scans[j].n; m++) {
+                    if (memcmp(scans[j].recs[m].bssid, scans[k].recs[i].bssid, 6) == 0) {
+                        samples[seen++] = scans[j].recs[m].rssi;
+                        last = scans[j].t_us;
+                        break;
+                    }
+                }
+            }
+
+            const scan_fusion_ap_t *ap = NULL;
+            for (size_t a = 0; a < count && !ap; a++) {
+                if (memcmp(out[a].rec.bssid, scans[k].recs[i].bssid, 6) == 0) {
+                    ap = &out[a];
+                }
+            }
+            if (!ap) {
+                return fail("sighting missing from report", k);
+            }
+            if (ap->seen != seen || ap->scans != n) {
+                return fail("presence", k);
+            }
+            if (ap->rec.rssi != scan_fusion_median(samples, seen)) {
+                return fail("median rssi", k);
+            }
+            if (ap->age_ms != (uint32_t)((now - last) / 1000)) {
+                return fail("age", k);
+            }
+        }
+    }
+    for (size_t a = 1; a < count; a++) {
+        if (out[a].rec.rssi > out[a - 1].rec.rssi) {
+            return fail("report order", first);
+        }
+    }
+
+    st->found += count;
+    st->reports++;
+    if (simulated) {
+        for (size_t a = 0; a < count; a++) {
+            const sim_ap_t *ap = sim_find(out[a].rec.bssid);
+            st->rssi_err += abs(out[a].rec.rssi - ap->rssi);
+            st->samples++;
+        }
+    }
+    return 0;
+}
+
+static int run_trace(size_t per_report, int simulated, detect_stats_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    for (size_t k = 0; k + per_report <= n_scans; k += per_report) {
+        if (fuse_and_check(k, per_report, st, simulated) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static size_t trace_union(void)
+{
+    static uint8_t seen[MAX_APS][6];
+    size_t n = 0;
+    for (size_t k = 0; k < n_scans; k++) {
+        for (size_t i = 0; i < scans[k].n; i++) {
+            size_t j = 0;
+            while (j < n && memcmp(seen[j], scans[k].recs[i].bssid, 6) != 0) {
+                j++;
+            }
+            if (j == n && n < MAX_APS) {
+                memcpy(seen[n++], scans[k].recs[i].bssid, 6);
+            }
+        }
+    }
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    int fused = 3;
+    double short_ms = 100, long_ms = 300;
+    const char *out_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:d:D:w:")) != -1) {
+        switch (opt) {
+        case 'n': fused = atoi(optarg); break;
+        case 'd': short_ms = atof(optarg); break;
+        case 'D': long_ms = atof(optarg); break;
+        case 'w': out_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-n scans] [-d short_ms] [-D long_ms] [-w out] [trace]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (fused < 1 || fused > SCAN_FUSION_MAX_SCANS) {
+        fprintf(stderr, "scans must be 1..%d\n", SCAN_FUSION_MAX_SCANS);
+        return 2;
+    }
+
+    if (unit_checks() != 0) {
+        return 1;
+    }
+
+    detect_stats_t single, multi;
+
+    if (optind < argc) {
+        if (load_trace(argv[optind]) != 0) {
+            return 1;
+        }
+        size_t total = trace_union();
+        if (run_trace(1, 0, &single) != 0 || run_trace((size_t)fused, 0, &multi) != 0) {
+            return 1;
+        }
+        printf("%zu scans, %zu BSSIDs in the trace\n", n_scans, total);
+        printf("single scan:   %5.1f BSSIDs per report (%4.1f%%)\n", single.found / single.reports,
+               100.0 * single.found / single.reports / total);
+        printf("fused x%-2d:     %5.1f BSSIDs per report (%4.1f%%), %zu reports\n", fused,
+               multi.found / multi.reports, 100.0 * multi.found / multi.reports / total,
+               multi.reports);
+        printf("OK\n");
+        return 0;
+    }
+
+    // Same APs, same number of cycles: one long scan vs N short ones per cycle
+    srand(1);
+    sim_init();
+    for (size_t c = 0; c < SIM_CYCLES; c++) {
+        sim_scan(&scans[c], long_ms, (int64_t)c * 10000000);
+    }
+    n_scans = SIM_CYCLES;
+    if (run_trace(1, 1, &single) != 0) {
+        return 1;
+    }
+
+    for (size_t c = 0; c < SIM_CYCLES; c++) {
+        for (int k = 0; k < fused; k++) {
+            sim_scan(&scans[c * fused + k], short_ms,
+                     (int64_t)c * 10000000 + (int64_t)(k * short_ms * 14 * 1000));
+        }
+    }
+    n_scans = (size_t)SIM_CYCLES * fused;
+    if (out_path && write_trace(out_path) != 0) {
+        return 1;
+    }
+    if (run_trace((size_t)fused, 1, &multi) != 0) {
+        return 1;
+    }
+
+    // 13 channels per sweep
+    printf("Simulated %d APs, %d cycles\n", SIM_APS, SIM_CYCLES);
+    printf("1 x %3.0f ms/ch: %5.1f APs found (%4.1f%%), RSSI error %.2f dB, radio %4.0f ms, "
+           "longest radio hold %4.0f ms\n", long_ms, single.found / single.reports,
+           100.0 * single.found / single.reports / SIM_APS, single.rssi_err / single.samples,
+           13 * long_ms, 13 * long_ms);
+    printf("%d x %3.0f ms/ch: %5.1f APs found (%4.1f%%), RSSI error %.2f dB, radio %4.0f ms, "
+           "longest radio hold %4.0f ms\n", fused, short_ms, multi.found / multi.reports,
+           100.0 * multi.found / multi.reports / SIM_APS, multi.rssi_err / multi.samples,
+           13 * short_ms * fused, 13 * short_ms);
+    printf("OK\n");
+    return 0;
+}
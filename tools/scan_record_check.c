@@ -0,0 +1,160 @@
+/* ===================== SCAN RECORD CHECK =====================
+ * Host round-trip check of the schema-generated record codec over every
+ * field mask: encode -> decode must reproduce exactly the enabled fields,
+ * leave the others zero, report the same length as scan_record_wire_len
+ * and reject every truncation. The default mask is also compared byte
+ * for byte against the original fixed layout.
+ *
+ * Build (repeat with -DSCAN_RECORD_MASK=<n> to check a firmware mask):
+ *   cc -O2 -Icomponents/scanner/include -o scan_record_check \
+ *      tools/scan_record_check.c components/scanner/scan_record.c
+ *
+ * Usage:
+ *   scan_record_check [records per mask]
+ * Exits non-zero on the first mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scan_record.h"
+
+static void random_record(scan_record_t *rec, unsigned i)
+{
+    memset(rec, 0, sizeof(*rec));
+    for (int b = 0; b < 6; b++) {
+        rec->bssid[b] = (uint8_t)rand();
+    }
+    rec->rssi = (int8_t)rand();
+    rec->channel = (uint8_t)rand();
+    rec->authmode = (uint8_t)rand();
+    // Walk every SSID length, including empty and full
+    rec->ssid_len = (uint8_t)(i % (SCAN_RECORD_SSID_MAX + 1));
+    for (int c = 0; c < rec->ssid_len; c++) {
+        rec->ssid[c] = (char)(' ' + rand() % 95);
+    }
+    rec->distance_cm = (uint32_t)rand() * 2654435761u;
+    rec->vendor_id = (uint16_t)rand();
+}
+
+// The record as a decoder should see it under mask
+static void project(const scan_record_t *in, uint8_t mask, scan_record_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    memcpy(out->bssid, in->bssid, 6);
+    if (mask & SCAN_FIELD_RSSI) {
+        out->rssi = in->rssi;
+    }
+    if (mask & SCAN_FIELD_CHANNEL) {
+        out->channel = in->channel;
+    }
+    if (mask & SCAN_FIELD_AUTHMODE) {
+        out->authmode = in->authmode;
+    }
+    if (mask & SCAN_FIELD_SSID) {
+        out->ssid_len = in->ssid_len;
+        memcpy(out->ssid, in->ssid, in->ssid_len);
+    }
+    if (mask & SCAN_FIELD_DISTANCE) {
+        out->distance_cm = in->distance_cm;
+    }
+    if (mask & SCAN_FIELD_VENDOR) {
+        out->vendor_id = in->vendor_id;
+    }
+}
+
+static size_t expected_len(const scan_record_t *rec, uint8_t mask)
+{
+    return 6 + !!(mask & SCAN_FIELD_RSSI) + !!(mask & SCAN_FIELD_CHANNEL) +
+           !!(mask & SCAN_FIELD_AUTHMODE) +
+           ((mask & SCAN_FIELD_SSID) ? 1 + rec->ssid_len : 0) +
+           ((mask & SCAN_FIELD_DISTANCE) ? 4 : 0) + ((mask & SCAN_FIELD_VENDOR) ? 2 : 0);
+}
+
+static size_t legacy_encode(const scan_record_t *rec, uint8_t *out)
+{
+    memcpy(out, rec->bssid, 6);
+    out[6] = (uint8_t)rec->rssi;
+    out[7] = rec->channel;
+    out[8] = rec->authmode;
+    out[9] = rec->ssid_len;
+    memcpy(out + 10, rec->ssid, rec->ssid_len);
+    return 10 + rec->ssid_len;
+}
+
+static int fail(const char *what, unsigned mask, unsigned i)
+{
+    fprintf(stderr, "FAIL: %s (mask 0x%02x, record %u)\n", what, mask, i);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned per_mask = argc > 1 ? (unsigned)atoi(argv[1]) : 2000;
+    uint8_t buf[SCAN_RECORD_MAX_LEN_ANY];
+    uint8_t legacy[SCAN_RECORD_MAX_LEN_ANY];
+    unsigned masks = 0;
+    unsigned long checked = 0;
+
+    srand(1);
+    for (unsigned mask = 0; mask <= SCAN_RECORD_MASK_ALL; mask++) {
+        if (!(mask & SCAN_FIELD_BSSID)) {
+            continue;
+        }
+        masks++;
+
+        for (unsigned i = 0; i < per_mask; i++) {
+            scan_record_t rec, want, got;
+            random_record(&rec, i);
+            project(&rec, (uint8_t)mask, &want);
+
+            size_t len = scan_record_encode_mask(&rec, (uint8_t)mask, buf, sizeof(buf));
+            if (len != expected_len(&rec, (uint8_t)mask)) {
+                return fail("encoded length", mask, i);
+            }
+            if (scan_record_encode_mask(&rec, (uint8_t)mask, buf, len - 1) != 0) {
+                return fail("encode into short buffer", mask, i);
+            }
+            if (scan_record_wire_len(buf, len, (uint8_t)mask) != len) {
+                return fail("wire_len", mask, i);
+            }
+            if (scan_record_decode(buf, len, (uint8_t)mask, &got) != len) {
+                return fail("decoded length", mask, i);
+            }
+            if (memcmp(&got, &want, sizeof(got)) != 0) {
+                return fail("decoded fields", mask, i);
+            }
+            for (size_t cut = 0; cut < len; cut++) {
+                if (scan_record_decode(buf, cut, (uint8_t)mask, &got) != 0) {
+                    return fail("truncated input accepted", mask, i);
+                }
+            }
+
+            if (mask == SCAN_RECORD_MASK_DEFAULT &&
+                (legacy_encode(&rec, legacy) != len || memcmp(legacy, buf, len) != 0)) {
+                return fail("default mask differs from the fixed layout", mask, i);
+            }
+            if (mask == SCAN_RECORD_WIRE_MASK) {
+                uint8_t fixed[SCAN_RECORD_MAX_LEN_ANY];
+                if (scan_record_encode(&rec, fixed, sizeof(fixed)) != len ||
+                    memcmp(fixed, buf, len) != 0) {
+                    return fail("compile-time mask encoder", mask, i);
+                }
+            }
+            checked++;
+        }
+    }
+
+    // Oversized SSID length on the wire must be rejected
+    memset(buf, 0, sizeof(buf));
+    buf[9] = SCAN_RECORD_SSID_MAX + 1;
+    scan_record_t rec;
+    if (scan_record_decode(buf, sizeof(buf), SCAN_FIELD_BSSID | SCAN_FIELD_SSID | SCAN_FIELD_RSSI |
+                           SCAN_FIELD_CHANNEL | SCAN_FIELD_AUTHMODE, &rec) != 0) {
+        return fail("oversized SSID accepted", SCAN_RECORD_MASK_DEFAULT, 0);
+    }
+
+    printf("OK: %u masks, %lu records, build mask 0x%02x (max %d bytes)\n", masks, checked,
+           SCAN_RECORD_WIRE_MASK, SCAN_RECORD_MAX_LEN);
+    return 0;
+}
@@ -0,0 +1,333 @@
+/* ===================== SCAN STREAM READER =====================
+ * Linux host reader for the framed binary stream (see stream_frame.h).
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o scan_stream_reader \
+ *      tools/scan_stream_reader.c components/scanner/cobs.c \
+ *      components/scanner/crc32.c components/scanner/stream_frame.c \
+ *      components/scanner/scan_record.c components/scanner/channel_stats.c \
+ *      components/scanner/stage_duty.c components/scanner/dlog_ring.c \
+ *      components/scanner/fp_db.c
+ *
+ * Usage:
+ *   scan_stream_reader /dev/ttyUSB0 [baud]
+ *   scan_stream_reader -            (read from stdin)
+ *
+ * A pty pair works the same as a real port, e.g. for bench testing:
+ *   socat -d -d pty,raw,echo=0 pty,raw,echo=0
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "channel_stats.h"
+#include "dlog_ring.h"
+#include "fp_db.h"
+#include "scan_record.h"
+#include "stage_duty.h"
+#include "stream_frame.h"
+
+static volatile sig_atomic_t stop_requested = 0;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t records;
+    uint64_t bad_frames;
+    uint64_t seq_gaps;
+    int have_seq;
+    uint16_t last_seq;
+} reader_stats_t;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop_requested = 1;
+}
+
+static speed_t baud_to_speed(long baud)
+{
+    switch (baud) {
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 1500000: return B1500000;
+    case 2000000: return B2000000;
+    case 3000000: return B3000000;
+    default: return 0;
+    }
+}
+
+static int open_port(const char *path, long baud)
+{
+    if (strcmp(path, "-") == 0) {
+        return STDIN_FILENO;
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        speed_t speed = baud_to_speed(baud);
+        if (speed) {
+            cfsetispeed(&tio, speed);
+            cfsetospeed(&tio, speed);
+        } else {
+            fprintf(stderr, "unsupported baud %ld, keeping port speed\n", baud);
+        }
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    return fd;
+}
+
+static void print_ap_batch(const stream_frame_hdr_t *hdr, const uint8_t *payload, size_t len,
+                           reader_stats_t *stats)
+{
+    if (len < 2) {
+        stats->bad_frames++;
+        return;
+    }
+
+    unsigned count = payload[0];
+    uint8_t fields = payload[1];
+    size_t off = 2;
+
+    printf("frame seq=%u t=%" PRIu64 "us aps=%u%s%s\n", hdr->seq, hdr->timestamp_us, count,
+           (hdr->flags & STREAM_FLAG_STALE) ? " (stale)" : "",
+           (hdr->flags & STREAM_FLAG_SYNTHETIC) ? " (synthetic)" : "");
+    for (unsigned i = 0; i < count; i++) {
+        scan_record_t rec;
+        size_t n = scan_record_decode(payload + off, len - off, fields, &rec);
+        if (n == 0) {
+            stats->bad_frames++;
+            return;
+        }
+        off += n;
+        stats->records++;
+
+        printf("  %02x:%02x:%02x:%02x:%02x:%02x", rec.bssid[0], rec.bssid[1], rec.bssid[2],
+               rec.bssid[3], rec.bssid[4], rec.bssid[5]);
+        if (fields & SCAN_FIELD_RSSI) {
+            printf(" %4d dBm", rec.rssi);
+        }
+        if (fields & SCAN_FIELD_CHANNEL) {
+            printf(" ch%-2u", rec.channel);
+        }
+        if (fields & SCAN_FIELD_AUTHMODE) {
+            printf(" auth%u", rec.authmode);
+        }
+        if (fields & SCAN_FIELD_DISTANCE) {
+            printf(" ~%lu.%02lu m", (unsigned long)(rec.distance_cm / 100),
+                   (unsigned long)(rec.distance_cm % 100));
+        }
+        if (fields & SCAN_FIELD_VENDOR) {
+            printf(" v%u", rec.vendor_id);
+        }
+        if (fields & SCAN_FIELD_SSID) {
+            printf(" %s", rec.ssid);
+        }
+        printf("\n");
+    }
+}
+
+static void print_channel_hist(const stream_frame_hdr_t *hdr, const uint8_t *payload, size_t len,
+                               reader_stats_t *stats)
+{
+    channel_stat_t ch[CHANNEL_STATS_MAX + 1];
+
+    if (channel_stats_decode(payload, len, ch) == 0) {
+        stats->bad_frames++;
+        return;
+    }
+
+    printf("frame seq=%u t=%" PRIu64 "us channels\n", hdr->seq, hdr->timestamp_us);
+    for (int c = 1; c <= CHANNEL_STATS_MAX; c++) {
+        if (ch[c].ap_count == 0 && ch[c].interference_dbm == CHANNEL_STATS_NONE) {
+            continue;
+        }
+        printf("  ch%-2d aps=%-3u strongest=%4d dBm interference=%4d dBm load=%3u%%\n", c,
+               ch[c].ap_count, ch[c].strongest, ch[c].interference_dbm, ch[c].load);
+    }
+}
+
+static void print_log(const stream_frame_hdr_t *hdr, const uint8_t *payload, size_t len,
+                      reader_stats_t *stats)
+{
+    static const char level_char[] = { 'E', 'W', 'I' };
+    static uint32_t last_dropped;
+    uint32_t dropped;
+    uint8_t n;
+    size_t off = dlog_decode_header(payload, len, &dropped, &n);
+
+    if (off == 0) {
+        stats->bad_frames++;
+        return;
+    }
+    printf("frame seq=%u t=%" PRIu64 "us log, %u entries\n", hdr->seq, hdr->timestamp_us, n);
+    for (uint8_t i = 0; i < n; i++) {
+        dlog_entry_t e;
+        size_t used = dlog_decode_entry(payload + off, len - off, &e);
+        if (used == 0) {
+            stats->bad_frames++;
+            return;
+        }
+        off += used;
+
+        char line[160];
+        dlog_format(&e, line, sizeof(line));
+        printf("  %c (%" PRIu32 ".%06" PRIu32 ") %s\n", level_char[dlog_event_level(e.id)],
+               e.timestamp_us / 1000000, e.timestamp_us % 1000000, line);
+    }
+    if (dropped != last_dropped) {
+        printf("log: %" PRIu32 " entries dropped on the device\n", dropped - last_dropped);
+        last_dropped = dropped;
+    }
+}
+
+static void print_duty(const stream_frame_hdr_t *hdr, const uint8_t *payload, size_t len,
+                       reader_stats_t *stats)
+{
+    stage_duty_summary_t s;
+
+    if (stage_duty_decode(payload, len, &s) == 0) {
+        stats->bad_frames++;
+        return;
+    }
+
+    printf("frame seq=%u t=%" PRIu64 "us duty over %" PRIu32 " ms, %" PRIu32 " reports\n",
+           hdr->seq, hdr->timestamp_us, s.window_ms, s.reports);
+    for (int i = 0; i <= DUTY_STAGE_COUNT; i++) {
+        printf("  %-6s %3u.%u%%  %8.1f ms/report\n", stage_duty_name(i), s.permille[i] / 10,
+               s.permille[i] % 10, s.us_per_report[i] / 1000.0);
+    }
+}
+
+static void print_location(const stream_frame_hdr_t *hdr, const uint8_t *payload, size_t len,
+                           reader_stats_t *stats)
+{
+    fp_result_t r;
+
+    if (fp_result_decode(payload, len, &r) == 0) {
+        stats->bad_frames++;
+        return;
+    }
+
+    printf("frame seq=%u t=%" PRIu64 "us location, survey %08" PRIx32 ", %u APs known, %u not, %u dB steps\n",
+           hdr->seq, hdr->timestamp_us, r.version, r.heard, r.unknown, r.step_db);
+    for (uint8_t i = 0; i < r.k; i++) {
+        printf("  %u. location %-5u dist %" PRIu32 "\n", i + 1, r.match[i].loc, r.match[i].dist);
+    }
+}
+
+static void handle_frame(const uint8_t *wire, size_t len, reader_stats_t *stats)
+{
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    stream_frame_hdr_t hdr;
+    size_t payload_len = 0;
+
+    int ret = stream_frame_decode(wire, len, &hdr, payload, sizeof(payload), &payload_len);
+    if (ret != STREAM_FRAME_OK) {
+        stats->bad_frames++;
+        return;
+    }
+
+    if (stats->have_seq && hdr.seq != (uint16_t)(stats->last_seq + 1)) {
+        stats->seq_gaps += (uint16_t)(hdr.seq - stats->last_seq - 1);
+    }
+    stats->have_seq = 1;
+    stats->last_seq = hdr.seq;
+    stats->frames++;
+
+    switch (hdr.type) {
+    case STREAM_FRAME_AP_BATCH:
+        print_ap_batch(&hdr, payload, payload_len, stats);
+        break;
+    case STREAM_FRAME_CHANNEL_HIST:
+        print_channel_hist(&hdr, payload, payload_len, stats);
+        break;
+    case STREAM_FRAME_DUTY:
+        print_duty(&hdr, payload, payload_len, stats);
+        break;
+    case STREAM_FRAME_LOG:
+        print_log(&hdr, payload, payload_len, stats);
+        break;
+    case STREAM_FRAME_LOCATION:
+        print_location(&hdr, payload, payload_len, stats);
+        break;
+    default:
+        printf("frame seq=%u type=0x%02x len=%zu\n", hdr.seq, hdr.type, payload_len);
+        break;
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <tty|-> [baud]\n", argv[0]);
+        return 2;
+    }
+
+    long baud = argc > 2 ? strtol(argv[2], NULL, 10) : 921600;
+    int fd = open_port(argv[1], baud);
+    if (fd < 0) {
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    static stream_deframer_t deframer;
+    reader_stats_t stats = {0};
+    uint8_t buf[4096];
+
+    while (!stop_requested) {
+        // Poll with a timeout so a signal always gets us to the summary,
+        // even on tty drivers that restart the read
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, 200) <= 0) {
+            continue;
+        }
+
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "read: %s\n", strerror(errno));
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            size_t len = stream_deframer_push(&deframer, buf[i]);
+            if (len > 0) {
+                handle_frame(deframer.buf, len, &stats);
+            }
+        }
+    }
+
+    fprintf(stderr, "frames=%" PRIu64 " records=%" PRIu64 " bad=%" PRIu64 " lost=%" PRIu64
+            " overflows=%u\n", stats.frames, stats.records, stats.bad_frames, stats.seq_gaps,
+            deframer.overflows);
+
+    return 0;
+}
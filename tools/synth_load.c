@@ -0,0 +1,463 @@
+/* ===================== SYNTHETIC LOAD GENERATOR / ANALYZER =====================
+ * Host side of the synthetic-load mode (see synth_load.h). "analyze"
+ * reads what a device in CONFIG_SCANNER_MODE_SYNTHETIC_LOAD sends and
+ * reports record rate, loss and latency percentiles. "gen" produces the
+ * identical stream on the host, so the whole path can be exercised over
+ * a pipe, a pty pair or a loopback TCP socket without hardware.
+ *
+ * Build:
+ *   cc -O2 -Icomponents/scanner/include -o synth_load \
+ *      tools/synth_load.c components/scanner/synth_load.c \
+ *      components/scanner/scan_record.c components/scanner/stream_frame.c \
+ *      components/scanner/cobs.c components/scanner/crc32.c
+ *
+ * Usage:
+ *   synth_load gen [-r rate] [-b batch] [-n count] [-t] <out|-|tcp:port>
+ *   synth_load analyze [-s] [-t] <in|-|tcp:port>
+ *
+ *   -t  text lines as sent over BLE notifications instead of stream frames
+ *   -s  sender shares this host's monotonic clock: report absolute latency.
+ *       Otherwise latency is relative to the fastest frame, which removes
+ *       the unknown device clock offset.
+ *
+ * Loopback examples:
+ *   synth_load gen -r 20000 -n 200000 - | synth_load analyze -s -
+ *   synth_load analyze -s tcp:5555 & synth_load gen -r 20000 tcp:5555
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scan_record.h"
+#include "stream_frame.h"
+#include "synth_load.h"
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop_requested = 1;
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_until_us(int64_t t_us)
+{
+    struct timespec ts = { .tv_sec = t_us / 1000000, .tv_nsec = (t_us % 1000000) * 1000 };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !stop_requested) {
+    }
+}
+
+/* ===================== ENDPOINTS ===================== */
+static int open_endpoint(const char *spec, int for_write)
+{
+    if (strcmp(spec, "-") == 0) {
+        return for_write ? STDOUT_FILENO : STDIN_FILENO;
+    }
+
+    if (strncmp(spec, "tcp:", 4) == 0) {
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons((uint16_t)atoi(spec + 4)),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        };
+        int s = socket(AF_INET, SOCK_STREAM, 0);
+        if (s < 0) {
+            perror("socket");
+            return -1;
+        }
+
+        int one = 1;
+        if (for_write) {
+            if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+                perror("connect");
+                close(s);
+                return -1;
+            }
+            // Frames are small; Nagle would batch them and skew latency
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return s;
+        }
+
+        // The analyzer listens, takes one sender and drops the listener
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(s, 1) != 0) {
+            perror("bind/listen");
+            close(s);
+            return -1;
+        }
+        int c = accept(s, NULL, NULL);
+        close(s);
+        if (c < 0) {
+            perror("accept");
+        }
+        return c;
+    }
+
+    // A tty or fifo already exists; a trace file may not
+    int fd = for_write ? open(spec, O_WRONLY | O_NOCTTY | O_CREAT | O_TRUNC, 0644)
+                       : open(spec, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "open %s: %s\n", spec, strerror(errno));
+    }
+    return fd;
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/* ===================== GENERATOR ===================== */
+static int run_gen(int argc, char **argv)
+{
+    synth_load_config_t cfg = { .rate = 1000, .batch = 10, .count = 0 };
+    int text = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:b:n:t")) != -1) {
+        switch (opt) {
+        case 'r': cfg.rate = (uint32_t)atol(optarg); break;
+        case 'b': cfg.batch = (uint16_t)atoi(optarg); break;
+        case 'n': cfg.count = (uint32_t)atol(optarg); break;
+        case 't': text = 1; break;
+        default: return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        return 2;
+    }
+    if (cfg.batch > 32) {
+        fprintf(stderr, "batch limited to 32 records per frame\n");
+        cfg.batch = 32;
+    }
+
+    int fd = open_endpoint(argv[optind], 1);
+    if (fd < 0) {
+        return 1;
+    }
+
+    synth_load_t gen;
+    scan_record_t recs[32];
+    uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    static uint8_t wire[STREAM_FRAME_MAX_WIRE];
+    stream_frame_hdr_t hdr = { .type = STREAM_FRAME_AP_BATCH, .flags = STREAM_FLAG_SYNTHETIC };
+    uint64_t frames = 0;
+
+    synth_load_init(&gen, &cfg, now_us());
+    while (!stop_requested && !synth_load_done(&gen)) {
+        sleep_until_us(synth_load_due_us(&gen));
+
+        int64_t t = now_us();
+        size_t n = synth_load_next(&gen, recs, t);
+
+        if (text) {
+            char line[100];
+            for (size_t i = 0; i < n; i++) {
+                int len = snprintf(line, sizeof(line), "%s | RSSI: %d\n", recs[i].ssid, recs[i].rssi);
+                if (write_all(fd, line, (size_t)len) != 0) {
+                    stop_requested = 1;
+                }
+            }
+            continue;
+        }
+
+        size_t len = 2;
+        for (size_t i = 0; i < n; i++) {
+            len += scan_record_encode(&recs[i], payload + len, sizeof(payload) - len);
+        }
+        payload[0] = (uint8_t)n;
+        payload[1] = SCAN_RECORD_WIRE_MASK;
+
+        hdr.timestamp_us = (uint64_t)t;
+        size_t wl = stream_frame_encode(&hdr, payload, len, wire, sizeof(wire));
+        hdr.seq++;
+        if (wl == 0 || write_all(fd, wire, wl) != 0) {
+            break;
+        }
+        frames++;
+    }
+
+    if (text) {
+        fprintf(stderr, "sent %" PRIu32 " records as text lines\n", gen.next_seq);
+    } else {
+        fprintf(stderr, "sent %" PRIu32 " records in %" PRIu64 " frames\n", gen.next_seq, frames);
+    }
+    if (fd != STDOUT_FILENO) {
+        close(fd);
+    }
+    return 0;
+}
+
+/* ===================== ANALYZER ===================== */
+typedef struct {
+    int same_clock;
+    uint64_t records;
+    uint64_t duplicates;
+    uint64_t reordered;
+    uint64_t frames;
+    uint64_t bad_frames;
+    uint64_t frame_gaps;
+    int have_seq;
+    uint32_t min_seq;
+    uint32_t max_seq;
+    int have_frame_seq;
+    uint16_t last_frame_seq;
+    int64_t first_rx_us;
+    int64_t last_rx_us;
+    int64_t *lat;               // raw rx - tx per frame (or per line)
+    size_t lat_n;
+    size_t lat_cap;
+    uint8_t *seen;              // one bit per record seq
+    size_t seen_bytes;
+} analyzer_t;
+
+static void note_latency(analyzer_t *a, int64_t lat_us)
+{
+    if (a->lat_n == a->lat_cap) {
+        a->lat_cap = a->lat_cap ? a->lat_cap * 2 : 4096;
+        a->lat = realloc(a->lat, a->lat_cap * sizeof(*a->lat));
+    }
+    a->lat[a->lat_n++] = lat_us;
+}
+
+static void note_record(analyzer_t *a, uint32_t seq)
+{
+    size_t byte = seq / 8;
+    if (byte >= a->seen_bytes) {
+        size_t grow = a->seen_bytes ? a->seen_bytes : 4096;
+        while (byte >= a->seen_bytes + grow) {
+            grow *= 2;
+        }
+        a->seen = realloc(a->seen, a->seen_bytes + grow);
+        memset(a->seen + a->seen_bytes, 0, grow);
+        a->seen_bytes += grow;
+    }
+    if (a->seen[byte] & (1u << (seq % 8))) {
+        a->duplicates++;
+        return;
+    }
+    a->seen[byte] |= 1u << (seq % 8);
+    a->records++;
+
+    if (!a->have_seq) {
+        a->have_seq = 1;
+        a->min_seq = a->max_seq = seq;
+    } else if (seq < a->max_seq) {
+        a->reordered++;
+        if (seq < a->min_seq) {
+            a->min_seq = seq;
+        }
+    } else {
+        a->max_seq = seq;
+    }
+}
+
+static void handle_frame(analyzer_t *a, const uint8_t *wire, size_t len, int64_t rx_us)
+{
+    static uint8_t payload[STREAM_FRAME_MAX_PAYLOAD];
+    stream_frame_hdr_t hdr;
+    size_t plen;
+
+    if (stream_frame_decode(wire, len, &hdr, payload, sizeof(payload), &plen) != STREAM_FRAME_OK ||
+        hdr.type != STREAM_FRAME_AP_BATCH || plen < 2) {
+        a->bad_frames++;
+        return;
+    }
+    if (!(hdr.flags & STREAM_FLAG_SYNTHETIC)) {
+        return;
+    }
+
+    if (a->have_frame_seq && hdr.seq != (uint16_t)(a->last_frame_seq + 1)) {
+        a->frame_gaps += (uint16_t)(hdr.seq - a->last_frame_seq - 1);
+    }
+    a->have_frame_seq = 1;
+    a->last_frame_seq = hdr.seq;
+    a->frames++;
+    note_latency(a, rx_us - (int64_t)hdr.timestamp_us);
+
+    size_t off = 2;
+    for (unsigned i = 0; i < payload[0]; i++) {
+        scan_record_t rec;
+        uint32_t seq;
+        size_t used = scan_record_decode(payload + off, plen - off, payload[1], &rec);
+        if (used == 0) {
+            a->bad_frames++;
+            return;
+        }
+        off += used;
+        if (synth_load_parse(&rec, &seq)) {
+            note_record(a, seq);
+        }
+    }
+}
+
+static void handle_line(analyzer_t *a, const char *line, int64_t rx_us)
+{
+    unsigned long seq;
+    unsigned long t_ms;
+
+    if (sscanf(line, "SYN %lx %lx", &seq, &t_ms) != 2) {
+        return;
+    }
+    note_record(a, (uint32_t)seq);
+
+    // Only ms resolution and 32 bits of it; fine for relative percentiles
+    note_latency(a, rx_us - (int64_t)t_ms * 1000);
+}
+
+static int cmp_i64(const void *x, const void *y)
+{
+    int64_t a = *(const int64_t *)x;
+    int64_t b = *(const int64_t *)y;
+    return (a > b) - (a < b);
+}
+
+static double percentile(const int64_t *sorted, size_t n, double p)
+{
+    size_t idx = (size_t)(p / 100.0 * (n - 1) + 0.5);
+    return (double)sorted[idx];
+}
+
+static void report(analyzer_t *a)
+{
+    double secs = (a->last_rx_us - a->first_rx_us) / 1e6;
+    uint64_t expected = a->have_seq ? (uint64_t)a->max_seq - a->min_seq + 1 : 0;
+    uint64_t lost = expected - a->records;
+
+    printf("records:   %" PRIu64 " received, %" PRIu64 " lost (%.3f%%), %" PRIu64 " dup, %"
+           PRIu64 " reordered\n", a->records, lost, expected ? 100.0 * lost / expected : 0.0,
+           a->duplicates, a->reordered);
+    if (a->frames) {
+        printf("frames:    %" PRIu64 " ok, %" PRIu64 " bad, %" PRIu64 " missing by seq\n",
+               a->frames, a->bad_frames, a->frame_gaps);
+    }
+    printf("rate:      %.0f records/s over %.2f s\n", secs > 0 ? a->records / secs : 0.0, secs);
+
+    if (a->lat_n == 0) {
+        return;
+    }
+    qsort(a->lat, a->lat_n, sizeof(*a->lat), cmp_i64);
+
+    // Without a shared clock only the spread above the fastest sample is meaningful
+    int64_t base = a->same_clock ? 0 : a->lat[0];
+    printf("latency:   %s, us\n", a->same_clock ? "absolute" : "relative to fastest");
+    printf("           p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+           percentile(a->lat, a->lat_n, 50) - base, percentile(a->lat, a->lat_n, 90) - base,
+           percentile(a->lat, a->lat_n, 99) - base, percentile(a->lat, a->lat_n, 99.9) - base,
+           (double)(a->lat[a->lat_n - 1] - base));
+}
+
+static int run_analyze(int argc, char **argv)
+{
+    analyzer_t a = {0};
+    int text = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "st")) != -1) {
+        switch (opt) {
+        case 's': a.same_clock = 1; break;
+        case 't': text = 1; break;
+        default: return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        return 2;
+    }
+
+    int fd = open_endpoint(argv[optind], 0);
+    if (fd < 0) {
+        return 1;
+    }
+
+    static stream_deframer_t deframer;
+    char line[256];
+    size_t line_len = 0;
+    uint8_t buf[8192];
+
+    while (!stop_requested) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+
+        int64_t rx = now_us();
+        if (a.first_rx_us == 0) {
+            a.first_rx_us = rx;
+        }
+        a.last_rx_us = rx;
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (text) {
+                if (buf[i] == '\n') {
+                    line[line_len] = '\0';
+                    handle_line(&a, line, rx);
+                    line_len = 0;
+                } else if (line_len < sizeof(line) - 1) {
+                    line[line_len++] = (char)buf[i];
+                }
+                continue;
+            }
+            size_t wl = stream_deframer_push(&deframer, buf[i]);
+            if (wl > 0) {
+                handle_frame(&a, deframer.buf, wl, rx);
+            }
+        }
+    }
+
+    report(&a);
+    free(a.lat);
+    free(a.seen);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    int rc = 2;
+    if (argc >= 2 && strcmp(argv[1], "gen") == 0) {
+        rc = run_gen(argc - 1, argv + 1);
+    } else if (argc >= 2 && strcmp(argv[1], "analyze") == 0) {
+        rc = run_analyze(argc - 1, argv + 1);
+    }
+
+    if (rc == 2) {
+        fprintf(stderr, "usage: %s gen [-r rate] [-b batch] [-n count] [-t] <out|-|tcp:port>\n"
+                "       %s analyze [-s] [-t] <in|-|tcp:port>\n", argv[0], argv[0]);
+    }
+    return rc;
+}